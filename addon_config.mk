@@ -45,8 +45,12 @@ common:
 linux:
 	ADDON_LDFLAGS = ${OF_ROOT}/addons/ofxLeapMotion/libs/lib/linux/libLeap.so
 	ADDON_LDFLAGS += -Wl,-rpath=${OF_ROOT}/addons/ofxLeapMotion/libs/lib/linux
+	# shm_open for ofxLeapMotionShared
+	ADDON_LDFLAGS += -lrt
 	
 linux64:
 	ADDON_LDFLAGS = ${OF_ROOT}/addons/ofxLeapMotion/libs/lib/linux64/libLeap.so
 	ADDON_LDFLAGS += -Wl,-rpath=${OF_ROOT}/addons/ofxLeapMotion/libs/lib/linux64
+	# shm_open for ofxLeapMotionShared
+	ADDON_LDFLAGS += -lrt
 	
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #pragma once
 #include "ofMesh.h"
+#include "ofVboMesh.h"
 
 class ofxStrip{
 
@@ -25,74 +26,124 @@ class ofxStrip{
 			tex_v = tex_v_scale;
 		}
 		
-		void generate( vector <ofPoint> pts, float fixedWidth, ofPoint upVec){
+		void generate( const vector <ofPoint> & pts, float fixedWidth, ofPoint upVec){
 			vector <float> width;
 			width.push_back(fixedWidth);
 			generate( pts, width, upVec);
 		} 
 		
-		void generate( vector <ofPoint> pts, vector <float> width, ofPoint upVec){
-			bool  bFixedWidth = false; 
-			float curWidth; 
-			float maxWidth = 0; 
-			
+		//width can either be a single value or one value per point
+		//the work is done in separate passes over flat arrays so the compiler can vectorize each loop 
+		void generate( const vector <ofPoint> & pts, const vector <float> & width, ofPoint upVec){
+			mesh.clear();
+			mesh.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
 			
-			if( width.size() == 1 || ( width.size() && width.size() != pts.size() ) ){
-				bFixedWidth = true;
-				curWidth  = width[0];
-				maxWidth  = curWidth; 
+			int numPts = pts.size();
+			if( numPts < 2 || width.empty() ){
+				return;
 			}
 			
-			if( !bFixedWidth ){
-				for(int i = 0; i < width.size(); i++){
-					if( maxWidth > width[i] ){
-						maxWidth = width[i];
-					}
+			bool bFixedWidth = ( width.size() != pts.size() );
+			
+			resizeScratch(numPts);
+			
+			//pass 1: widths and the max width for the tex coords 
+			float maxWidth = 0;
+			for(int i = 0; i < numPts; i++){
+				w[i] = bFixedWidth ? width[0] : width[i];
+				if( w[i] > maxWidth ){
+					maxWidth = w[i];
 				}
 			}
 			
-			mesh.clear();
-			mesh.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
+			//pass 2: segment tangents - the last point reuses the tangent of the last segment
+			for(int i = 0; i < numPts-1; i++){
+				tx[i] = pts[i+1].x - pts[i].x;
+				ty[i] = pts[i+1].y - pts[i].y;
+				tz[i] = pts[i+1].z - pts[i].z;
+			}
+			tx[numPts-1] = tx[numPts-2];
+			ty[numPts-1] = ty[numPts-2];
+			tz[numPts-1] = tz[numPts-2];
 			
-			float numPts = pts.size()-1; 
-			for(int i = 1; i < pts.size(); i++){
+			normalize(tx, ty, tz, numPts);
 			
-				if( !bFixedWidth ){
-					curWidth = width[i];
+			//pass 3: the perpendicular to the left - tangent x up
+			for(int i = 0; i < numPts; i++){
+				lx[i] = ty[i] * upVec.z - tz[i] * upVec.y;
+				ly[i] = tz[i] * upVec.x - tx[i] * upVec.z;
+				lz[i] = tx[i] * upVec.y - ty[i] * upVec.x;
+			}
+			
+			normalize(lx, ly, lz, numPts);
+			
+			//pass 4: the vertices
+			vector <ofVec3f> & verts = mesh.getVertices();
+			verts.resize(numPts * 2);
+			for(int i = 0; i < numPts; i++){
+				ofVec3f & L = verts[i*2];
+				ofVec3f & R = verts[i*2+1];
+				L.x = pts[i].x + lx[i] * w[i];
+				L.y = pts[i].y + ly[i] * w[i];
+				L.z = pts[i].z + lz[i] * w[i];
+				R.x = pts[i].x - lx[i] * w[i];
+				R.y = pts[i].y - ly[i] * w[i];
+				R.z = pts[i].z - lz[i] * w[i];
+			}
+			
+			//pass 5: the normals - tangent x -left
+			if( bNormals ){
+				vector <ofVec3f> & normals = mesh.getNormals();
+				normals.resize(numPts * 2);
+				for(int i = 0; i < numPts; i++){
+					nx[i] = tz[i] * ly[i] - ty[i] * lz[i];
+					ny[i] = tx[i] * lz[i] - tz[i] * lx[i];
+					nz[i] = ty[i] * lx[i] - tx[i] * ly[i];
 				}
 				
-				//find this point and the next point
-				ofVec3f & thisPoint = pts[i-1];
-				ofVec3f & nextPoint = pts[i];
+				normalize(nx, ny, nz, numPts);
 				
-				ofPoint delta		= nextPoint - thisPoint; 
-				ofPoint deltaNorm	= delta.normalized();
-				
-				ofVec3f toTheLeft	= deltaNorm.getPerpendicular(upVec);
-								
-				ofPoint L = thisPoint + toTheLeft * curWidth;
-				ofPoint R = thisPoint - toTheLeft * curWidth;
-								
-				mesh.addVertex(L);
-				mesh.addVertex(R);
-				
-				if( bNormals ){
-					ofPoint normal = deltaNorm.getPerpendicular(-toTheLeft);
-					mesh.addNormal(normal);
-					mesh.addNormal(normal);					
+				for(int i = 0; i < numPts; i++){
+					normals[i*2].set(nx[i], ny[i], nz[i]);
+					normals[i*2+1].set(nx[i], ny[i], nz[i]);
 				}
-				
-				if( bTexCoords ){
-					float texUPct = curWidth / maxWidth; 
-					float texVPct = (float)(i-1) / numPts; 
-					
-					mesh.addTexCoord(ofVec2f((1.0-texUPct) * tex_u, texVPct * tex_v));
-					mesh.addTexCoord(ofVec2f(texUPct * tex_u, texVPct * tex_v));
+			}
+			
+			//pass 6: the tex coords
+			if( bTexCoords ){
+				vector <ofVec2f> & texCoords = mesh.getTexCoords();
+				texCoords.resize(numPts * 2);
+				float invMaxWidth	= maxWidth > 0 ? 1.0 / maxWidth : 0.0;
+				float invNumPts		= 1.0 / (float)(numPts-1); 
+				for(int i = 0; i < numPts; i++){
+					float texUPct = w[i] * invMaxWidth; 
+					float texVPct = (float)i * invNumPts; 
+					texCoords[i*2].set((1.0-texUPct) * tex_u, texVPct * tex_v);
+					texCoords[i*2+1].set(texUPct * tex_u, texVPct * tex_v);
 				}
 			}
-
-			mesh.setupIndicesAuto();
-
+		}
+		
+		//fills widths with a taper driven by the speed of the points
+		//speed is the distance between consecutive points - ie units per sample
+		//points moving at maxSpeed or faster get minWidth - slow points get maxWidth
+		static void getWidthsFromSpeed( const vector <ofPoint> & pts, float minWidth, float maxWidth, float maxSpeed, vector <float> & widths ){
+			int numPts = pts.size();
+			widths.resize(numPts);
+			if( numPts == 0 ){
+				return;
+			}
+			
+			float invMaxSpeed = maxSpeed > 0 ? 1.0 / maxSpeed : 0.0;
+			widths[0] = maxWidth;
+			for(int i = 1; i < numPts; i++){
+				float dx = pts[i].x - pts[i-1].x;
+				float dy = pts[i].y - pts[i-1].y;
+				float dz = pts[i].z - pts[i-1].z;
+				float pct = sqrtf(dx*dx + dy*dy + dz*dz) * invMaxSpeed;
+				pct = pct > 1.0 ? 1.0 : pct; 
+				widths[i] = maxWidth + (minWidth - maxWidth) * pct;
+			}
 		}
 		
 		void enableTexCoords(){
@@ -120,4 +171,115 @@ class ofxStrip{
 		bool bNormals; 
 
 		ofMesh mesh; 
+		
+	protected:
+	
+		void resizeScratch(int numPts){
+			w.resize(numPts);
+			tx.resize(numPts); ty.resize(numPts); tz.resize(numPts);
+			lx.resize(numPts); ly.resize(numPts); lz.resize(numPts);
+			nx.resize(numPts); ny.resize(numPts); nz.resize(numPts);
+		}
+		
+		static void normalize(vector <float> & x, vector <float> & y, vector <float> & z, int num){
+			for(int i = 0; i < num; i++){
+				float len = sqrtf(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]);
+				float inv = len > 0 ? 1.0 / len : 0.0;
+				x[i] *= inv;
+				y[i] *= inv;
+				z[i] *= inv;
+			}
+		}
+		
+		//scratch arrays - kept around between calls so generating doesn't allocate
+		vector <float> w;
+		vector <float> tx, ty, tz;
+		vector <float> lx, ly, lz;
+		vector <float> nx, ny, nz;
+};
+
+//packs many strips into one triangle strip so they can be drawn with a single call
+//strips are joined with degenerate triangles and each strip gets its own vertex color
+//the width is baked into the generated geometry 
+class ofxStripBatch{
+
+	public:
+	
+		ofxStripBatch(){
+			mesh.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
+			mesh.setUsage(GL_STREAM_DRAW);
+		}
+		
+		//call once per frame before adding the strips
+		void begin(){
+			mesh.clear();
+			mesh.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
+		}
+		
+		void add( const vector <ofPoint> & pts, float fixedWidth, ofPoint upVec, const ofFloatColor & color ){
+			vector <float> width;
+			width.push_back(fixedWidth);
+			add( pts, width, upVec, color);
+		}
+		
+		void add( const vector <ofPoint> & pts, const vector <float> & width, ofPoint upVec, const ofFloatColor & color ){
+			strip.generate(pts, width, upVec);
+			
+			vector <ofVec3f> & v	= strip.mesh.getVertices();
+			vector <ofVec3f> & n	= strip.mesh.getNormals();
+			vector <ofVec2f> & t	= strip.mesh.getTexCoords();
+			
+			if( v.empty() ){
+				return;
+			}
+			
+			vector <ofVec3f> & outV			= mesh.getVertices();
+			vector <ofVec3f> & outN			= mesh.getNormals();
+			vector <ofVec2f> & outT			= mesh.getTexCoords();
+			vector <ofFloatColor> & outC	= mesh.getColors();
+			
+			//repeat the last vertex of the previous strip and the first vertex of this one
+			//the two zero area triangles this creates are skipped by the rasterizer
+			//every strip has an even number of vertices so the winding is preserved
+			if( outV.size() ){
+				outV.push_back(outV.back());
+				outV.push_back(v.front());
+				if( strip.bNormals ){
+					outN.push_back(outN.back());
+					outN.push_back(n.front());
+				}
+				if( strip.bTexCoords ){
+					outT.push_back(outT.back());
+					outT.push_back(t.front());
+				}
+				outC.push_back(outC.back());
+				outC.push_back(color);
+			}
+			
+			outV.insert(outV.end(), v.begin(), v.end());
+			if( strip.bNormals ){
+				outN.insert(outN.end(), n.begin(), n.end());
+			}
+			if( strip.bTexCoords ){
+				outT.insert(outT.end(), t.begin(), t.end());
+			}
+			outC.insert(outC.end(), v.size(), color);
+		}
+		
+		void draw(){
+			mesh.draw();
+		}
+		
+		//access to the generator so tex coords / normals can be configured
+		ofxStrip & getStrip(){
+			return strip;
+		}
+		
+		ofVboMesh & getMesh(){
+			return mesh;
+		}
+
+	protected:
+		ofxStrip strip;
+		ofVboMesh mesh;
 };
\ No newline at end of file
@@ -49,6 +49,10 @@ void testApp::update(){
         leap.setMappingX(-230, 230, -ofGetWidth()/2, ofGetWidth()/2);
 		leap.setMappingY(90, 490, -ofGetHeight()/2, ofGetHeight()/2);
         leap.setMappingZ(-150, 150, -200, 200);
+        
+        //or map from the device's interaction box instead of fixed mm ranges:
+        //leap.setMappingNormalized();
+        //leap.setMappingX(0, 1, -ofGetWidth()/2, ofGetWidth()/2); etc
     
         for(int i = 0; i < simpleHands.size(); i++){
         
@@ -76,8 +80,9 @@ void testApp::update(){
 
     // Option 2: Work with the leap data / sdk directly - gives you access to more properties than the simple approach  
     // uncomment code below and comment the code above to use this approach. You can also inhereit ofxLeapMotion and get the data directly via the onFrame callback. 
+    // note: this needs #include "Leap.h" at the top of this file - ofxLeapMotion.h doesn't include the Leap SDK
     
-//	vector <Hand> hands = leap.getLeapHands(); 
+//	vector <Leap::Hand> hands = leap.getLeapHands(); 
 //	if( leap.isFrameNew() && hands.size() ){
 //
 //		//leap returns data in mm - lets set a mapping to our world space. 
@@ -90,7 +95,7 @@ void testApp::update(){
 //            for(int j = 0; j < hands[i].fingers().count(); j++){
 //				ofPoint pt; 
 //			
-//				const Finger & finger = hands[i].fingers()[j];
+//				const Leap::Finger & finger = hands[i].fingers()[j];
 //								
 //				//here we convert the Leap point to an ofPoint - with mapping of coordinates
 //				//if you just want the raw point - use ofxLeapMotion::getofPoint 
@@ -142,17 +147,20 @@ void testApp::draw(){
 	m1.begin(); 
 	m1.setShininess(0.6);
 	
+	//all the trails go into one mesh so they are drawn with a single call
+	trails.begin();
 	for(int i = 0; i < fingersFound.size(); i++){
-		ofxStrip strip;
 		int id = fingersFound[i];
 		
 		ofPolyline & polyline = fingerTrails[id];
-		strip.generate(polyline.getVertices(), 15, ofPoint(0, 0.5, 0.5) );
-		
-		ofSetColor(255 - id * 15, 0, id * 25);
-		strip.getMesh().draw();
+		//fast moving fingers make thinner trails
+		ofxStrip::getWidthsFromSpeed(polyline.getVertices(), 4, 15, 40, trailWidths);
+		trails.add(polyline.getVertices(), trailWidths, ofPoint(0, 0.5, 0.5), ofColor(255 - id * 15, 0, id * 25) );
 	}
 	
+	ofSetColor(255);
+	trails.draw();
+	
     l2.disable();
     
     for(int i = 0; i < simpleHands.size(); i++){
@@ -32,4 +32,6 @@ class testApp : public ofBaseApp{
 	ofMaterial m1;
 	
 	map <int, ofPolyline> fingerTrails;
+	ofxStripBatch trails;
+	vector <float> trailWidths;
 };
@@ -8,6 +8,15 @@
  */
 
 #include "ofxLeapMotion.h"
+#include "ofxLeapMotionRecorder.h"
+
+#include "ofMain.h"
+#include "Leap.h"
+
+#include <condition_variable>
+#include <deque>
+
+using namespace Leap;
 
 // ofxLeapMotionSimpleHand
 //--------------------------------------------------------------
@@ -65,52 +74,612 @@ void ofxLeapMotionSimpleHand::debugDraw(){
 	ofPopStyle();
 }
 
-// ofxLeapMotion
+//-------------------------------------------------------------- 
+void ofxLeapMotionSimpleHand::resetMotion(){
+	translation.set(0, 0, 0);
+	rotation = ofQuaternion(0, 0, 0, 1);
+	scale = 1;
+	translationProbability = 0;
+	rotationProbability = 0;
+	scaleProbability = 0;
+}
+
+//-------------------------------------------------------------- 
+//palm orientation as three orthonormal axes: direction, normal and their cross product
+static bool getPalmBasis(const ofxLeapMotionSimpleHand & hand, ofPoint axes[3]){
+	if( hand.handDirection.lengthSquared() < 0.0001 || hand.handNormal.lengthSquared() < 0.0001 ){
+		return false;
+	}
+	axes[0] = hand.handDirection.getNormalized();
+	axes[1] = hand.handNormal - axes[0] * hand.handNormal.dot(axes[0]);
+	if( axes[1].lengthSquared() < 0.0001 ){
+		return false;
+	}
+	axes[1].normalize();
+	axes[2] = axes[0].getCrossed(axes[1]);
+	return true;
+}
+
+//-------------------------------------------------------------- 
+static float getFingerSpread(const ofxLeapMotionSimpleHand & hand){
+	if( hand.fingers.empty() ){
+		return hand.sphereRadius;
+	}
+	float spread = 0;
+	for(int i = 0; i < hand.fingers.size(); i++){
+		spread += hand.fingers[i].pos.distance(hand.handPos);
+	}
+	return spread / hand.fingers.size();
+}
+
+//-------------------------------------------------------------- 
+void ofxLeapMotionSimpleHand::updateMotion(const ofxLeapMotionSimpleHand & previous){
+	resetMotion();
+	
+	translation = handPos - previous.handPos;
+	
+	//rotation matrix taking the previous palm axes onto the current ones, then as a quaternion
+	float angle = 0;
+	ofPoint cur[3], prev[3];
+	if( getPalmBasis(*this, cur) && getPalmBasis(previous, prev) ){
+		float r[3][3];
+		for(int i = 0; i < 3; i++){
+			for(int j = 0; j < 3; j++){
+				r[i][j] = cur[0][i] * prev[0][j] + cur[1][i] * prev[1][j] + cur[2][i] * prev[2][j];
+			}
+		}
+		
+		float x, y, z, w;
+		float trace = r[0][0] + r[1][1] + r[2][2];
+		if( trace > 0 ){
+			float s = sqrtf(trace + 1.0) * 2;
+			w = 0.25 * s;
+			x = (r[2][1] - r[1][2]) / s;
+			y = (r[0][2] - r[2][0]) / s;
+			z = (r[1][0] - r[0][1]) / s;
+		}else if( r[0][0] > r[1][1] && r[0][0] > r[2][2] ){
+			float s = sqrtf(1.0 + r[0][0] - r[1][1] - r[2][2]) * 2;
+			w = (r[2][1] - r[1][2]) / s;
+			x = 0.25 * s;
+			y = (r[0][1] + r[1][0]) / s;
+			z = (r[0][2] + r[2][0]) / s;
+		}else if( r[1][1] > r[2][2] ){
+			float s = sqrtf(1.0 + r[1][1] - r[0][0] - r[2][2]) * 2;
+			w = (r[0][2] - r[2][0]) / s;
+			x = (r[0][1] + r[1][0]) / s;
+			y = 0.25 * s;
+			z = (r[1][2] + r[2][1]) / s;
+		}else{
+			float s = sqrtf(1.0 + r[2][2] - r[0][0] - r[1][1]) * 2;
+			w = (r[1][0] - r[0][1]) / s;
+			x = (r[0][2] + r[2][0]) / s;
+			y = (r[1][2] + r[2][1]) / s;
+			z = 0.25 * s;
+		}
+		rotation = ofQuaternion(x, y, z, w);
+		angle = 2 * acosf(ofClamp(fabs(w), 0, 1));
+	}
+	
+	float spread = getFingerSpread(*this);
+	float previousSpread = getFingerSpread(previous);
+	if( spread > 0 && previousSpread > 0 ){
+		scale = spread / previousSpread;
+	}
+	
+	//compare the three as distances a fingertip moves - the spread is the lever arm for rotation and scale
+	float lever = spread > 0 ? spread : 50;
+	float t = translation.length();
+	float r = angle * lever;
+	float s = fabs(scale - 1) * lever;
+	float total = t + r + s;
+	if( total > 0.001 ){
+		translationProbability = t / total;
+		rotationProbability = r / total;
+		scaleProbability = s / total;
+	}
+}
+
+// ofxLeapMotionMapping
 //--------------------------------------------------------------
-ofxLeapMotion::ofxLeapMotion()
-		:swipeSpeed(0)
-		,swipeDurationSeconds(0)
-		,swipeDurationMicros(0) {
+ofxLeapMotionMapping::ofxLeapMotionMapping(){
+	resetInteractionBox();
 	reset();
-	resetMapping();
-	ourController = new Leap::Controller(); 
 }
 
 //--------------------------------------------------------------
-ofxLeapMotion::~ofxLeapMotion(){
-	//note we don't delete the controller as it causes a crash / mutex exception. 
-	/// close(); /// JRW - we do not need this...
-				 /// JRW - seems fine in this demo but, when I add
-				 /// JRW - threaded objects the Leap controller crashes on exit.
+void ofxLeapMotionMapping::resetInteractionBox(){
+	//the ranges the example used to map by hand - replaced by the device's box with the first frame
+	boxCenter.set(0, 290, 0);
+	boxSize.set(460, 400, 300);
+}
+
+//-------------------------------------------------------------- 
+void ofxLeapMotionMapping::reset(){
+	xOffsetIn = 0;
+	yOffsetIn = 0;
+	zOffsetIn = 0;
+
+	xOffsetOut = 0;
+	yOffsetOut = 0;
+	zOffsetOut = 0;
+
+	xScale = 1;
+	yScale = 1;
+	zScale = 1;
+	
+	bNormalized = false;
+	bClamp = true;
+}
+
+//-------------------------------------------------------------- 
+void ofxLeapMotionMapping::setX(float minX, float maxX, float outputMinX, float outputMaxX){
+	xOffsetIn = minX;
+	xOffsetOut = outputMinX;
+	xScale = (outputMaxX - outputMinX) / (maxX - minX);
+}
+
+//-------------------------------------------------------------- 
+void ofxLeapMotionMapping::setY(float minY, float maxY, float outputMinY, float outputMaxY){
+	yOffsetIn = minY;
+	yOffsetOut = outputMinY;
+	yScale = (outputMaxY - outputMinY) / (maxY - minY);
+}
+
+//-------------------------------------------------------------- 
+void ofxLeapMotionMapping::setZ(float minZ, float maxZ, float outputMinZ, float outputMaxZ){
+	zOffsetIn = minZ;
+	zOffsetOut = outputMinZ;
+	zScale = (outputMaxZ - outputMinZ) / (maxZ - minZ);
+}
+
+//-------------------------------------------------------------- 
+void ofxLeapMotionMapping::setNormalized(bool bNormalize, bool bClampToBox){
+	bNormalized = bNormalize;
+	bClamp = bClampToBox;
+}
+
+//-------------------------------------------------------------- 
+void ofxLeapMotionMapping::setInteractionBox(const ofPoint & center, const ofPoint & size){
+	if( size.x > 0 && size.y > 0 && size.z > 0 ){
+		boxCenter = center;
+		boxSize = size;
+	}
+}
+
+//-------------------------------------------------------------- 
+ofPoint ofxLeapMotionMapping::map(const ofPoint & raw) const{
+	ofPoint p = raw;
+	
+	//same as Leap::InteractionBox::normalizePoint() - without going through the SDK for every point
+	if( bNormalized ){
+		p.x = (p.x - boxCenter.x) / boxSize.x + 0.5;
+		p.y = (p.y - boxCenter.y) / boxSize.y + 0.5;
+		p.z = (p.z - boxCenter.z) / boxSize.z + 0.5;
+		if( bClamp ){
+			p.x = ofClamp(p.x, 0, 1);
+			p.y = ofClamp(p.y, 0, 1);
+			p.z = ofClamp(p.z, 0, 1);
+		}
+	}
+	
+	p.x = xOffsetOut + (p.x - xOffsetIn) * xScale;
+	p.y = yOffsetOut + (p.y - yOffsetIn) * yScale;
+	p.z = zOffsetOut + (p.z - zOffsetIn) * zScale;
+	return p;
+}
+
+//-------------------------------------------------------------- 
+ofxLeapMotionSimpleHand ofxLeapMotionMapping::map(const ofxLeapMotionSimpleHand & hand) const{
+	ofxLeapMotionSimpleHand mapped = hand;
+	
+	mapped.handPos = map(hand.handPos);
+	mapped.sphereCenter = map(hand.sphereCenter);
+	
+	for(int i = 0; i < mapped.fingers.size(); i++){
+		mapped.fingers[i].pos = map(hand.fingers[i].pos);
+		mapped.fingers[i].vel = map(hand.fingers[i].vel);
+		mapped.fingers[i].base = map(hand.fingers[i].base);
+	}
+	
+	return mapped;
+}
+
+//-------------------------------------------------------------- 
+ofxLeapMotionSimpleTool ofxLeapMotionMapping::map(const ofxLeapMotionSimpleTool & tool) const{
+	ofxLeapMotionSimpleTool mapped = tool;
+	
+	mapped.pos = map(tool.pos);
+	mapped.vel = map(tool.vel);
+	
+	return mapped;
 }
 
+// ofxLeapMotion::Impl
 //--------------------------------------------------------------
-void ofxLeapMotion::open(){
-	reset();
-	ourController->addListener(*this);
+//everything that needs the Leap SDK - kept out of ofxLeapMotion.h so Leap.h is only compiled here
+//Impl is the Leap::Listener and forwards each callback to the ofxLeapMotion virtuals
+class ofxLeapMotion::Impl : public Leap::Listener{
+
+	public:
+	
+		Impl(ofxLeapMotion & owner);
+		
+		~Impl();
+		
+		//every callback is counted while it runs so shutdown can wait for the ones in flight - see drainCallbacks()
+		virtual void onInit(const Controller& controller)		{ if( enterCallback() ){ owner.onInit(controller); leaveCallback(); } }
+		virtual void onConnect(const Controller& contr)			{ if( enterCallback() ){ setConnectionState(OFX_LEAP_CONNECTED); owner.onConnect(contr); leaveCallback(); } }
+		virtual void onDisconnect(const Controller& contr)		{ if( enterCallback() ){ setConnectionState(OFX_LEAP_SERVICE_CONNECTED); owner.onDisconnect(contr); leaveCallback(); } }
+		virtual void onExit(const Controller& contr)			{ if( enterCallback() ){ owner.onExit(contr); leaveCallback(); } }
+		virtual void onFrame(const Controller& contr)			{ if( enterCallback() ){ numLeapFrames++; owner.onFrame(contr); leaveCallback(); } }
+		virtual void onFocusGained(const Controller& contr)		{ if( enterCallback() ){ bFocused = true; owner.onFocusGained(contr); leaveCallback(); } }
+		virtual void onFocusLost(const Controller& contr)		{ if( enterCallback() ){ bFocused = false; owner.onFocusLost(contr); leaveCallback(); } }
+		virtual void onServiceConnect(const Controller& contr)	{ if( enterCallback() ){ setConnectionState(contr.isConnected() ? OFX_LEAP_CONNECTED : OFX_LEAP_SERVICE_CONNECTED); owner.onServiceConnect(contr); leaveCallback(); } }
+		virtual void onServiceDisconnect(const Controller& contr){ if( enterCallback() ){ setConnectionState(OFX_LEAP_CONNECTING); owner.onServiceDisconnect(contr); leaveCallback(); } }
+		virtual void onDeviceChange(const Controller& contr)	{ if( enterCallback() ){ owner.onDeviceChange(contr); leaveCallback(); } }
+		
+		//what travels through the pipeline for each Leap frame
+		struct FrameJob{
+			FrameJob()
+				:arrivalMicros(0)
+				,bReplay(false)
+				,bBoxValid(false){
+			}
+			
+			Leap::Frame leapFrame;
+			uint64_t arrivalMicros;
+			bool bReplay;                           // frame comes from replayFrame() - there is no Leap frame
+			ofxLeapMotionSimpleFrame frame;         // Leap mm
+			ofxLeapMotionSimpleFrame mapped;        // with the setMapping* settings applied
+			ofxLeapMotionMapping mapping;
+			bool bBoxValid;                         // the interaction box of this frame
+			ofPoint boxCenter;
+			ofPoint boxSize;
+		};
+		
+		//the results of updateGestures() - worked out on the pipeline worker
+		struct GestureState{
+			GestureState()
+				:iGestures(0)
+				,swipeSpeed(0)
+				,swipeDurationSeconds(0)
+				,swipeDurationMicros(0)
+				,circleProgress(0)
+				,circleRadius(0){
+			}
+			
+			int iGestures;
+			float swipeSpeed;
+			float swipeDurationSeconds;
+			int64_t swipeDurationMicros;
+			float circleProgress;
+			float circleRadius;
+			ofPoint circleCenter;
+			ofVec3f circleNormal;
+			ofPoint keyTapPosition;  
+			ofPoint screenTapPosition;
+			ofVec3f screenTapDirection;
+		};
+		
+		void onFrameInternal(const Controller& contr);
+		
+		void extractStage(FrameJob & job);
+		void filterStage(FrameJob & job);
+		void addMotion(ofxLeapMotionSimpleFrame & frame);
+		void mapStage(FrameJob & job);
+		void featuresStage(FrameJob & job);
+		void publishStage(FrameJob & job);
+		void classifyGestures(const ofxLeapMotionSimpleFrame & frame, const ofxLeapMotionMapping & frameMapping);
+		
+		ofxLeapMotionSimpleFrame makeSimpleFrame(const Frame & frame);
+		void addGestures(const Frame & leapFrame, ofxLeapMotionSimpleFrame & frame);
+		void addToHistory(const std::shared_ptr <const ofxLeapMotionSimpleFrame> & frame, uint64_t arrivalMicros);
+		
+		void copyImages(const Frame & frame);
+		std::shared_ptr <const ofxLeapMotionDistortion> getDistortion(const Image & image);
+		void setPolicyFlag(Leap::Controller::PolicyFlag flag, bool bEnable);
+		
+		void startController();
+		void reconnectController();
+		void releaseController();
+		void releaseBuffers();
+		void resetReplayState();
+		void supervise();
+		void stopSupervisor();
+		
+		bool enterCallback();
+		void leaveCallback();
+		void drainCallbacks();
+		void enableGestures();
+		void setConnectionState(ofxLeapMotionConnectionState state);
+		ofxLeapMotionMapping getMapping();
+		
+		ofxLeapMotion & owner;
+		
+		//the controller is created and watched over by supervisorThread
+		//controllerMutex guards ourController, policyFlags and bGestures
+		std::thread supervisorThread;
+		std::condition_variable supervisorCondition;
+		std::mutex supervisorMutex;
+		bool bSupervising;
+		
+		//watchdogMutex guards the watchdog and bWatchdog
+		//numLeapFrames counts the onFrame callbacks as they arrive - before any owner.onFrame() override gets them
+		ofxLeapMotionWatchdog watchdog;
+		ofMutex watchdogMutex;
+		bool bWatchdog;
+		std::atomic <int64_t> numLeapFrames;
+		std::atomic <bool> bFocused;
+		
+		ofMutex controllerMutex;
+		bool bGestures;
+		
+		//false once close() starts - callbacks arriving after that return straight away
+		std::atomic <bool> bAccepting;
+		std::atomic <int> numCallbacks;
+		
+		std::atomic <int> connectionState;
+		std::function <void(ofxLeapMotionConnectionState)> connectionCallback;
+		ofMutex callbackMutex;
+		
+		//written by the Leap thread, read from any thread without ourMutex
+		std::atomic <int64_t> currentFrameID;
+		std::atomic <int64_t> currentTimestamp;
+		std::atomic <int64_t> preFrameId;
+		
+		//the latest frame - shared with every subscribe() cursor
+		std::shared_ptr <ofxLeapMotionFrameStream> stream;
+		
+		//the latest frame with the mapping applied - for getSimpleHands()
+		std::shared_ptr <ofxLeapMotionFrameStream> mappedStream;
+		
+		//set from the app, copied by the worker for each frame
+		ofxLeapMotionMapping mapping;
+		ofMutex mappingMutex;
+		std::function <void(ofxLeapMotionSimpleFrame &)> filter;
+		std::function <void(ofxLeapMotionSimpleFrame &)> features;
+		ofMutex stageMutex;
+		
+		//gestureState is only touched by the worker, publishedGestures is guarded by ourMutex
+		GestureState gestureState;
+		GestureState publishedGestures;
+		
+		//the last filtered frame - only touched by the worker, for the per hand motion
+		ofxLeapMotionSimpleFrame motionPrevious;
+		 
+		vector <Hand> hands; 
+		
+		//recent frames oldest first, with the ofGetElapsedTimeMicros() time they arrived
+		std::deque <std::shared_ptr <const ofxLeapMotionSimpleFrame> > history;
+		std::deque <uint64_t> historyArrival;
+		int historySize;
+		Leap::Controller * ourController;
+
+		// TODO: added for Gesture support - JRW
+		//only touched by the worker
+		Leap::Frame lastFrame;
+		
+		ofMutex ourMutex;
+		
+		int policyFlags;
+		
+		//triple buffer per camera: the Leap thread fills back, ready is the latest complete image, the app reads front
+		static const int NUM_CAMERAS = 2;
+		ofxLeapMotionImage imagePool[NUM_CAMERAS][3];
+		int imageBack[NUM_CAMERAS];
+		int imageReady[NUM_CAMERAS];
+		int imageFront[NUM_CAMERAS];
+		bool bImageReady[NUM_CAMERAS];
+		std::shared_ptr <const ofxLeapMotionDistortion> distortions[NUM_CAMERAS];
+		int64_t distortionVersion;
+		std::atomic <bool> bReceiveImages;
+		ofMutex imageMutex;
+		
+		//declared last so the worker is stopped before anything it uses is destroyed
+		ofxLeapMotionPipeline <FrameJob> pipeline;
+};
+
+//--------------------------------------------------------------
+ofxLeapMotion::Impl::Impl(ofxLeapMotion & owner)
+		:owner(owner)
+		,bSupervising(false)
+		,bWatchdog(false)
+		,numLeapFrames(0)
+		,bFocused(true)
+		,bGestures(false)
+		,bAccepting(false)
+		,numCallbacks(0)
+		,connectionState(OFX_LEAP_CLOSED)
+		,historySize(32)
+		,ourController(NULL)
+		,policyFlags(Leap::Controller::POLICY_DEFAULT)
+		,distortionVersion(0)
+		,bReceiveImages(false) {
+	stream = std::make_shared <ofxLeapMotionFrameStream> ();
+	mappedStream = std::make_shared <ofxLeapMotionFrameStream> ();
+	
+	pipeline.setStage(OFX_LEAP_STAGE_EXTRACT, std::bind(&Impl::extractStage, this, std::placeholders::_1));
+	pipeline.setStage(OFX_LEAP_STAGE_FILTER, std::bind(&Impl::filterStage, this, std::placeholders::_1));
+	pipeline.setStage(OFX_LEAP_STAGE_MAP, std::bind(&Impl::mapStage, this, std::placeholders::_1));
+	pipeline.setStage(OFX_LEAP_STAGE_FEATURES, std::bind(&Impl::featuresStage, this, std::placeholders::_1));
+	pipeline.setStage(OFX_LEAP_STAGE_PUBLISH, std::bind(&Impl::publishStage, this, std::placeholders::_1));
+
+	for(int i = 0; i < NUM_CAMERAS; i++){
+		imageBack[i]	= 0;
+		imageReady[i]	= 1;
+		imageFront[i]	= 2;
+		bImageReady[i]	= false;
+	}
 }
 
+//--------------------------------------------------------------
+ofxLeapMotion::Impl::~Impl(){
+	stopSupervisor();
+}
 
+//--------------------------------------------------------------
+bool ofxLeapMotion::Impl::enterCallback(){
+	//count first, then check - so drainCallbacks() either sees this callback or it sees bAccepting is false
+	numCallbacks++;
+	if( !bAccepting ){
+		numCallbacks--;
+		return false;
+	}
+	return true;
+}
 
 //--------------------------------------------------------------
-void ofxLeapMotion::reset(){
-	currentFrameID = 0;
-	preFrameId = -1;
+void ofxLeapMotion::Impl::leaveCallback(){
+	numCallbacks--;
 }
 
 //--------------------------------------------------------------
-void ofxLeapMotion::close(){
-	if(ourController){
-		ourController->removeListener(*this);
+void ofxLeapMotion::Impl::drainCallbacks(){
+	//note: calling close() from inside a Leap callback would wait here forever
+	while( numCallbacks > 0 ){
+		std::this_thread::yield();
 	}
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotion::Impl::startController(){
+	//connecting to the service can take a while - this runs on supervisorThread so open() doesn't wait for it
+	Leap::Controller * controller = new Leap::Controller();
 	
-	/// JRW - let's delete our Leap controller
-	/// call close() on app exit
-	delete ourController;
+	controllerMutex.lock();
+		ourController = controller;
+		ourController->setPolicyFlags((Leap::Controller::PolicyFlag)policyFlags);
+		if( bGestures ){
+			enableGestures();
+		}
+	controllerMutex.unlock();
+	
+	controller->addListener(*this);
+	
+	//the service may have connected before the listener was added
+	if( controller->isConnected() ){
+		setConnectionState(OFX_LEAP_CONNECTED);
+	}else if( controller->isServiceConnected() ){
+		setConnectionState(OFX_LEAP_SERVICE_CONNECTED);
+	}
 }
 
 //--------------------------------------------------------------
-void ofxLeapMotion::setupGestures(){
+void ofxLeapMotion::Impl::reconnectController(){
+	releaseController();
+	setConnectionState(OFX_LEAP_CONNECTING);
+	startController();
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotion::Impl::releaseController(){
+	Leap::Controller * controller;
+	controllerMutex.lock();
+		controller = ourController;
+		ourController = NULL;
+	controllerMutex.unlock();
+	
+	if( !controller ){
+		return;
+	}
+	
+	//no new callbacks once the listener is removed - wait for any still running, only then delete the controller
+	controller->removeListener(*this);
+	drainCallbacks();
+	delete controller;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotion::Impl::releaseBuffers(){
+	//only called once the worker has stopped and the callbacks have drained
+	ourMutex.lock();
+		hands.clear();
+		history.clear();
+		historyArrival.clear();
+	ourMutex.unlock();
+	
+	imageMutex.lock();
+		for(int i = 0; i < NUM_CAMERAS; i++){
+			for(int j = 0; j < 3; j++){
+				imagePool[i][j] = ofxLeapMotionImage();
+			}
+			bImageReady[i] = false;
+			distortions[i].reset();
+		}
+	imageMutex.unlock();
+	
+	lastFrame = Leap::Frame();
+	motionPrevious = ofxLeapMotionSimpleFrame();
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotion::Impl::resetReplayState(){
+	//the worker isn't running - see replay()
+	releaseBuffers();
+	gestureState = GestureState();
+	
+	ourMutex.lock();
+		publishedGestures = GestureState();
+	ourMutex.unlock();
+	
+	//the box of the last live frame would otherwise map the first replayed frames until one sets it
+	mappingMutex.lock();
+		mapping.resetInteractionBox();
+	mappingMutex.unlock();
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotion::Impl::stopSupervisor(){
+	if( supervisorThread.joinable() ){
+		{
+			std::unique_lock <std::mutex> lock(supervisorMutex);
+			bSupervising = false;
+		}
+		supervisorCondition.notify_all();
+		supervisorThread.join();
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotion::Impl::supervise(){
+	startController();
+	
+	std::unique_lock <std::mutex> lock(supervisorMutex);
+	while( bSupervising ){
+		supervisorCondition.wait_for(lock, std::chrono::milliseconds(100));
+		if( !bSupervising ){
+			break;
+		}
+		lock.unlock();
+		
+		//frames are only expected from a connected device while we have focus - unless background frames are on
+		//with no device plugged in there is nothing a new controller would fix
+		controllerMutex.lock();
+			bool bExpectFrames = bFocused || (policyFlags & Leap::Controller::POLICY_BACKGROUND_FRAMES);
+		controllerMutex.unlock();
+		bExpectFrames = bExpectFrames && connectionState == OFX_LEAP_CONNECTED;
+		
+		//the callbacks themselves are counted - an onFrame() override that doesn't call onFrameInternal() still has a healthy connection
+		int64_t numFrames = numLeapFrames.load();
+		
+		bool bReconnect = false;
+		watchdogMutex.lock();
+			if( bWatchdog ){
+				bReconnect = watchdog.update(ofGetElapsedTimeMicros(), numFrames ? numFrames : -1, bExpectFrames);
+			}
+		watchdogMutex.unlock();
+		
+		if( bReconnect ){
+			ofLogWarning("ofxLeapMotion") << "no frames for a while - reconnecting to the Leap service";
+			reconnectController();
+		}
+		
+		lock.lock();
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotion::Impl::enableGestures(){
 	// enables screen tap gesture (forward poke / tap)
 	ourController->enableGesture(Gesture::TYPE_SCREEN_TAP);
 	
@@ -125,112 +694,236 @@ void ofxLeapMotion::setupGestures(){
 }
 
 //--------------------------------------------------------------
-void ofxLeapMotion::updateGestures(){
+void ofxLeapMotion::Impl::setConnectionState(ofxLeapMotionConnectionState state){
+	if( connectionState.exchange(state) == state ){
+		return;
+	}
+	
+	std::function <void(ofxLeapMotionConnectionState)> callback;
+	callbackMutex.lock();
+		callback = connectionCallback;
+	callbackMutex.unlock();
+	
+	if( callback ){
+		callback(state);
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotion::Impl::onFrameInternal(const Controller& contr){
+	const Frame & curFrame	= contr.frame();
+	const HandList & handList	= curFrame.hands();
+	
+	ourMutex.lock();
+
+		hands.clear(); 
+		for(int i = 0; i < handList.count(); i++){
+			hands.push_back( handList[i] ); 
+		}
 	
-	Leap::Frame frame = ourController->frame();
+	ourMutex.unlock();
 	
-	if(lastFrame == frame){
+	//everything else happens on the pipeline worker - see the *Stage functions
+	FrameJob job;
+	job.leapFrame = curFrame;
+	job.arrivalMicros = ofGetElapsedTimeMicros();
+	pipeline.push(job);
+	
+	if( bReceiveImages ){
+		copyImages(curFrame);
+	}
+}
+
+// ofxLeapMotion
+//--------------------------------------------------------------
+ofxLeapMotion::ofxLeapMotion()
+		:iGestures(0)
+		,swipeSpeed(0)
+		,swipeDurationSeconds(0)
+		,swipeDurationMicros(0)
+		,circleProgress(0)
+		,circleRadius(0) {
+	impl.reset(new Impl(*this));
+	reset();
+}
+
+//--------------------------------------------------------------
+ofxLeapMotion::~ofxLeapMotion(){
+	//deleting the controller used to crash on exit when callbacks were still running
+	//close() now removes the listener and waits for them first, so it is safe here
+	//note: if you inherit ofxLeapMotion call close() in your own destructor - your onFrame etc can't be called once it has run
+	close();
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotion::open(){
+	if( impl->supervisorThread.joinable() ){
 		return;
 	}
 	
-	Leap::GestureList gestures = lastFrame.isValid() ? frame.gestures(lastFrame) : frame.gestures();
+	reset();
+	impl->pipeline.start();
+	impl->bAccepting = true;
+	impl->setConnectionState(OFX_LEAP_CONNECTING);
+	
+	impl->watchdogMutex.lock();
+		impl->watchdog.reset();
+		impl->numLeapFrames = 0;
+	impl->watchdogMutex.unlock();
+	
+	impl->bSupervising = true;
+	impl->supervisorThread = std::thread(&Impl::supervise, impl.get());
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotion::reset(){
+	impl->currentFrameID.store(0);
+	impl->currentTimestamp.store(0);
+	impl->preFrameId.store(-1);
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotion::close(){
+	//safe to call more than once - and open() again afterwards
+	
+	//stop accepting callbacks, then stop the supervisor - it may be creating or recreating the controller
+	impl->bAccepting = false;
+	impl->stopSupervisor();
+	
+	/// JRW - let's delete our Leap controller
+	/// call close() on app exit
+	impl->releaseController();
+	
+	//the worker may still be processing the last frame - stop it before releasing what it uses
+	impl->pipeline.stop();
+	impl->releaseBuffers();
+	
+	impl->setConnectionState(OFX_LEAP_CLOSED);
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotion::setupGestures(){
+	//if the controller doesn't exist yet the gestures are enabled when it is created
+	impl->controllerMutex.lock();
+		impl->bGestures = true;
+		if( impl->ourController ){
+			impl->enableGestures();
+		}
+	impl->controllerMutex.unlock();
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotion::updateGestures(){
 	
-	lastFrame = frame;
+	//the gestures are classified on the pipeline worker - this just picks up the latest results
+	Impl::GestureState gestures;
+	impl->ourMutex.lock();
+		gestures = impl->publishedGestures;
+	impl->ourMutex.unlock();
 	
-	size_t numGestures = gestures.count();
+	iGestures				= gestures.iGestures;
+	swipeSpeed				= gestures.swipeSpeed;
+	swipeDurationSeconds	= gestures.swipeDurationSeconds;
+	swipeDurationMicros		= gestures.swipeDurationMicros;
+	circleProgress			= gestures.circleProgress;
+	circleRadius			= gestures.circleRadius;
+	circleCenter			= gestures.circleCenter;
+	circleNormal			= gestures.circleNormal;
+	keyTapPosition			= gestures.keyTapPosition;
+	screenTapPosition		= gestures.screenTapPosition;
+	screenTapDirection		= gestures.screenTapDirection;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotion::Impl::classifyGestures(const ofxLeapMotionSimpleFrame & frame, const ofxLeapMotionMapping & frameMapping){
 	
-	for(size_t i=0; i < numGestures; i++){
+	//works from the simple gestures so recorded frames give the same results as live ones
+	for(size_t i=0; i < frame.gestures.size(); i++){
+		const ofxLeapMotionSimpleGesture & gesture = frame.gestures[i];
 		
 		// screen tap gesture (forward poke / tap)
-		if(gestures[i].type() == Leap::Gesture::TYPE_SCREEN_TAP){
-			Leap::ScreenTapGesture tap = gestures[i];
+		if(gesture.type == OFX_LEAP_GESTURE_SCREEN_TAP){
+			gestureState.screenTapPosition = frameMapping.map(gesture.position);    // screen tap gesture data = tap position
+			gestureState.screenTapDirection = gesture.direction;                    // screen tap gesture data = tap direction
 
-			screenTapPosition = getMappedofPoint(tap.position());   // screen tap gesture data = tap position
-			screenTapDirection = getofPoint(tap.direction());       // screen tap gesture data = tap direction
-
-			iGestures = 1;
+			gestureState.iGestures = 1;
 		}
 		
 		// key tap gesture (down tap)
-		else if(gestures[i].type() == Leap::Gesture::TYPE_KEY_TAP){
-			Leap::KeyTapGesture tap = gestures[i];
-
-			keyTapPosition = getofPoint(tap.position());            // key tap gesture data = tap position
+		else if(gesture.type == OFX_LEAP_GESTURE_KEY_TAP){
+			gestureState.keyTapPosition = gesture.position;                         // key tap gesture data = tap position
 
-			iGestures = 2;
+			gestureState.iGestures = 2;
 		}
 		
 		// swipe gesture
-		else if(gestures[i].type() == Leap::Gesture::TYPE_SWIPE){
-			Leap::SwipeGesture swipe = gestures[i];
-			Leap::Vector diff = 0.04f*(swipe.position() - swipe.startPosition());
+		else if(gesture.type == OFX_LEAP_GESTURE_SWIPE){
+			ofPoint diff = 0.04f*(gesture.position - gesture.startPosition);
 			ofVec3f curSwipe(diff.x, -diff.y, diff.z);
 			
 			// swipe left
 			if(curSwipe.x < -3 && curSwipe.x > -20){
-				iGestures = 4;
+				gestureState.iGestures = 4;
 			}
 			// swipe right
 			else if(curSwipe.x > 3 && curSwipe.x < 20){
-				iGestures = 3;
+				gestureState.iGestures = 3;
 			}
 			// swipe up
 			if(curSwipe.y < -3 && curSwipe.y > -20){
-				iGestures = 6;
+				gestureState.iGestures = 6;
 			}
 			// swipe down
 			else if(curSwipe.y > 3 && curSwipe.y < 20){
-				iGestures = 5;
+				gestureState.iGestures = 5;
 			}
 			
 			// 3D swiping
 			// swipe forward
 			if(curSwipe.z < -5){
-				iGestures = 7;
+				gestureState.iGestures = 7;
 			}
 			// swipe back
 			else if(curSwipe.z > 5){
-				iGestures = 8;
+				gestureState.iGestures = 8;
 			}
 			
 			// more swipe gesture data
-			swipeSpeed = swipe.speed();                             // swipe speed in mm/s
-			swipeDurationSeconds = swipe.durationSeconds();         // swipe duration in seconds
-			swipeDurationMicros = swipe.duration();                 // swipe duration in micros
-			swipe.position();
+			gestureState.swipeSpeed = gesture.speed;                                // swipe speed in mm/s
+			gestureState.swipeDurationSeconds = gesture.durationMicros / 1000000.0; // swipe duration in seconds
+			gestureState.swipeDurationMicros = gesture.durationMicros;              // swipe duration in micros
 		}
 		
 		// circle gesture
-		else if(gestures[i].type() == Leap::Gesture::TYPE_CIRCLE){
-			Leap::CircleGesture circle = gestures[i];
-			circleProgress = circle.progress();                     // circle progress
+		else if(gesture.type == OFX_LEAP_GESTURE_CIRCLE){
+			gestureState.circleProgress = gesture.progress;                         // circle progress
 
-			if(circleProgress >= 1.0f){
+			if(gestureState.circleProgress >= 1.0f){
 				
-				circleCenter = getMappedofPoint(circle.center());                           // changed to global
-				circleNormal.set(circle.normal().x, circle.normal().y, circle.normal().z);  // changed to global
+				gestureState.circleCenter = frameMapping.map(gesture.position);     // changed to global
+				gestureState.circleNormal = gesture.normal;                         // changed to global
 
 				double curAngle = 6.5;
-				if(circleNormal.z < 0){
+				if(gestureState.circleNormal.z < 0){
 					curAngle *= -1;
 				}
 				
 				if(curAngle < 0){
 					// clockwise rotation
-					iGestures = 10;
+					gestureState.iGestures = 10;
 				}
 				else{
 					// counter-clockwise rotation
-					iGestures = 9;
+					gestureState.iGestures = 9;
 				}
 			}
 		}
 		
 		// kill gesture when done
-		// gestures 5 & 6 are always in a STATE_STOP so we exclude
-		if(gestures[i].type() != 5 && gestures[i].type() != 6){
-			if(gestures[i].state() == Leap::Gesture::STATE_STOP){
-				iGestures = 0;
+		// screen and key taps are always in a STATE_STOP so we exclude
+		if(gesture.type != OFX_LEAP_GESTURE_SCREEN_TAP && gesture.type != OFX_LEAP_GESTURE_KEY_TAP){
+			if(gesture.state == OFX_LEAP_GESTURE_STATE_STOP){
+				gestureState.iGestures = 0;
 			}
 		}
 	}
@@ -263,6 +956,11 @@ void ofxLeapMotion::onFrame(const Controller& contr){
 	onFrameInternal(contr); // call this if you want to use getHands() / isFrameNew() etc 
 }
 
+//--------------------------------------------------------------
+void ofxLeapMotion::onFrameInternal(const Controller& contr){
+	impl->onFrameInternal(contr);
+}
+
 //--------------------------------------------------------------
 void ofxLeapMotion::onFocusGained(const Controller& contr){
 	ofLogWarning() << "ofxLeapMotionApp - onFocusGained";
@@ -292,126 +990,776 @@ void ofxLeapMotion::onDeviceChange(const Controller& contr){
 vector <Hand> ofxLeapMotion::getLeapHands(){
 
 	vector <Hand> handsCopy; 
-    if(ourMutex.try_lock()){
-		handsCopy = hands; 
-		ourMutex.unlock();
+    if(impl->ourMutex.try_lock()){
+		handsCopy = impl->hands; 
+		impl->ourMutex.unlock();
 	}
 
 	return handsCopy;
 }
 
 //-------------------------------------------------------------- 
-vector <ofxLeapMotionSimpleHand> ofxLeapMotion::getSimpleHands(){
+ofxLeapMotionSimpleFrame ofxLeapMotion::Impl::makeSimpleFrame(const Frame & leapFrame){
 
-	vector <ofxLeapMotionSimpleHand> simpleHands; 
-	vector <Hand> leapHands = getLeapHands();
+	ofxLeapMotionSimpleFrame frame;
+	frame.id = leapFrame.id();
+	frame.timestamp = leapFrame.timestamp();
 	
-	for(int i = 0; i < leapHands.size(); i++){
+	const HandList & leapHands = leapFrame.hands();
+	for(int i = 0; i < leapHands.count(); i++){
+		const Hand & hand = leapHands[i];
 		ofxLeapMotionSimpleHand curHand;
 	
-		curHand.handPos     = getMappedofPoint(leapHands[i].palmPosition());
-		curHand.handNormal  = getofPoint(leapHands[i].palmNormal());
-		curHand.handVelocity = getofPoint(leapHands[i].palmVelocity());           //  more hand data - hand velocity
-		curHand.sphereRadius = leapHands[i].sphereRadius();                       //  more hand data - hand openness
-		curHand.sphereCenter = getMappedofPoint(leapHands[i].sphereCenter());     //  more hand data - sphere center
-
+		curHand.id          = hand.id();
+		curHand.handPos     = getofPoint(hand.palmPosition());
+		curHand.handNormal  = getofPoint(hand.palmNormal());
+		curHand.handVelocity = getofPoint(hand.palmVelocity());           //  more hand data - hand velocity
+		curHand.sphereRadius = hand.sphereRadius();                       //  more hand data - hand openness
+		curHand.sphereCenter = getofPoint(hand.sphereCenter());           //  more hand data - sphere center
+		curHand.confidence  = hand.confidence();
+		curHand.handDirection = getofPoint(hand.direction());
+		curHand.pinchStrength = hand.pinchStrength();
+		curHand.grabStrength = hand.grabStrength();
+		curHand.palmWidth   = hand.palmWidth();
+		curHand.timeVisible = hand.timeVisible();
+		curHand.bLeft       = hand.isLeft();
 
-		for(int j = 0; j < leapHands[i].fingers().count(); j++){
-			const Finger & finger = hands[i].fingers()[j];
+		const FingerList & fingers = hand.fingers();
+		for(int j = 0; j < fingers.count(); j++){
+			const Finger & finger = fingers[j];
 		
 			Leap::Vector basePosition = -finger.direction() * finger.length();     //  calculate finger base position
 			basePosition += finger.tipPosition();                                  //  calculate finger base position
 
 			ofxLeapMotionSimpleHand::simpleFinger f;
-			f.pos = getMappedofPoint(finger.tipPosition());
-			f.vel = getMappedofPoint(finger.tipVelocity());
-			f.base = getMappedofPoint(basePosition);
+			f.pos = getofPoint(finger.tipPosition());
+			f.vel = getofPoint(finger.tipVelocity());
+			f.base = getofPoint(basePosition);
 			f.id = finger.id();
+			f.touchDistance = finger.touchDistance();
+			f.touchZone = (ofxLeapMotionTouchZone)finger.touchZone();
 			
 			curHand.fingers.push_back(f);
 		}
 		
-		simpleHands.push_back(curHand);
+		frame.hands.push_back(curHand);
+	}
+	
+	const ToolList & leapTools = leapFrame.tools();
+	for(int i = 0; i < leapTools.count(); i++){
+		const Tool & tool = leapTools[i];
+		ofxLeapMotionSimpleTool curTool;
+		
+		curTool.id          = tool.id();
+		curTool.handId      = tool.hand().isValid() ? tool.hand().id() : -1;
+		curTool.pos         = getofPoint(tool.tipPosition());
+		curTool.vel         = getofPoint(tool.tipVelocity());
+		curTool.direction   = getofPoint(tool.direction());
+		curTool.length      = tool.length();
+		curTool.width       = tool.width();
+		curTool.timeVisible = tool.timeVisible();
+		curTool.touchDistance = tool.touchDistance();
+		curTool.touchZone   = (ofxLeapMotionTouchZone)tool.touchZone();
+		
+		frame.tools.push_back(curTool);
+	}
+
+	return frame;
+}
+
+//-------------------------------------------------------------- 
+void ofxLeapMotion::Impl::addGestures(const Frame & leapFrame, ofxLeapMotionSimpleFrame & frame){
+	//the gestures since the last frame we processed - the Leap may have sent more frames in between
+	if( lastFrame == leapFrame ){
+		return;
+	}
+	
+	Leap::GestureList gestures = lastFrame.isValid() ? leapFrame.gestures(lastFrame) : leapFrame.gestures();
+	lastFrame = leapFrame;
+	
+	for(int i = 0; i < gestures.count(); i++){
+		const Gesture & gesture = gestures[i];
+		ofxLeapMotionSimpleGesture curGesture;
+		
+		curGesture.id       = gesture.id();
+		curGesture.type     = (ofxLeapMotionGestureType)gesture.type();
+		curGesture.state    = (ofxLeapMotionGestureState)gesture.state();
+		curGesture.durationMicros = gesture.duration();
+		
+		if( gesture.type() == Gesture::TYPE_SWIPE ){
+			Leap::SwipeGesture swipe = gesture;
+			curGesture.position         = getofPoint(swipe.position());
+			curGesture.startPosition    = getofPoint(swipe.startPosition());
+			curGesture.direction        = getofPoint(swipe.direction());
+			curGesture.speed            = swipe.speed();
+		}else if( gesture.type() == Gesture::TYPE_CIRCLE ){
+			Leap::CircleGesture circle = gesture;
+			curGesture.position         = getofPoint(circle.center());
+			curGesture.normal           = getofPoint(circle.normal());
+			curGesture.progress         = circle.progress();
+			curGesture.radius           = circle.radius();
+		}else if( gesture.type() == Gesture::TYPE_SCREEN_TAP ){
+			Leap::ScreenTapGesture tap = gesture;
+			curGesture.position         = getofPoint(tap.position());
+			curGesture.direction        = getofPoint(tap.direction());
+			curGesture.progress         = tap.progress();
+		}else if( gesture.type() == Gesture::TYPE_KEY_TAP ){
+			Leap::KeyTapGesture tap = gesture;
+			curGesture.position         = getofPoint(tap.position());
+			curGesture.direction        = getofPoint(tap.direction());
+			curGesture.progress         = tap.progress();
+		}
+		
+		frame.gestures.push_back(curGesture);
+	}
+}
+
+//-------------------------------------------------------------- 
+void ofxLeapMotion::Impl::extractStage(FrameJob & job){
+	if( job.bReplay ){
+		return;
 	}
+	
+	job.frame = makeSimpleFrame(job.leapFrame);
+	addGestures(job.leapFrame, job.frame);
+	
+	//the box can change with the device - so it is taken from every frame
+	const InteractionBox & box = job.leapFrame.interactionBox();
+	job.bBoxValid = box.isValid();
+	if( job.bBoxValid ){
+		job.boxCenter = getofPoint(box.center());
+		job.boxSize.set(box.width(), box.height(), box.depth());
+	}
+}
+
+//-------------------------------------------------------------- 
+void ofxLeapMotion::Impl::filterStage(FrameJob & job){
+	std::function <void(ofxLeapMotionSimpleFrame &)> curFilter;
+	stageMutex.lock();
+		curFilter = filter;
+	stageMutex.unlock();
+	
+	if( curFilter ){
+		curFilter(job.frame);
+	}
+	
+	//after the user filter so the motion is of the filtered hands - and before mapping so the mapped hands have it too
+	addMotion(job.frame);
+}
+
+//-------------------------------------------------------------- 
+void ofxLeapMotion::Impl::addMotion(ofxLeapMotionSimpleFrame & frame){
+	for(int i = 0; i < frame.hands.size(); i++){
+		ofxLeapMotionSimpleHand & hand = frame.hands[i];
+		hand.resetMotion();
+		for(int j = 0; j < motionPrevious.hands.size(); j++){
+			if( motionPrevious.hands[j].id == hand.id ){
+				hand.updateMotion(motionPrevious.hands[j]);
+				break;
+			}
+		}
+	}
+	motionPrevious = frame;
+}
+
+//--------------------------------------------------------------
+ofxLeapMotionMapping ofxLeapMotion::Impl::getMapping(){
+	//the worker updates the interaction box for every frame - the app thread maps with a copy
+	std::unique_lock <ofMutex> lock(mappingMutex);
+	return mapping;
+}
+
+//-------------------------------------------------------------- 
+void ofxLeapMotion::Impl::mapStage(FrameJob & job){
+	mappingMutex.lock();
+		if( job.bBoxValid ){
+			mapping.setInteractionBox(job.boxCenter, job.boxSize);
+		}
+		job.mapping = mapping;
+	mappingMutex.unlock();
+	
+	job.mapped.id = job.frame.id;
+	job.mapped.timestamp = job.frame.timestamp;
+	job.mapped.hands.resize(job.frame.hands.size());
+	for(int i = 0; i < job.frame.hands.size(); i++){
+		job.mapped.hands[i] = job.mapping.map(job.frame.hands[i]);
+	}
+	job.mapped.tools.resize(job.frame.tools.size());
+	for(int i = 0; i < job.frame.tools.size(); i++){
+		job.mapped.tools[i] = job.mapping.map(job.frame.tools[i]);
+	}
+}
+
+//-------------------------------------------------------------- 
+void ofxLeapMotion::Impl::featuresStage(FrameJob & job){
+	//from the simple gestures - recorded or live
+	classifyGestures(job.frame, job.mapping);
+	
+	std::function <void(ofxLeapMotionSimpleFrame &)> curFeatures;
+	stageMutex.lock();
+		curFeatures = features;
+	stageMutex.unlock();
+	
+	if( curFeatures ){
+		curFeatures(job.frame);
+	}
+}
+
+//-------------------------------------------------------------- 
+void ofxLeapMotion::Impl::publishStage(FrameJob & job){
+	std::shared_ptr <const ofxLeapMotionSimpleFrame> frame = std::make_shared <ofxLeapMotionSimpleFrame> (job.frame);
+	
+	ourMutex.lock();
+		addToHistory(frame, job.arrivalMicros);
+		publishedGestures = gestureState;
+	ourMutex.unlock();
+	
+	mappedStream->publish(std::make_shared <ofxLeapMotionSimpleFrame> (job.mapped));
+	
+	//publish the snapshot before the id - a thread that sees the new id with an acquire load also sees the snapshot
+	stream->publish(frame);
+	currentTimestamp.store(job.frame.timestamp, std::memory_order_relaxed);
+	currentFrameID.store(job.frame.id, std::memory_order_release);
+}
+
+//-------------------------------------------------------------- 
+void ofxLeapMotion::setFilter(std::function <void(ofxLeapMotionSimpleFrame &)> newFilter){
+	impl->stageMutex.lock();
+		impl->filter = newFilter;
+	impl->stageMutex.unlock();
+}
+
+//-------------------------------------------------------------- 
+void ofxLeapMotion::setFeatures(std::function <void(ofxLeapMotionSimpleFrame &)> newFeatures){
+	impl->stageMutex.lock();
+		impl->features = newFeatures;
+	impl->stageMutex.unlock();
+}
 
+//-------------------------------------------------------------- 
+bool ofxLeapMotion::replayFrame(const ofxLeapMotionSimpleFrame & frame){
+	if( impl->pipeline.isRunning() ){
+		ofLogWarning("ofxLeapMotion") << "replayFrame(): close() the Leap first - live frames would mix with the replayed ones";
+		return false;
+	}
+	
+	//the recorded timestamp is the clock - so history and getLeapTimestamp() don't depend on how fast we replay
+	Impl::FrameJob job;
+	job.bReplay = true;
+	job.frame = frame;
+	job.arrivalMicros = frame.timestamp;
+	impl->pipeline.process(job);
+	return true;
+}
+
+//-------------------------------------------------------------- 
+int ofxLeapMotion::replay(ofxLeapMotionPlayer & player){
+	if( impl->pipeline.isRunning() ){
+		ofLogWarning("ofxLeapMotion") << "replay(): close() the Leap first - live frames would mix with the replayed ones";
+		return 0;
+	}
+	
+	//start from nothing so every replay of the same recording gives the same results
+	impl->resetReplayState();
+	reset();
+	
+	int numReplayed = 0;
+	vector <ofxLeapMotionSimpleFrame> frames;
+	for(int i = 0; i < player.getNumBlocks(); i++){
+		if( !player.readBlock(i, frames) ){
+			ofLogError("ofxLeapMotion") << "replay(): couldn't read block " << i;
+			break;
+		}
+		for(int j = 0; j < frames.size(); j++){
+			replayFrame(frames[j]);
+			numReplayed++;
+		}
+	}
+	return numReplayed;
+}
+
+//-------------------------------------------------------------- 
+ofxLeapMotionPipelineTiming ofxLeapMotion::getStageTiming(ofxLeapMotionPipelineStage stage){
+	return impl->pipeline.getTiming(stage);
+}
+
+//-------------------------------------------------------------- 
+ofxLeapMotionPipelineTiming ofxLeapMotion::getPipelineLatency(){
+	return impl->pipeline.getLatency();
+}
+
+//-------------------------------------------------------------- 
+uint64_t ofxLeapMotion::getNumDroppedFrames(){
+	return impl->pipeline.getNumDropped();
+}
+
+//-------------------------------------------------------------- 
+void ofxLeapMotion::Impl::addToHistory(const std::shared_ptr <const ofxLeapMotionSimpleFrame> & frame, uint64_t arrivalMicros){
+	//called with ourMutex locked
+	history.push_back(frame);
+	historyArrival.push_back(arrivalMicros);
+	
+	while( history.size() > MAX(1, historySize) ){
+		history.pop_front();
+		historyArrival.pop_front();
+	}
+}
+
+//-------------------------------------------------------------- 
+ofxLeapMotionSimpleFrame ofxLeapMotion::getSimpleFrame(){
+	std::shared_ptr <const ofxLeapMotionSimpleFrame> frame = getSimpleFrameSnapshot();
+	if( frame ){
+		return *frame;
+	}
+	return ofxLeapMotionSimpleFrame();
+}
+
+//-------------------------------------------------------------- 
+std::shared_ptr <const ofxLeapMotionSimpleFrame> ofxLeapMotion::getSimpleFrameSnapshot(){
+	return impl->stream->getLatest();
+}
+
+//-------------------------------------------------------------- 
+bool ofxLeapMotion::getSimpleFrame(ofxLeapMotionSimpleFrame & frame){
+	frame = getSimpleFrame();
+	return frame.id >= 0;
+}
+
+//-------------------------------------------------------------- 
+ofxLeapMotionSimpleHand ofxLeapMotion::getMappedSimpleHand(const ofxLeapMotionSimpleHand & hand){
+	return impl->getMapping().map(hand);
+}
+
+//slerp of two unit vectors - a normalized lerp when they're (nearly) parallel or opposite
+//-------------------------------------------------------------- 
+static ofPoint slerpUnit(const ofPoint & a, const ofPoint & b, float t){
+	float angle = acosf(ofClamp(a.dot(b), -1, 1));
+	float sinAngle = sinf(angle);
+	if( sinAngle > 0.0001 ){
+		return a * (sinf((1-t) * angle) / sinAngle) + b * (sinf(t * angle) / sinAngle);
+	}
+	return a.getInterpolated(b, t).getNormalized();
+}
+
+//-------------------------------------------------------------- 
+static ofxLeapMotionSimpleHand interpolateHand(const ofxLeapMotionSimpleHand & a, const ofxLeapMotionSimpleHand & b, float t){
+	ofxLeapMotionSimpleHand hand = a;
+	
+	hand.handPos		= a.handPos.getInterpolated(b.handPos, t);
+	hand.handVelocity	= a.handVelocity.getInterpolated(b.handVelocity, t);
+	hand.sphereCenter	= a.sphereCenter.getInterpolated(b.sphereCenter, t);
+	hand.sphereRadius	= ofLerp(a.sphereRadius, b.sphereRadius, t);
+	hand.confidence		= ofLerp(a.confidence, b.confidence, t);
+	hand.pinchStrength	= ofLerp(a.pinchStrength, b.pinchStrength, t);
+	hand.grabStrength	= ofLerp(a.grabStrength, b.grabStrength, t);
+	hand.palmWidth		= ofLerp(a.palmWidth, b.palmWidth, t);
+	hand.timeVisible	= ofLerp(a.timeVisible, b.timeVisible, t);
+	
+	//the palm turns at a constant rate - both axes are slerped, and the direction is kept at right angles to the
+	//normal like the Leap's are
+	hand.handNormal		= slerpUnit(a.handNormal, b.handNormal, t);
+	hand.handDirection	= slerpUnit(a.handDirection, b.handDirection, t);
+	hand.handDirection	-= hand.handNormal * hand.handDirection.dot(hand.handNormal);
+	hand.handDirection.normalize();
+	
+	//fingers by id - a finger only in one of the frames is left as it is
+	for(int i = 0; i < hand.fingers.size(); i++){
+		for(int j = 0; j < b.fingers.size(); j++){
+			if( b.fingers[j].id == hand.fingers[i].id ){
+				hand.fingers[i].pos		= a.fingers[i].pos.getInterpolated(b.fingers[j].pos, t);
+				hand.fingers[i].vel		= a.fingers[i].vel.getInterpolated(b.fingers[j].vel, t);
+				hand.fingers[i].base	= a.fingers[i].base.getInterpolated(b.fingers[j].base, t);
+				break;
+			}
+		}
+	}
+	
+	return hand;
+}
+
+//-------------------------------------------------------------- 
+static ofxLeapMotionSimpleTool interpolateTool(const ofxLeapMotionSimpleTool & a, const ofxLeapMotionSimpleTool & b, float t){
+	ofxLeapMotionSimpleTool tool = a;
+	
+	tool.pos			= a.pos.getInterpolated(b.pos, t);
+	tool.vel			= a.vel.getInterpolated(b.vel, t);
+	tool.direction		= slerpUnit(a.direction, b.direction, t);
+	tool.timeVisible	= ofLerp(a.timeVisible, b.timeVisible, t);
+	tool.touchDistance	= ofLerp(a.touchDistance, b.touchDistance, t);
+	
+	return tool;
+}
+
+//-------------------------------------------------------------- 
+bool ofxLeapMotion::getSimpleFrameAt(int64_t timestamp, ofxLeapMotionSimpleFrame & frame){
+	std::unique_lock <ofMutex> lock(impl->ourMutex);
+	
+	if( impl->history.empty() ){
+		return false;
+	}
+	
+	//outside the history we don't extrapolate - just use the nearest frame
+	if( timestamp <= impl->history.front()->timestamp ){
+		frame = *impl->history.front();
+		return true;
+	}
+	if( timestamp >= impl->history.back()->timestamp ){
+		frame = *impl->history.back();
+		return true;
+	}
+	
+	//binary search for the first frame after timestamp
+	int lo = 1, hi = impl->history.size() - 1;
+	while( lo < hi ){
+		int mid = (lo + hi) / 2;
+		if( impl->history[mid]->timestamp > timestamp ){
+			hi = mid;
+		}else{
+			lo = mid + 1;
+		}
+	}
+	
+	const ofxLeapMotionSimpleFrame & a = *impl->history[lo-1];
+	const ofxLeapMotionSimpleFrame & b = *impl->history[lo];
+	float t = (float)(timestamp - a.timestamp) / (float)MAX((int64_t)1, b.timestamp - a.timestamp);
+	
+	//the nearer frame decides the id and which hands exist - so a hand appears or disappears halfway between frames
+	const ofxLeapMotionSimpleFrame & nearest = t < 0.5 ? a : b;
+	frame.id = nearest.id;
+	frame.timestamp = timestamp;
+	frame.hands.clear();
+	
+	for(int i = 0; i < nearest.hands.size(); i++){
+		const ofxLeapMotionSimpleHand & hand = nearest.hands[i];
+		const ofxLeapMotionSimpleFrame & other = t < 0.5 ? b : a;
+		
+		const ofxLeapMotionSimpleHand * match = NULL;
+		for(int j = 0; j < other.hands.size(); j++){
+			if( other.hands[j].id == hand.id ){
+				match = &other.hands[j];
+				break;
+			}
+		}
+		
+		if( !match ){
+			frame.hands.push_back(hand);
+		}else if( t < 0.5 ){
+			frame.hands.push_back( interpolateHand(hand, *match, t) );
+		}else{
+			frame.hands.push_back( interpolateHand(*match, hand, t) );
+		}
+	}
+	
+	frame.tools.clear();
+	for(int i = 0; i < nearest.tools.size(); i++){
+		const ofxLeapMotionSimpleTool & tool = nearest.tools[i];
+		const ofxLeapMotionSimpleFrame & other = t < 0.5 ? b : a;
+		
+		const ofxLeapMotionSimpleTool * match = NULL;
+		for(int j = 0; j < other.tools.size(); j++){
+			if( other.tools[j].id == tool.id ){
+				match = &other.tools[j];
+				break;
+			}
+		}
+		
+		if( !match ){
+			frame.tools.push_back(tool);
+		}else if( t < 0.5 ){
+			frame.tools.push_back( interpolateTool(tool, *match, t) );
+		}else{
+			frame.tools.push_back( interpolateTool(*match, tool, t) );
+		}
+	}
+	
+	return true;
+}
+
+//-------------------------------------------------------------- 
+vector <ofxLeapMotionSimpleHand> ofxLeapMotion::getSimpleHandsAt(int64_t timestamp){
+	vector <ofxLeapMotionSimpleHand> simpleHands;
+	
+	ofxLeapMotionSimpleFrame frame;
+	if( getSimpleFrameAt(timestamp, frame) ){
+		ofxLeapMotionMapping mapping = impl->getMapping();
+		for(int i = 0; i < frame.hands.size(); i++){
+			simpleHands.push_back( mapping.map(frame.hands[i]) );
+		}
+	}
+	
 	return simpleHands;
 }
 
+//-------------------------------------------------------------- 
+int64_t ofxLeapMotion::getLeapTimestamp(uint64_t appMicros){
+	std::unique_lock <ofMutex> lock(impl->ourMutex);
+	
+	if( impl->history.empty() ){
+		return 0;
+	}
+	
+	//the frame that arrived with the least delay gives the best estimate of the clock offset
+	int64_t offset = (int64_t)impl->historyArrival[0] - impl->history[0]->timestamp;
+	for(int i = 1; i < impl->history.size(); i++){
+		offset = MIN(offset, (int64_t)impl->historyArrival[i] - impl->history[i]->timestamp);
+	}
+	
+	return (int64_t)appMicros - offset;
+}
+
+//-------------------------------------------------------------- 
+void ofxLeapMotion::setHistorySize(int numFrames){
+	std::unique_lock <ofMutex> lock(impl->ourMutex);
+	impl->historySize = MAX(2, numFrames);
+}
+
+//-------------------------------------------------------------- 
+vector <ofxLeapMotionSimpleHand> ofxLeapMotion::getSimpleHands(){
+
+	//already mapped by the pipeline worker
+	std::shared_ptr <const ofxLeapMotionSimpleFrame> frame = impl->mappedStream->getLatest();
+	if( frame ){
+		return frame->hands;
+	}
+
+	return vector <ofxLeapMotionSimpleHand> ();
+}
+
+//-------------------------------------------------------------- 
+vector <ofxLeapMotionSimpleTool> ofxLeapMotion::getSimpleTools(){
+
+	//mapped with the hands
+	std::shared_ptr <const ofxLeapMotionSimpleFrame> frame = impl->mappedStream->getLatest();
+	if( frame ){
+		return frame->tools;
+	}
+
+	return vector <ofxLeapMotionSimpleTool> ();
+}
+
+//-------------------------------------------------------------- 
+ofxLeapMotionSimpleTool ofxLeapMotion::getMappedSimpleTool(const ofxLeapMotionSimpleTool & tool){
+	return impl->getMapping().map(tool);
+}
+
 //--------------------------------------------------------------
 bool ofxLeapMotion::isConnected(){
-	return (ourController && ourController->isConnected());
+	return getConnectionState() == OFX_LEAP_CONNECTED;
 }
 
 //--------------------------------------------------------------
-void ofxLeapMotion::setReceiveBackgroundFrames(bool bReceiveBg){
+void ofxLeapMotion::setWatchdog(bool bEnabled, float stallTimeoutSeconds, float minBackoffSeconds, float maxBackoffSeconds){
+	impl->watchdogMutex.lock();
+		impl->bWatchdog = bEnabled;
+		impl->watchdog.setup(stallTimeoutSeconds, minBackoffSeconds, maxBackoffSeconds);
+	impl->watchdogMutex.unlock();
+}
+
+//--------------------------------------------------------------
+ofxLeapMotionHealth ofxLeapMotion::getHealth(){
+	std::unique_lock <ofMutex> lock(impl->watchdogMutex);
+	return impl->watchdog.getHealth();
+}
+
+//--------------------------------------------------------------
+ofxLeapMotionConnectionState ofxLeapMotion::getConnectionState(){
+	return (ofxLeapMotionConnectionState)impl->connectionState.load();
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotion::setConnectionCallback(std::function <void(ofxLeapMotionConnectionState)> callback){
+	impl->callbackMutex.lock();
+		impl->connectionCallback = callback;
+	impl->callbackMutex.unlock();
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotion::Impl::setPolicyFlag(Leap::Controller::PolicyFlag flag, bool bEnable){
+	std::unique_lock <ofMutex> lock(controllerMutex);
+	
+	if(bEnable){
+		policyFlags |= flag;
+	}else{
+		policyFlags &= ~flag;
+	}
+	
 	if(ourController){
-		ourController->setPolicyFlags(bReceiveBg? Leap::Controller::POLICY_BACKGROUND_FRAMES : Leap::Controller::POLICY_DEFAULT);
+		ourController->setPolicyFlags((Leap::Controller::PolicyFlag)policyFlags);
 	}
 }
 
+//--------------------------------------------------------------
+void ofxLeapMotion::setReceiveBackgroundFrames(bool bReceiveBg){
+	impl->setPolicyFlag(Leap::Controller::POLICY_BACKGROUND_FRAMES, bReceiveBg);
+}
+
 //--------------------------------------------------------------
 void ofxLeapMotion::setPolicyFlagHMD(){
-	ourController->setPolicyFlags (Leap::Controller::POLICY_OPTIMIZE_HMD);
+	impl->setPolicyFlag(Leap::Controller::POLICY_OPTIMIZE_HMD, true);
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotion::setReceiveImages(bool bReceive){
+	impl->bReceiveImages = bReceive;
+	impl->setPolicyFlag(Leap::Controller::POLICY_IMAGES, bReceive);
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotion::Impl::copyImages(const Frame & frame){
+	const ImageList & images = frame.images();
+	
+	int numCopied = 0;
+	for(int i = 0; i < images.count(); i++){
+		const Image & image = images[i];
+		int camera = image.id();
+		if( camera < 0 || camera >= NUM_CAMERAS ){
+			continue;
+		}
+		
+		//only the Leap thread touches the back buffer so this copy happens without a lock
+		//the pixels are only reallocated if the image size changes
+		ofxLeapMotionImage & dst = imagePool[camera][imageBack[camera]];
+		if( dst.pixels.getWidth() != image.width() || dst.pixels.getHeight() != image.height() ){
+			dst.pixels.allocate(image.width(), image.height(), OF_IMAGE_GRAYSCALE);
+		}
+		memcpy(dst.pixels.getData(), image.data(), image.width() * image.height());
+		dst.frameId = frame.id();
+		dst.cameraId = camera;
+		dst.distortion = getDistortion(image);
+		
+		numCopied++;
+	}
+	
+	if( numCopied == 0 ){
+		return;
+	}
+	
+	imageMutex.lock();
+		for(int i = 0; i < NUM_CAMERAS; i++){
+			if( imagePool[i][imageBack[i]].frameId == frame.id() ){
+				std::swap(imageBack[i], imageReady[i]);
+				bImageReady[i] = true;
+			}
+		}
+	imageMutex.unlock();
+}
+
+//--------------------------------------------------------------
+std::shared_ptr <const ofxLeapMotionDistortion> ofxLeapMotion::Impl::getDistortion(const Image & image){
+	int camera = image.id();
+	int w = image.distortionWidth();
+	int h = image.distortionHeight();
+	const float * src = image.distortion();
+	
+	std::shared_ptr <const ofxLeapMotionDistortion> & cur = distortions[camera];
+	if( !src || w * h <= 0 ){
+		return cur;
+	}
+	
+	//the calibration almost never changes - only make a new copy when it does
+	bool bChanged = !cur || cur->width != w || cur->height != h;
+	if( !bChanged ){
+		bChanged = memcmp(&cur->map[0], src, w * h * sizeof(float)) != 0;
+	}
+	
+	if( bChanged ){
+		std::shared_ptr <ofxLeapMotionDistortion> d(new ofxLeapMotionDistortion());
+		d->width	= w;
+		d->height	= h;
+		d->version	= ++distortionVersion;
+		d->map.assign(src, src + w * h);
+		cur = d;
+	}
+	
+	return cur;
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotion::updateImages(){
+	bool bNew = false;
+	
+	impl->imageMutex.lock();
+		for(int i = 0; i < Impl::NUM_CAMERAS; i++){
+			if( impl->bImageReady[i] ){
+				std::swap(impl->imageFront[i], impl->imageReady[i]);
+				impl->bImageReady[i] = false;
+				bNew = true;
+			}
+		}
+	impl->imageMutex.unlock();
+	
+	return bNew;
+}
+
+//--------------------------------------------------------------
+const ofxLeapMotionImage & ofxLeapMotion::getImage(int camera){
+	camera = ofClamp(camera, 0, Impl::NUM_CAMERAS-1);
+	return impl->imagePool[camera][impl->imageFront[camera]];
 }
 
 //-------------------------------------------------------------- 
 bool ofxLeapMotion::isFrameNew(){
-	return currentFrameID != preFrameId;
+	return impl->currentFrameID.load(std::memory_order_acquire) != impl->preFrameId.load(std::memory_order_relaxed);
 }
 
 //-------------------------------------------------------------- 
 void ofxLeapMotion::markFrameAsOld(){
-	preFrameId = currentFrameID; 
+	impl->preFrameId.store(impl->currentFrameID.load(std::memory_order_acquire), std::memory_order_relaxed); 
+}
+
+//-------------------------------------------------------------- 
+ofxLeapMotionCursor ofxLeapMotion::subscribe(){
+	return ofxLeapMotionCursor(impl->stream);
 }
 
 //-------------------------------------------------------------- 
 int64_t ofxLeapMotion::getCurrentFrameID(){
-	return currentFrameID;
+	return impl->currentFrameID.load(std::memory_order_acquire);
 }
 
 //-------------------------------------------------------------- 
 void ofxLeapMotion::resetMapping(){
-	xOffsetIn = 0;
-	yOffsetIn = 0;
-	zOffsetIn = 0;
-
-	xOffsetOut = 0;
-	yOffsetOut = 0;
-	zOffsetOut = 0;
+	impl->mappingMutex.lock();
+		impl->mapping.reset();
+	impl->mappingMutex.unlock();
+}
 
-	xScale = 1;
-	yScale = 1;
-	zScale = 1;
+//-------------------------------------------------------------- 
+void ofxLeapMotion::setMappingNormalized(bool bNormalize, bool bClamp){
+	impl->mappingMutex.lock();
+		impl->mapping.setNormalized(bNormalize, bClamp);
+	impl->mappingMutex.unlock();
 }
 
 //-------------------------------------------------------------- 
 void ofxLeapMotion::setMappingX(float minX, float maxX, float outputMinX, float outputMaxX){
-	xOffsetIn = minX;
-	xOffsetOut = outputMinX;
-	xScale = (outputMaxX - outputMinX) / (maxX - minX);
+	impl->mappingMutex.lock();
+		impl->mapping.setX(minX, maxX, outputMinX, outputMaxX);
+	impl->mappingMutex.unlock();
 }
 
 //-------------------------------------------------------------- 
 void ofxLeapMotion::setMappingY(float minY, float maxY, float outputMinY, float outputMaxY){
-	yOffsetIn = minY;
-	yOffsetOut = outputMinY;
-	yScale = (outputMaxY - outputMinY) / (maxY - minY);
+	impl->mappingMutex.lock();
+		impl->mapping.setY(minY, maxY, outputMinY, outputMaxY);
+	impl->mappingMutex.unlock();
 }
 
 //-------------------------------------------------------------- 
 void ofxLeapMotion::setMappingZ(float minZ, float maxZ, float outputMinZ, float outputMaxZ){
-	zOffsetIn = minZ;
-	zOffsetOut = outputMinZ;
-	zScale = (outputMaxZ - outputMinZ) / (maxZ - minZ);
+	impl->mappingMutex.lock();
+		impl->mapping.setZ(minZ, maxZ, outputMinZ, outputMaxZ);
+	impl->mappingMutex.unlock();
 }
 
 //-------------------------------------------------------------- 
 ofPoint ofxLeapMotion::getMappedofPoint(Vector v){
-	ofPoint p = getofPoint(v);
-	p.x = xOffsetOut + (p.x - xOffsetIn) * xScale;
-	p.y = yOffsetOut + (p.y - yOffsetIn) * yScale;
-	p.z = zOffsetOut + (p.z - zOffsetIn) * zScale;
-	return p;
+	return impl->getMapping().map(getofPoint(v));
+}
+
+//-------------------------------------------------------------- 
+ofPoint ofxLeapMotion::getMappedofPoint(const ofPoint & p){
+	return impl->getMapping().map(p);
 }
 
 //-------------------------------------------------------------- 
@@ -4,35 +4,23 @@
 
 #pragma once
 
-#include "ofMain.h"
-#include "Leap.h"
+#include "ofxLeapMotionTypes.h"
+#include "ofxLeapMotionPipeline.h"
+#include "ofxLeapMotionWatchdog.h"
 
-using namespace Leap;
+#include <functional>
 
-class ofxLeapMotionSimpleHand{
+class ofxLeapMotionPlayer;
 
-	public:
-    
-		typedef struct{
-			ofPoint pos;
-			ofPoint vel;
-			ofPoint base;                   // finger's base
-			int64_t id;
-		}simpleFinger;
-		
-		vector <simpleFinger>  fingers;
-		
-		ofPoint handPos; 
-		ofPoint handNormal;
-											
-		ofPoint handVelocity;               // palm vel
-		ofPoint sphereCenter;               // palm and fingers sphere position
-		float sphereRadius;                 // and radius for hand openness
-
-		void debugDraw();
-};
+//the Leap SDK is only included by ofxLeapMotion.cpp
+//if you use the Leap types directly (onFrame, getLeapHands etc) include "Leap.h" in your own .cpp
+namespace Leap{
+	class Controller;
+	class Hand;
+	struct Vector;
+}
 
-class ofxLeapMotion : public Listener{
+class ofxLeapMotion : public ofxLeapMotionSource{
 	
 	public:
     
@@ -62,8 +50,12 @@ class ofxLeapMotion : public Listener{
 		ofxLeapMotion();
 		~ofxLeapMotion();
 
+		//note: open() returns straight away - the Leap controller is created and connects on a background thread
+		//everything below can be called before it has connected, settings are applied once it exists
 		void open();
 		void reset();
+
+		//waits for running callbacks to return then deletes the controller - safe to call twice, but not from a callback
 		void close();
 
 		// TODO: adding leap gesture support - JRW
@@ -71,34 +63,112 @@ class ofxLeapMotion : public Listener{
 		void updateGestures();
 		
 		// Leap event callbacks, inherit and override these to handle events
-		virtual void onInit(const Controller& controller);
-		virtual void onConnect(const Controller& contr);
-		virtual void onDisconnect(const Controller& contr);
-		virtual void onExit(const Controller& contr);
+		virtual void onInit(const Leap::Controller& controller);
+		virtual void onConnect(const Leap::Controller& contr);
+		virtual void onDisconnect(const Leap::Controller& contr);
+		virtual void onExit(const Leap::Controller& contr);
 		
 		//if you want to use the Leap Controller directly - inhereit ofxLeapMotion and implement this function
 		//note: this function is called in a seperate thread - so GL commands here will cause the app to crash.
 		//also: call onFrameInternal(contr) here if you want to use getHands() / isFrameNew() etc
-		virtual void onFrame(const Controller& contr);
+		virtual void onFrame(const Leap::Controller& contr);
 		
-		virtual void onFocusGained(const Controller& contr);
-		virtual void onFocusLost(const Controller& contr);
-		virtual void onServiceConnect(const Controller& contr);
-		virtual void onServiceDisconnect(const Controller& contr);
-		virtual void onDeviceChange(const Controller& contr);
+		virtual void onFocusGained(const Leap::Controller& contr);
+		virtual void onFocusLost(const Leap::Controller& contr);
+		virtual void onServiceConnect(const Leap::Controller& contr);
+		virtual void onServiceDisconnect(const Leap::Controller& contr);
+		virtual void onDeviceChange(const Leap::Controller& contr);
 		
 		//Simple access to the hands
-		vector <Hand> getLeapHands();
+		//note: getLeapHands() needs Leap.h - include it in your own .cpp
+		vector <Leap::Hand> getLeapHands();
 		vector <ofxLeapMotionSimpleHand> getSimpleHands();
+		
+		//pens, sticks etc - mapped like the hands, and in getSimpleFrame() / cursors / history with them
+		vector <ofxLeapMotionSimpleTool> getSimpleTools();
+		
+		//the current frame with the hands in Leap millimetres - ie without the setMapping* settings applied
+		//useful for recording or anything that needs the raw positions
+		ofxLeapMotionSimpleFrame getSimpleFrame();
+		bool getSimpleFrame(ofxLeapMotionSimpleFrame & frame);
+		
+		//the same frame without copying - the snapshot is never modified once published so it can be kept
+		//and read from any thread. returns an empty pointer before the first frame
+		std::shared_ptr <const ofxLeapMotionSimpleFrame> getSimpleFrameSnapshot();
+		
+		//applies the setMapping* settings to a hand from getSimpleFrame()
+		ofxLeapMotionSimpleHand getMappedSimpleHand(const ofxLeapMotionSimpleHand & hand);
+		ofxLeapMotionSimpleTool getMappedSimpleTool(const ofxLeapMotionSimpleTool & tool);
+		
+		//hands at any time within the recent history - interpolated between the two Leap frames around it
+		//lets you sample the hands at your own render time rather than whenever the Leap delivered a frame
+		//timestamps are in the Leap clock - use getLeapTimestamp() to convert from ofGetElapsedTimeMicros()
+		vector <ofxLeapMotionSimpleHand> getSimpleHandsAt(int64_t timestamp);
+		bool getSimpleFrameAt(int64_t timestamp, ofxLeapMotionSimpleFrame & frame);
+		
+		//converts ofGetElapsedTimeMicros() time to the Leap clock, based on when the recent frames arrived
+		int64_t getLeapTimestamp(uint64_t appMicros);
+		
+		//number of recent frames kept for getSimpleHandsAt() - the default 32 is about 150ms
+		void setHistorySize(int numFrames);
 
+		//never blocks - true once a device is connected and sending frames
 		bool isConnected();
+		ofxLeapMotionConnectionState getConnectionState();
+		
+		//called whenever the connection state changes
+		//note: called from the Leap or startup thread - so GL commands here will cause the app to crash.
+		void setConnectionCallback(std::function <void(ofxLeapMotionConnectionState)> callback);
+		
+		//the watchdog (off by default) recreates the controller when a connected device sends no frames for the stall timeout
+		//eg: after a USB reset or a service restart. retries back off from the min to the max delay
+		void setWatchdog(bool bEnabled, float stallTimeoutSeconds = 2.0, float minBackoffSeconds = 0.5, float maxBackoffSeconds = 30.0);
+		ofxLeapMotionHealth getHealth();
 
 		void setReceiveBackgroundFrames(bool bReceiveBg);
+		
+		//camera images - note: images also need to be allowed in the Leap Motion control panel
+		void setReceiveImages(bool bReceive);
+		
+		//call from the app thread - makes the most recent images current, returns true if they are new
+		bool updateImages();
+		
+		//the current image for a camera (0 = left, 1 = right), only valid until the next updateImages()
+		const ofxLeapMotionImage & getImage(int camera);
 
+		//each Leap frame is processed on a worker thread (extract -> filter -> map -> features -> publish)
+		//the getters above only ever pick up the finished result
+		
+		//optional extra work for the worker thread - both are called with each frame in Leap mm before it is published
+		//filter is for smoothing / rejecting hands, features for anything you want to derive per frame
+		//note: called on the worker thread - no GL calls in here
+		void setFilter(std::function <void(ofxLeapMotionSimpleFrame &)> filter);
+		void setFeatures(std::function <void(ofxLeapMotionSimpleFrame &)> features);
+		
+		//how long each stage takes and how far behind the Leap thread the published frames are
+		ofxLeapMotionPipelineTiming getStageTiming(ofxLeapMotionPipelineStage stage);
+		ofxLeapMotionPipelineTiming getPipelineLatency();
+		uint64_t getNumDroppedFrames();
+		
+		//deterministic replay - recorded frames go through the filter, motion, map, features and publish stages on the
+		//calling thread, as fast as they can, with nothing dropped. the recorded timestamps are the clock so the results
+		//are the same on every run - eg: for regression tests of your setFilter() / setFeatures() functions.
+		//only while the Leap is closed. recorded gestures are classified again, so updateGestures() gives what it did live
+		//replay() starts from scratch - motion, history, gestures and the interaction box of the last live frame are reset
+		bool replayFrame(const ofxLeapMotionSimpleFrame & frame);
+		int replay(ofxLeapMotionPlayer & player);
+		
+		//note: there is only one isFrameNew / markFrameAsOld state per ofxLeapMotion
+		//if more than one part of your app (or more than one thread) reads frames give each its own subscribe() cursor
 		bool isFrameNew();
 		
 		void markFrameAsOld();
 		
+		//a new read position in the frame stream - eg: auto cursor = leap.subscribe(); if( cursor.poll(frame) ){ ... }
+		//the cursor can be used from any thread and stays valid after the ofxLeapMotion is gone - polling it never waits
+		//for the ofxLeapMotion's mutex or its frame processing, at most for a brief copy of the frame pointer
+		ofxLeapMotionCursor subscribe();
+		
 		int64_t getCurrentFrameID();
 
 		void resetMapping();
@@ -107,47 +177,27 @@ class ofxLeapMotion : public Listener{
 		void setMappingY(float minY, float maxY, float outputMinY, float outputMaxY);
 		void setMappingZ(float minZ, float maxZ, float outputMinZ, float outputMaxZ);
 		
+		//map from the Leap interaction box instead of fixed mm ranges - it follows the device the frames came from
+		//points are normalized to 0 to 1 first (clamped to the box if bClamp) and the ranges above then map from 0 to 1
+		//eg: setMappingNormalized(); setMappingX(0, 1, 0, ofGetWidth()); setMappingY(0, 1, ofGetHeight(), 0);
+		void setMappingNormalized(bool bNormalize = true, bool bClamp = true);
+		
 		//helper function for converting a Leap::Vector to an ofPoint with a mapping
-		ofPoint getMappedofPoint(Vector v);
+		ofPoint getMappedofPoint(Leap::Vector v);
+		ofPoint getMappedofPoint(const ofPoint & p);
 		
 		//helper function for converting a Leap::Vector to an ofPoint
-		ofPoint getofPoint(Vector v);
+		static ofPoint getofPoint(Leap::Vector v);
 	
 		void setPolicyFlagHMD();
 
 	protected:
 		
-		//if you want to use the Leap Controller directly - inhereit ofxLeapMotion and implement this function
+		//if you override onFrame call this from it to keep getSimpleHands() / isFrameNew() etc working
 		//note: this function is called in a seperate thread - so GL commands here will cause the app to crash. 
-		//-------------------------------------------------------------- 
-		virtual void onFrameInternal(const Controller& contr){
-			ourMutex.lock();
-		
-				const Frame & curFrame	= contr.frame();
-				const HandList & handList	= curFrame.hands();
-
-				hands.clear(); 
-				for(int i = 0; i < handList.count(); i++){
-					hands.push_back( handList[i] ); 
-				}
-								
-				currentFrameID = curFrame.id();
-			
-			ourMutex.unlock();
-		}
-		
-		int64_t currentFrameID;
-		int64_t preFrameId;
-		
-		float xOffsetIn, xOffsetOut, xScale;
-		float yOffsetIn, yOffsetOut, yScale;
-		float zOffsetIn, zOffsetOut, zScale;
-		 
-		vector <Hand> hands; 
-		Leap::Controller * ourController;
-
-		// TODO: added for Gesture support - JRW
-		Leap::Frame lastFrame;
+		void onFrameInternal(const Leap::Controller& contr);
 		
-		ofMutex ourMutex;
+		//everything that needs the Leap SDK lives in ofxLeapMotion.cpp
+		class Impl;
+		std::unique_ptr <Impl> impl;
 };
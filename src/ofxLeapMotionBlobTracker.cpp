@@ -0,0 +1,216 @@
+/*
+ *  ofxLeapMotionBlobTracker.cpp
+ *  ofxLeapMotion
+ *
+ */
+
+#include "ofxLeapMotionBlobTracker.h"
+
+//--------------------------------------------------------------
+static int findRoot(vector <int> & parents, int i){
+	while( parents[i] != i ){
+		parents[i] = parents[parents[i]];
+		i = parents[i];
+	}
+	return i;
+}
+
+//--------------------------------------------------------------
+ofxLeapMotionBlobTracker::ofxLeapMotionBlobTracker()
+		:threshold(200)
+		,minArea(4)
+		,maxArea(5000)
+		,baseline(40.0)
+		,matchTolerance(0.05) {
+	bValid[0] = bValid[1] = false;
+	setup();
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionBlobTracker::setup(int width, int height){
+	//the two cameras run side by side so split the cores between them
+	int numThreads = MAX(1, (int)std::thread::hardware_concurrency() / 2);
+	workers.setNumThreads(1);
+	for(int i = 0; i < 2; i++){
+		undistort[i].setup(width, height);
+		undistort[i].setNumThreads(numThreads);
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionBlobTracker::setThreshold(int thresh){
+	threshold = ofClamp(thresh, 0, 255);
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionBlobTracker::setBlobArea(int minA, int maxA){
+	minArea = minA;
+	maxArea = maxA;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionBlobTracker::setBaseline(float mm){
+	baseline = mm;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionBlobTracker::setMatchTolerance(float slopeTolerance){
+	matchTolerance = slopeTolerance;
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionBlobTracker::update(ofxLeapMotion & leap){
+	return update(leap.getImage(0), leap.getImage(1));
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionBlobTracker::update(const ofxLeapMotionImage & left, const ofxLeapMotionImage & right){
+	points.clear();
+	
+	//one camera runs on the worker while the other runs here
+	workers.run(2, [&](int camera){
+		processCamera(camera, camera == 0 ? left : right);
+	});
+	
+	if( !bValid[0] || !bValid[1] ){
+		return false;
+	}
+	
+	triangulate();
+	
+	return points.size() > 0;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionBlobTracker::processCamera(int camera, const ofxLeapMotionImage & image){
+	blobs[camera].clear();
+	bValid[camera] = undistort[camera].undistort(image, undistorted[camera]);
+	if( bValid[camera] ){
+		findBlobs(camera);
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionBlobTracker::findBlobs(int camera){
+	const ofPixels & pix = undistorted[camera];
+	int w = pix.getWidth();
+	int h = pix.getHeight();
+	const unsigned char * p = pix.getData();
+	
+	vector <int> & label = labels[camera];
+	vector <int> & parent = parents[camera];
+	label.assign(w * h, -1);
+	parent.clear();
+	
+	//first pass: threshold and provisional labels with 4 connectivity
+	for(int y = 0; y < h; y++){
+		for(int x = 0; x < w; x++){
+			int i = y * w + x;
+			if( p[i] < threshold ){
+				continue;
+			}
+			
+			int up		= y > 0 ? label[i - w] : -1;
+			int left	= x > 0 ? label[i - 1] : -1;
+			
+			if( up < 0 && left < 0 ){
+				label[i] = parent.size();
+				parent.push_back(label[i]);
+			}else if( up >= 0 && left >= 0 ){
+				int ru = findRoot(parent, up);
+				int rl = findRoot(parent, left);
+				label[i] = MIN(ru, rl);
+				parent[MAX(ru, rl)] = MIN(ru, rl);
+			}else{
+				label[i] = MAX(up, left);
+			}
+		}
+	}
+	
+	//second pass: intensity weighted centroids per root label
+	int numLabels = parent.size();
+	vector <double> sumX(numLabels, 0), sumY(numLabels, 0), sumW(numLabels, 0);
+	vector <int> area(numLabels, 0);
+	
+	for(int i = 0; i < w * h; i++){
+		if( label[i] < 0 ){
+			continue;
+		}
+		int r = findRoot(parent, label[i]);
+		double weight = p[i];
+		sumX[r] += (i % w) * weight;
+		sumY[r] += (i / w) * weight;
+		sumW[r] += weight;
+		area[r]++;
+	}
+	
+	for(int i = 0; i < numLabels; i++){
+		if( area[i] < minArea || area[i] > maxArea || sumW[i] <= 0 ){
+			continue;
+		}
+		ofxLeapMotionBlob blob;
+		blob.centroid.set(sumX[i] / sumW[i], sumY[i] / sumW[i], 0);
+		blob.slope = undistort[camera].getRaySlope(blob.centroid.x, blob.centroid.y);
+		blob.area = area[i];
+		blobs[camera].push_back(blob);
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionBlobTracker::triangulate(){
+	//the cameras sit on the x axis at -baseline/2 (left) and +baseline/2 (right) looking up the y axis 
+	//the x slope gives the disparity - the y slope runs along the z axis and should match between cameras
+	vector <bool> used(blobs[1].size(), false);
+	
+	for(size_t i = 0; i < blobs[0].size(); i++){
+		const ofxLeapMotionBlob & l = blobs[0][i];
+		
+		int best = -1;
+		float bestDiff = matchTolerance;
+		for(size_t j = 0; j < blobs[1].size(); j++){
+			const ofxLeapMotionBlob & r = blobs[1][j];
+			float diff = fabs(l.slope.y - r.slope.y);
+			if( used[j] || l.slope.x - r.slope.x <= 0 || diff > bestDiff ){
+				continue;
+			}
+			best = j;
+			bestDiff = diff;
+		}
+		
+		if( best < 0 ){
+			continue;
+		}
+		used[best] = true;
+		
+		const ofxLeapMotionBlob & r = blobs[1][best];
+		float height	= baseline / (l.slope.x - r.slope.x);
+		float x			= l.slope.x * height - baseline * 0.5;
+		float z			= 0.5 * (l.slope.y + r.slope.y) * height;
+		
+		points.push_back(ofPoint(x, height, z));
+	}
+}
+
+//--------------------------------------------------------------
+const vector <ofPoint> & ofxLeapMotionBlobTracker::getPoints(){
+	return points;
+}
+
+//--------------------------------------------------------------
+vector <ofPoint> ofxLeapMotionBlobTracker::getMappedPoints(ofxLeapMotion & leap){
+	vector <ofPoint> mapped;
+	for(size_t i = 0; i < points.size(); i++){
+		mapped.push_back( leap.getMappedofPoint(points[i]) );
+	}
+	return mapped;
+}
+
+//--------------------------------------------------------------
+const vector <ofxLeapMotionBlob> & ofxLeapMotionBlobTracker::getBlobs(int camera){
+	return blobs[camera == 1 ? 1 : 0];
+}
+
+//--------------------------------------------------------------
+const ofPixels & ofxLeapMotionBlobTracker::getUndistorted(int camera){
+	return undistorted[camera == 1 ? 1 : 0];
+}
@@ -0,0 +1,72 @@
+//ofxLeapMotionBlobTracker - finds bright blobs (reflective props, IR leds) in both Leap cameras 
+//and triangulates them into 3D points in Leap millimetre space
+//stages: undistort -> threshold -> connected components -> stereo match -> triangulate
+//the two cameras are processed in parallel on long lived threads, reading straight from the ofxLeapMotion image buffers
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxLeapMotion.h"
+#include "ofxLeapMotionUndistort.h"
+
+class ofxLeapMotionBlob{
+
+	public:
+	
+		ofPoint centroid;                   // in undistorted image pixels
+		ofVec2f slope;                      // ray slope of the centroid
+		int area;
+};
+
+class ofxLeapMotionBlobTracker{
+
+	public:
+	
+		ofxLeapMotionBlobTracker();
+		
+		//size of the undistorted images the blobs are found in
+		void setup(int width = 400, int height = 400);
+		
+		void setThreshold(int threshold);
+		void setBlobArea(int minArea, int maxArea);
+		
+		//distance between the two cameras in mm
+		void setBaseline(float mm);
+		
+		//max difference in vertical ray slope for a left and right blob to be considered the same
+		void setMatchTolerance(float slopeTolerance);
+		
+		//call from the app thread after ofxLeapMotion::updateImages() - returns true if points were found
+		bool update(const ofxLeapMotionImage & left, const ofxLeapMotionImage & right);
+		bool update(ofxLeapMotion & leap);
+		
+		//3D points in Leap mm
+		const vector <ofPoint> & getPoints();
+		
+		//3D points with the ofxLeapMotion setMapping* settings applied
+		vector <ofPoint> getMappedPoints(ofxLeapMotion & leap);
+		
+		const vector <ofxLeapMotionBlob> & getBlobs(int camera);
+		const ofPixels & getUndistorted(int camera);
+		
+	protected:
+	
+		void processCamera(int camera, const ofxLeapMotionImage & image);
+		void findBlobs(int camera);
+		void triangulate();
+		
+		ofxLeapMotionWorkers workers;
+		ofxLeapMotionUndistort undistort[2];
+		ofPixels undistorted[2];
+		vector <int> labels[2];
+		vector <int> parents[2];
+		vector <ofxLeapMotionBlob> blobs[2];
+		bool bValid[2];
+		
+		vector <ofPoint> points;
+		
+		int threshold;
+		int minArea, maxArea;
+		float baseline;
+		float matchTolerance;
+};
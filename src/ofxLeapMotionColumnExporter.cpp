@@ -0,0 +1,212 @@
+/*
+ *  ofxLeapMotionColumnExporter.cpp
+ *  ofxLeapMotion
+ *
+ */
+
+#include "ofxLeapMotionColumnExporter.h"
+
+#include <fstream>
+#include <limits>
+#include <memory>
+
+static const int numFingerColumns = 5;
+
+//--------------------------------------------------------------
+ofxLeapMotionColumnExporter::ofxLeapMotionColumnExporter()
+		:numThreads(0) {
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionColumnExporter::setNumThreads(int num){
+	numThreads = MAX(0, num);
+}
+
+//--------------------------------------------------------------
+vector <string> ofxLeapMotionColumnExporter::getIntColumnNames(){
+	vector <string> names;
+	names.push_back("frame_id");
+	names.push_back("timestamp");
+	names.push_back("hand_id");
+	return names;
+}
+
+//--------------------------------------------------------------
+vector <string> ofxLeapMotionColumnExporter::getFloatColumnNames(){
+	const char * hand[] = {
+		"palm_x", "palm_y", "palm_z",
+		"normal_x", "normal_y", "normal_z",
+		"velocity_x", "velocity_y", "velocity_z",
+		"sphere_x", "sphere_y", "sphere_z", "sphere_radius",
+		"direction_x", "direction_y", "direction_z",
+		"confidence", "pinch", "grab"
+	};
+	
+	vector <string> names(hand, hand + sizeof(hand) / sizeof(hand[0]));
+	for(int i = 0; i < numFingerColumns; i++){
+		string finger = "finger" + ofToString(i);
+		names.push_back(finger + "_tip_x");
+		names.push_back(finger + "_tip_y");
+		names.push_back(finger + "_tip_z");
+	}
+	return names;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionColumnExporter::convertBlock(const ofxLeapMotionPlayer & player, int block, Chunk & chunk){
+	vector <ofxLeapMotionSimpleFrame> frames;
+	chunk.bOk = player.readBlock(block, frames);
+	
+	chunk.ints.assign(getIntColumnNames().size(), vector <int64_t>());
+	chunk.floats.assign(getFloatColumnNames().size(), vector <float>());
+	if( !chunk.bOk ){
+		return;
+	}
+	
+	const float missing = std::numeric_limits<float>::quiet_NaN();
+	bool bExtras = player.getVersion() >= 2;
+	
+	for(int f = 0; f < frames.size(); f++){
+		const ofxLeapMotionSimpleFrame & frame = frames[f];
+		for(int h = 0; h < frame.hands.size(); h++){
+			const ofxLeapMotionSimpleHand & hand = frame.hands[h];
+			
+			chunk.ints[0].push_back(frame.id);
+			chunk.ints[1].push_back(frame.timestamp);
+			chunk.ints[2].push_back(hand.id);
+			
+			int c = 0;
+			chunk.floats[c++].push_back(hand.handPos.x);
+			chunk.floats[c++].push_back(hand.handPos.y);
+			chunk.floats[c++].push_back(hand.handPos.z);
+			chunk.floats[c++].push_back(hand.handNormal.x);
+			chunk.floats[c++].push_back(hand.handNormal.y);
+			chunk.floats[c++].push_back(hand.handNormal.z);
+			chunk.floats[c++].push_back(hand.handVelocity.x);
+			chunk.floats[c++].push_back(hand.handVelocity.y);
+			chunk.floats[c++].push_back(hand.handVelocity.z);
+			chunk.floats[c++].push_back(hand.sphereCenter.x);
+			chunk.floats[c++].push_back(hand.sphereCenter.y);
+			chunk.floats[c++].push_back(hand.sphereCenter.z);
+			chunk.floats[c++].push_back(hand.sphereRadius);
+			chunk.floats[c++].push_back(bExtras ? hand.handDirection.x : missing);
+			chunk.floats[c++].push_back(bExtras ? hand.handDirection.y : missing);
+			chunk.floats[c++].push_back(bExtras ? hand.handDirection.z : missing);
+			chunk.floats[c++].push_back(bExtras ? hand.confidence : missing);
+			chunk.floats[c++].push_back(bExtras ? hand.pinchStrength : missing);
+			chunk.floats[c++].push_back(bExtras ? hand.grabStrength : missing);
+			
+			for(int i = 0; i < numFingerColumns; i++){
+				bool bHas = i < hand.fingers.size();
+				chunk.floats[c++].push_back(bHas ? hand.fingers[i].pos.x : missing);
+				chunk.floats[c++].push_back(bHas ? hand.fingers[i].pos.y : missing);
+				chunk.floats[c++].push_back(bHas ? hand.fingers[i].pos.z : missing);
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------
+int64_t ofxLeapMotionColumnExporter::convert(string recordingPath, string outputDir){
+	ofxLeapMotionPlayer player;
+	if( !player.load(recordingPath) ){
+		return -1;
+	}
+	
+	outputDir = ofToDataPath(outputDir);
+	ofDirectory::createDirectory(outputDir, false, true);
+	
+	//a columns.txt left from an earlier export would describe files this one may not finish
+	ofFile::removeFile(outputDir + "/columns.txt", false);
+	
+	vector <string> intNames = getIntColumnNames();
+	vector <string> floatNames = getFloatColumnNames();
+	
+	vector <std::unique_ptr <std::ofstream> > intFiles, floatFiles;
+	for(int i = 0; i < intNames.size() + floatNames.size(); i++){
+		bool bInt = i < intNames.size();
+		string path = outputDir + "/" + (bInt ? intNames[i] : floatNames[i - intNames.size()]) + ".bin";
+		std::unique_ptr <std::ofstream> file(new std::ofstream(path.c_str(), std::ios::binary | std::ios::trunc));
+		if( !file->is_open() ){
+			ofLogError("ofxLeapMotionColumnExporter") << "couldn't open " << path;
+			return -1;
+		}
+		(bInt ? intFiles : floatFiles).push_back(std::move(file));
+	}
+	
+	int num = numThreads > 0 ? numThreads : MAX(1, (int)std::thread::hardware_concurrency());
+	
+	//a few blocks per thread at a time keeps memory bounded
+	int batchSize = num * 4;
+	vector <Chunk> chunks(batchSize);
+	int64_t numRows = 0;
+	bool bOk = true;
+	
+	for(int start = 0; start < player.getNumBlocks() && bOk; start += batchSize){
+		int end = MIN(player.getNumBlocks(), start + batchSize);
+		
+		//each thread takes every num'th block of the batch
+		vector <std::thread> workers;
+		for(int t = 0; t < num; t++){
+			workers.push_back( std::thread([&, t](){
+				for(int b = start + t; b < end; b += num){
+					convertBlock(player, b, chunks[b - start]);
+				}
+			}) );
+		}
+		for(int t = 0; t < workers.size(); t++){
+			workers[t].join();
+		}
+		
+		//written in block order
+		for(int b = start; b < end; b++){
+			Chunk & chunk = chunks[b - start];
+			if( !chunk.bOk ){
+				ofLogError("ofxLeapMotionColumnExporter") << "couldn't decode block " << b << " of " << recordingPath;
+				bOk = false;
+				break;
+			}
+			
+			for(int i = 0; i < intFiles.size(); i++){
+				if( chunk.ints[i].size() ){
+					intFiles[i]->write((const char *)&chunk.ints[i][0], chunk.ints[i].size() * sizeof(int64_t));
+				}
+			}
+			for(int i = 0; i < floatFiles.size(); i++){
+				if( chunk.floats[i].size() ){
+					floatFiles[i]->write((const char *)&chunk.floats[i][0], chunk.floats[i].size() * sizeof(float));
+				}
+			}
+			numRows += chunk.ints[0].size();
+		}
+	}
+	
+	//a full disk shows up as a failed stream - columns.txt is only written when every column is complete
+	for(int i = 0; i < intFiles.size() + floatFiles.size(); i++){
+		std::ofstream & file = i < intFiles.size() ? *intFiles[i] : *floatFiles[i - intFiles.size()];
+		file.close();
+		if( file.fail() && bOk ){
+			ofLogError("ofxLeapMotionColumnExporter") << "couldn't write the columns to " << outputDir;
+			bOk = false;
+		}
+	}
+	if( !bOk ){
+		return -1;
+	}
+	
+	std::ofstream schema((outputDir + "/columns.txt").c_str());
+	schema << "rows " << numRows << "\n";
+	for(int i = 0; i < intNames.size(); i++){
+		schema << intNames[i] << " int64\n";
+	}
+	for(int i = 0; i < floatNames.size(); i++){
+		schema << floatNames[i] << " float32\n";
+	}
+	schema.close();
+	if( schema.fail() ){
+		ofLogError("ofxLeapMotionColumnExporter") << "couldn't write " << outputDir << "/columns.txt";
+		return -1;
+	}
+	
+	return numRows;
+}
@@ -0,0 +1,42 @@
+//ofxLeapMotionColumnExporter - converts a recording from ofxLeapMotionRecorder into columns for offline analysis
+//there is one row per hand per frame and each column is written to its own raw little endian file 
+//(int64 for the ids and timestamp, float32 for everything else) along with a columns.txt describing them.
+//missing fingers are written as NaN, as are the direction, confidence, pinch and grab of version 1 recordings
+//which don't have them.
+//the recording is decoded a batch of blocks at a time, spread over all the cores, so memory use stays 
+//bounded no matter how long the session is.
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxLeapMotionRecorder.h"
+
+class ofxLeapMotionColumnExporter{
+
+	public:
+	
+		ofxLeapMotionColumnExporter();
+		
+		//0 uses all the cores
+		void setNumThreads(int numThreads);
+		
+		//outputDir is created if needed, returns the number of rows written or -1 on error
+		//columns.txt is written last and only if every column was written completely
+		int64_t convert(string recordingPath, string outputDir);
+		
+		static vector <string> getIntColumnNames();
+		static vector <string> getFloatColumnNames();
+		
+	protected:
+	
+		class Chunk{
+			public:
+				vector < vector <int64_t> > ints;
+				vector < vector <float> > floats;
+				bool bOk;
+		};
+		
+		static void convertBlock(const ofxLeapMotionPlayer & player, int block, Chunk & chunk);
+		
+		int numThreads;
+};
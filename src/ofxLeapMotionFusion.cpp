@@ -0,0 +1,310 @@
+/*
+ *  ofxLeapMotionFusion.cpp
+ *  ofxLeapMotion
+ *
+ */
+
+#include "ofxLeapMotionFusion.h"
+
+//--------------------------------------------------------------
+ofxLeapMotionFusion::ofxLeapMotionFusion()
+		:associationDistance(80)
+		,sourceTimeoutMicros(100000)
+		,nextHandId(1)
+		,frameCount(0) {
+}
+
+//--------------------------------------------------------------
+int ofxLeapMotionFusion::addSource(ofxLeapMotionSource * source, ofMatrix4x4 transform){
+	Source s;
+	s.source = source;
+	s.transform = transform;
+	s.lastFrameId = -1;
+	s.bHasFrame = false;
+	sources.push_back(s);
+	return sources.size() - 1;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionFusion::setTransform(int source, ofMatrix4x4 transform){
+	if( source >= 0 && source < sources.size() ){
+		sources[source].transform = transform;
+	}
+}
+
+//--------------------------------------------------------------
+int ofxLeapMotionFusion::getNumSources(){
+	return sources.size();
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionFusion::setAssociationDistance(float mm){
+	associationDistance = mm;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionFusion::setSourceTimeout(float seconds){
+	sourceTimeoutMicros = MAX(0, seconds) * 1000000.0;
+}
+
+//--------------------------------------------------------------
+ofxLeapMotionSimpleHand ofxLeapMotionFusion::transformHand(const ofxLeapMotionSimpleHand & hand, const ofMatrix4x4 & transform){
+	//positions get the full transform - directions and velocities only the rotation
+	ofQuaternion rotation = transform.getRotate();
+	ofxLeapMotionSimpleHand out = hand;
+	
+	out.handPos			= hand.handPos * transform;
+	out.sphereCenter	= hand.sphereCenter * transform;
+	out.handNormal		= rotation * hand.handNormal;
+	out.handDirection	= rotation * hand.handDirection;
+	out.handVelocity	= rotation * hand.handVelocity;
+	out.translation		= rotation * hand.translation;
+	
+	//the hand's own rotation is a turn about device axes - seen from the shared space it's the same turn conjugated
+	//by the transform. ofQuaternion multiplies in the row vector order: a * b turns by a, then by b
+	out.rotation		= rotation.inverse() * hand.rotation * rotation;
+	
+	for(int i = 0; i < out.fingers.size(); i++){
+		out.fingers[i].pos	= hand.fingers[i].pos * transform;
+		out.fingers[i].base	= hand.fingers[i].base * transform;
+		out.fingers[i].vel	= rotation * hand.fingers[i].vel;
+	}
+	
+	return out;
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionFusion::update(){
+	bool bNew = false;
+	ofxLeapMotionSimpleFrame frame;
+	
+	for(int i = 0; i < sources.size(); i++){
+		Source & s = sources[i];
+		
+		//a source without a frame, eg: a subscriber whose publisher went away, drops out of the merge
+		if( !s.source || !s.source->getSimpleFrame(frame) ){
+			bNew |= s.bHasFrame && s.frame.hands.size();
+			s.bHasFrame = false;
+			s.lastFrameId = -1;
+			continue;
+		}
+		if( frame.id == s.lastFrameId ){
+			continue;
+		}
+		
+		s.lastFrameId = frame.id;
+		s.bHasFrame = true;
+		s.frame.id = frame.id;
+		s.frame.timestamp = frame.timestamp;
+		s.frame.hands.resize(frame.hands.size());
+		for(int j = 0; j < frame.hands.size(); j++){
+			s.frame.hands[j] = transformHand(frame.hands[j], s.transform);
+		}
+		bNew = true;
+	}
+	
+	//sources that have fallen behind the newest frame stopped sending - their last hands are gone
+	int64_t newest = 0;
+	for(int i = 0; i < sources.size(); i++){
+		if( sources[i].bHasFrame ){
+			newest = MAX(newest, sources[i].frame.timestamp);
+		}
+	}
+	for(int i = 0; i < sources.size(); i++){
+		Source & s = sources[i];
+		if( s.bHasFrame && newest - s.frame.timestamp > sourceTimeoutMicros ){
+			bNew |= s.frame.hands.size() > 0;
+			s.bHasFrame = false;
+		}
+	}
+	
+	if( bNew ){
+		vector <ofxLeapMotionSimpleFrame> frames;
+		for(int i = 0; i < sources.size(); i++){
+			if( sources[i].bHasFrame ){
+				frames.push_back(sources[i].frame);
+			}
+		}
+		merge(frames);
+	}
+	
+	return bNew;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionFusion::merge(const vector <ofxLeapMotionSimpleFrame> & frames){
+	//all the hands with where they came from - most confident first so they seed the clusters
+	vector < std::pair <const ofxLeapMotionSimpleHand *, int> > candidates;
+	int64_t timestamp = 0;
+	for(int i = 0; i < frames.size(); i++){
+		for(int j = 0; j < frames[i].hands.size(); j++){
+			candidates.push_back( std::make_pair(&frames[i].hands[j], i) );
+		}
+		timestamp = MAX(timestamp, frames[i].timestamp);
+	}
+	
+	std::stable_sort(candidates.begin(), candidates.end(), [](const std::pair <const ofxLeapMotionSimpleHand *, int> & a, const std::pair <const ofxLeapMotionSimpleHand *, int> & b){
+		return a.first->confidence > b.first->confidence;
+	});
+	
+	//greedy clustering by palm distance - a cluster takes at most one hand per source
+	vector < vector < std::pair <const ofxLeapMotionSimpleHand *, int> > > clusters;
+	float maxDistSq = associationDistance * associationDistance;
+	
+	for(int i = 0; i < candidates.size(); i++){
+		const ofxLeapMotionSimpleHand & hand = *candidates[i].first;
+		int best = -1;
+		float bestDistSq = maxDistSq;
+		
+		for(int c = 0; c < clusters.size(); c++){
+			bool bSameSource = false;
+			for(int k = 0; k < clusters[c].size(); k++){
+				bSameSource |= clusters[c][k].second == candidates[i].second;
+			}
+			float distSq = clusters[c][0].first->handPos.squareDistance(hand.handPos);
+			if( !bSameSource && distSq < bestDistSq ){
+				best = c;
+				bestDistSq = distSq;
+			}
+		}
+		
+		if( best >= 0 ){
+			clusters[best].push_back(candidates[i]);
+		}else{
+			clusters.push_back( vector < std::pair <const ofxLeapMotionSimpleHand *, int> >(1, candidates[i]) );
+		}
+	}
+	
+	//confidence weighted average of each cluster
+	vector <ofxLeapMotionSimpleHand> merged;
+	for(int c = 0; c < clusters.size(); c++){
+		const ofxLeapMotionSimpleHand & seed = *clusters[c][0].first;
+		ofxLeapMotionSimpleHand hand = seed;
+		
+		float totalWeight = 0;
+		hand.handPos.set(0, 0, 0);
+		hand.handNormal.set(0, 0, 0);
+		hand.handVelocity.set(0, 0, 0);
+		hand.sphereCenter.set(0, 0, 0);
+		hand.sphereRadius = 0;
+		hand.confidence = 0;
+		hand.handDirection.set(0, 0, 0);
+		hand.pinchStrength = 0;
+		hand.grabStrength = 0;
+		hand.palmWidth = 0;
+		for(int f = 0; f < hand.fingers.size(); f++){
+			hand.fingers[f].pos.set(0, 0, 0);
+			hand.fingers[f].vel.set(0, 0, 0);
+			hand.fingers[f].base.set(0, 0, 0);
+		}
+		
+		for(int k = 0; k < clusters[c].size(); k++){
+			const ofxLeapMotionSimpleHand & h = *clusters[c][k].first;
+			float w = MAX(h.confidence, 0.001);
+			
+			hand.handPos		+= h.handPos * w;
+			hand.handNormal		+= h.handNormal * w;
+			hand.handVelocity	+= h.handVelocity * w;
+			hand.sphereCenter	+= h.sphereCenter * w;
+			hand.sphereRadius	+= h.sphereRadius * w;
+			hand.confidence		= MAX(hand.confidence, h.confidence);
+			hand.handDirection	+= h.handDirection * w;
+			hand.pinchStrength	+= h.pinchStrength * w;
+			hand.grabStrength	+= h.grabStrength * w;
+			hand.palmWidth		+= h.palmWidth * w;
+			hand.timeVisible	= MAX(hand.timeVisible, h.timeVisible);
+			
+			//fingers come in the same order (thumb to pinky) from every device
+			bool bSameFingers = h.fingers.size() == hand.fingers.size();
+			for(int f = 0; f < hand.fingers.size(); f++){
+				const ofxLeapMotionSimpleHand::simpleFinger & src = bSameFingers ? h.fingers[f] : seed.fingers[f];
+				hand.fingers[f].pos		+= src.pos * w;
+				hand.fingers[f].vel		+= src.vel * w;
+				hand.fingers[f].base	+= src.base * w;
+			}
+			
+			totalWeight += w;
+		}
+		
+		hand.handPos		/= totalWeight;
+		hand.handVelocity	/= totalWeight;
+		hand.sphereCenter	/= totalWeight;
+		hand.sphereRadius	/= totalWeight;
+		hand.pinchStrength	/= totalWeight;
+		hand.grabStrength	/= totalWeight;
+		hand.palmWidth		/= totalWeight;
+		hand.handNormal.normalize();
+		hand.handDirection.normalize();
+		for(int f = 0; f < hand.fingers.size(); f++){
+			hand.fingers[f].pos		/= totalWeight;
+			hand.fingers[f].vel		/= totalWeight;
+			hand.fingers[f].base	/= totalWeight;
+		}
+		
+		merged.push_back(hand);
+	}
+	
+	//keep ids stable by matching to the closest hand of the previous fused frame
+	vector <bool> taken(fused.hands.size(), false);
+	for(int i = 0; i < merged.size(); i++){
+		int best = -1;
+		float bestDistSq = maxDistSq;
+		for(int j = 0; j < fused.hands.size(); j++){
+			float distSq = fused.hands[j].handPos.squareDistance(merged[i].handPos);
+			if( !taken[j] && distSq < bestDistSq ){
+				best = j;
+				bestDistSq = distSq;
+			}
+		}
+		
+		if( best >= 0 ){
+			taken[best] = true;
+			merged[i].id = fused.hands[best].id;
+		}else{
+			merged[i].id = nextHandId++;
+		}
+		
+		//same finger id scheme as the Leap - hand id * 10 + finger index
+		for(int f = 0; f < merged[i].fingers.size(); f++){
+			merged[i].fingers[f].id = merged[i].id * 10 + f;
+		}
+	}
+	
+	fused.id = frameCount++;
+	fused.timestamp = timestamp;
+	fused.hands.swap(merged);
+}
+
+//--------------------------------------------------------------
+const ofxLeapMotionSimpleFrame & ofxLeapMotionFusion::getSimpleFrame(){
+	return fused;
+}
+
+//--------------------------------------------------------------
+vector <ofxLeapMotionSimpleHand> ofxLeapMotionFusion::getSimpleHands(){
+	vector <ofxLeapMotionSimpleHand> simpleHands;
+	for(int i = 0; i < fused.hands.size(); i++){
+		simpleHands.push_back( mapping.map(fused.hands[i]) );
+	}
+	return simpleHands;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionFusion::resetMapping(){
+	mapping.reset();
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionFusion::setMappingX(float minX, float maxX, float outputMinX, float outputMaxX){
+	mapping.setX(minX, maxX, outputMinX, outputMaxX);
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionFusion::setMappingY(float minY, float maxY, float outputMinY, float outputMaxY){
+	mapping.setY(minY, maxY, outputMinY, outputMaxY);
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionFusion::setMappingZ(float minZ, float maxZ, float outputMinZ, float outputMaxZ){
+	mapping.setZ(minZ, maxZ, outputMinZ, outputMaxZ);
+}
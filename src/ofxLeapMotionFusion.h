@@ -0,0 +1,68 @@
+//ofxLeapMotionFusion - merges several Leap devices covering one volume into a single set of hands
+//each source has a transform from its own Leap space into the shared space. 
+//hands from different sources closer than the association distance are treated as the same hand 
+//and merged, weighted by Hand::confidence(). merged hands keep a stable id while they stay tracked.
+//sources can be ofxLeapMotion, ofxLeapMotionSharedSubscriber, ofxLeapMotionOscReceiver or an 
+//ofxLeapMotionFrameSource fed with synthetic / recorded data.
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxLeapMotionTypes.h"
+
+class ofxLeapMotionFusion{
+
+	public:
+	
+		ofxLeapMotionFusion();
+		
+		//returns the index of the source - the source needs to stay around while the fusion uses it
+		int addSource(ofxLeapMotionSource * source, ofMatrix4x4 transform = ofMatrix4x4());
+		void setTransform(int source, ofMatrix4x4 transform);
+		int getNumSources();
+		
+		//max palm distance in mm for hands from different sources to be merged
+		void setAssociationDistance(float mm);
+		
+		//a source whose latest frame is this much older than the newest frame of any source is left out of the merge
+		//so a device that stops sending doesn't leave its last hands behind
+		void setSourceTimeout(float seconds);
+		
+		//polls the sources and merges their latest frames - returns true if the merged frame changed
+		bool update();
+		
+		//merged frame in the shared space
+		const ofxLeapMotionSimpleFrame & getSimpleFrame();
+		vector <ofxLeapMotionSimpleHand> getSimpleHands();
+		
+		void resetMapping();
+		void setMappingX(float minX, float maxX, float outputMinX, float outputMaxX);
+		void setMappingY(float minY, float maxY, float outputMinY, float outputMaxY);
+		void setMappingZ(float minZ, float maxZ, float outputMinZ, float outputMaxZ);
+		
+		//merges frames that have already been transformed into the shared space
+		void merge(const vector <ofxLeapMotionSimpleFrame> & frames);
+		
+	protected:
+	
+		class Source{
+			public:
+				ofxLeapMotionSource * source;
+				ofMatrix4x4 transform;
+				int64_t lastFrameId;
+				bool bHasFrame;             // false when the source has no frame or it timed out
+				ofxLeapMotionSimpleFrame frame;
+		};
+		
+		ofxLeapMotionSimpleHand transformHand(const ofxLeapMotionSimpleHand & hand, const ofMatrix4x4 & transform);
+		
+		vector <Source> sources;
+		float associationDistance;
+		int64_t sourceTimeoutMicros;
+		
+		ofxLeapMotionSimpleFrame fused;
+		int64_t nextHandId;
+		int64_t frameCount;
+		
+		ofxLeapMotionMapping mapping;
+};
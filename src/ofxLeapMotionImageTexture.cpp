@@ -0,0 +1,177 @@
+/*
+ *  ofxLeapMotionImageTexture.cpp
+ *  ofxLeapMotion
+ *
+ */
+
+#include "ofxLeapMotionImageTexture.h"
+
+#define STRINGIFY(A) #A
+
+//the distortion map gives the position in the raw image for each ray - see Leap::Image::distortion()
+static const string undistortVert = STRINGIFY(
+	void main(){
+		gl_TexCoord[0] = gl_MultiTexCoord0;
+		gl_FrontColor = gl_Color;
+		gl_Position = ftransform();
+	}
+);
+
+static const string undistortFrag = STRINGIFY(
+	uniform sampler2D rawTex;
+	uniform sampler2D distortionTex;
+	
+	void main(){
+		vec2 uv = texture2D(distortionTex, gl_TexCoord[0].st).rg;
+		if( uv.x < 0.0 || uv.x > 1.0 || uv.y < 0.0 || uv.y > 1.0 ){
+			gl_FragColor = vec4(0.0, 0.0, 0.0, 1.0);
+		}else{
+			float v = texture2D(rawTex, uv).r;
+			gl_FragColor = vec4(v, v, v, 1.0) * gl_Color;
+		}
+	}
+);
+
+//--------------------------------------------------------------
+ofxLeapMotionImageTexture::ofxLeapMotionImageTexture()
+#if (OF_VERSION_MAJOR == 0) && (OF_VERSION_MINOR < 9)
+		:distortionVersion(-1)
+		,lastFrameId(-1) {
+#else
+		:distortionVersion(-1)
+		,pboIndex(0)
+		,lastFrameId(-1) {
+#endif
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionImageTexture::update(const ofxLeapMotionImage & image){
+	if( image.frameId == lastFrameId ){
+		return;
+	}
+	lastFrameId = image.frameId;
+	
+	update(image.pixels);
+	
+	if( image.distortion && image.distortion->version != distortionVersion ){
+		updateDistortion(*image.distortion);
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionImageTexture::updateDistortion(const ofxLeapMotionDistortion & distortion){
+	int gridW = distortion.width / 2;
+	int gridH = distortion.height;
+	if( gridW <= 0 || gridH <= 0 ){
+		return;
+	}
+	
+	if( !distortionTex.isAllocated() || distortionTex.getWidth() != gridW || distortionTex.getHeight() != gridH ){
+		distortionTex.allocate(gridW, gridH, GL_RG32F, false);
+		distortionTex.setTextureMinMagFilter(GL_LINEAR, GL_LINEAR);
+	}
+	distortionTex.loadData(&distortion.map[0], gridW, gridH, GL_RG);
+	distortionVersion = distortion.version;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionImageTexture::setupShader(){
+	undistortShader.setupShaderFromSource(GL_VERTEX_SHADER, undistortVert);
+	undistortShader.setupShaderFromSource(GL_FRAGMENT_SHADER, undistortFrag);
+	undistortShader.linkProgram();
+	
+	quad.clear();
+	quad.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
+	quad.addVertex(ofPoint(0, 0));
+	quad.addVertex(ofPoint(1, 0));
+	quad.addVertex(ofPoint(0, 1));
+	quad.addVertex(ofPoint(1, 1));
+	quad.addTexCoord(ofVec2f(0, 0));
+	quad.addTexCoord(ofVec2f(1, 0));
+	quad.addTexCoord(ofVec2f(0, 1));
+	quad.addTexCoord(ofVec2f(1, 1));
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionImageTexture::drawUndistorted(float x, float y, float w, float h){
+	if( !tex.isAllocated() || !distortionTex.isAllocated() ){
+		return;
+	}
+	
+	if( !undistortShader.isLoaded() ){
+		setupShader();
+	}
+	
+	undistortShader.begin();
+		undistortShader.setUniformTexture("rawTex", tex, 0);
+		undistortShader.setUniformTexture("distortionTex", distortionTex, 1);
+		ofPushMatrix();
+			ofTranslate(x, y);
+			ofScale(w, h, 1);
+			quad.draw();
+		ofPopMatrix();
+	undistortShader.end();
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionImageTexture::allocate(const ofPixels & pixels){
+	//normalized tex coords so the undistort shader can sample it
+	tex.allocate(pixels.getWidth(), pixels.getHeight(), ofGetGLInternalFormat(pixels), false);
+	tex.setTextureMinMagFilter(GL_LINEAR, GL_LINEAR);
+
+#if !((OF_VERSION_MAJOR == 0) && (OF_VERSION_MINOR < 9))
+	for(int i = 0; i < 2; i++){
+		pbo[i].allocate(pixels.getTotalBytes(), GL_STREAM_DRAW);
+	}
+	pboIndex = 0;
+#endif
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionImageTexture::update(const ofPixels & pixels){
+	if( !pixels.isAllocated() ){
+		return;
+	}
+	
+	if( !tex.isAllocated() || tex.getWidth() != pixels.getWidth() || tex.getHeight() != pixels.getHeight() ){
+		allocate(pixels);
+	}
+
+#if (OF_VERSION_MAJOR == 0) && (OF_VERSION_MINOR < 9)
+	tex.loadData(pixels);
+#else
+	ofBufferObject & buffer = pbo[pboIndex];
+	
+	unsigned char * dst = buffer.map<unsigned char>(GL_WRITE_ONLY);
+	if( dst ){
+		memcpy(dst, pixels.getData(), pixels.getTotalBytes());
+		buffer.unmap();
+		
+		//the texture is sourced from the buffer - the transfer is done by the driver without blocking us
+		tex.loadData(buffer, ofGetGLFormat(pixels), GL_UNSIGNED_BYTE);
+	}else{
+		tex.loadData(pixels);
+	}
+	
+	pboIndex = 1 - pboIndex;
+#endif
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionImageTexture::draw(float x, float y){
+	if( tex.isAllocated() ){
+		tex.draw(x, y);
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionImageTexture::draw(float x, float y, float w, float h){
+	if( tex.isAllocated() ){
+		tex.draw(x, y, w, h);
+	}
+}
+
+//--------------------------------------------------------------
+ofTexture & ofxLeapMotionImageTexture::getTexture(){
+	return tex;
+}
@@ -0,0 +1,52 @@
+//ofxLeapMotionImageTexture - uploads ofxLeapMotion camera images to a texture
+//the pixels are written into a pixel buffer object and the texture is updated from it
+//so the upload happens asynchronously and the render thread doesn't stall on glTexImage2D
+//only needed if you want to draw the images - for headless processing just use ofxLeapMotion::getImage()
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxLeapMotionTypes.h"
+
+class ofxLeapMotionImageTexture{
+
+	public:
+	
+		ofxLeapMotionImageTexture();
+		
+		//call from the GL thread after ofxLeapMotion::updateImages() 
+		void update(const ofxLeapMotionImage & image);
+		void update(const ofPixels & pixels);
+		
+		void draw(float x, float y);
+		void draw(float x, float y, float w, float h);
+		
+		//draws with the lens distortion removed on the GPU, using the distortion map of the last image
+		//the output covers the same ray slopes as ofxLeapMotionUndistort
+		//note: the shader is GLSL 1.20 so this needs the default (non programmable) renderer
+		void drawUndistorted(float x, float y, float w, float h);
+		
+		ofTexture & getTexture();
+		
+	protected:
+		
+		void allocate(const ofPixels & pixels);
+		void updateDistortion(const ofxLeapMotionDistortion & distortion);
+		void setupShader();
+	
+		ofTexture tex;
+		
+		ofTexture distortionTex;
+		int64_t distortionVersion;
+		ofShader undistortShader;
+		ofMesh quad;
+
+#if (OF_VERSION_MAJOR == 0) && (OF_VERSION_MINOR < 9)
+		//no buffer object support - falls back to a regular upload
+#else
+		//two pbos so we never map a buffer the GPU may still be reading from
+		ofBufferObject pbo[2];
+		int pboIndex;
+#endif
+		int64_t lastFrameId;
+};
@@ -0,0 +1,264 @@
+/*
+ *  ofxLeapMotionInteraction.cpp
+ *  ofxLeapMotion
+ *
+ */
+
+#include "ofxLeapMotionInteraction.h"
+
+#include <cfloat>
+
+//keeps the grid small when targets are spread far apart compared to the cell size
+static const int MAX_CELLS_PER_AXIS = 256;
+
+//--------------------------------------------------------------
+ofxLeapMotionInteraction::ofxLeapMotionInteraction(){
+	cellSize = 100;
+	numTargets = 0;
+	numCellsX = 0;
+	numCellsY = 0;
+	bDirty = true;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionInteraction::setCellSize(float size){
+	cellSize = MAX(1, size);
+	bDirty = true;
+}
+
+//--------------------------------------------------------------
+int ofxLeapMotionInteraction::addTarget(const ofRectangle & rect){
+	return addTarget(ofPoint(rect.getMinX(), rect.getMinY(), -FLT_MAX), ofPoint(rect.getMaxX(), rect.getMaxY(), FLT_MAX));
+}
+
+//--------------------------------------------------------------
+int ofxLeapMotionInteraction::addTarget(const ofPoint & min, const ofPoint & max){
+	Target target;
+	target.bActive = true;
+	target.numHovering = 0;
+	target.numPressing = 0;
+	targets.push_back(target);
+	numTargets++;
+	
+	setTarget(targets.size() - 1, min, max);
+	return targets.size() - 1;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionInteraction::setTarget(int target, const ofRectangle & rect){
+	setTarget(target, ofPoint(rect.getMinX(), rect.getMinY(), -FLT_MAX), ofPoint(rect.getMaxX(), rect.getMaxY(), FLT_MAX));
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionInteraction::setTarget(int target, const ofPoint & min, const ofPoint & max){
+	if( target < 0 || target >= targets.size() || !targets[target].bActive ){
+		ofLogWarning("ofxLeapMotionInteraction") << "setTarget(): no target " << target;
+		return;
+	}
+	Target & t = targets[target];
+	t.min.set(MIN(min.x, max.x), MIN(min.y, max.y), MIN(min.z, max.z));
+	t.max.set(MAX(min.x, max.x), MAX(min.y, max.y), MAX(min.z, max.z));
+	bDirty = true;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionInteraction::removeTarget(int target){
+	if( target < 0 || target >= targets.size() || !targets[target].bActive ){
+		return;
+	}
+	targets[target].bActive = false;
+	targets[target].numHovering = 0;
+	targets[target].numPressing = 0;
+	numTargets--;
+	bDirty = true;
+	
+	//fingertips on a removed target don't get a release or exit - the target is gone
+	for(std::map <int64_t, Pointer>::iterator it = pointers.begin(); it != pointers.end(); ++it){
+		if( it->second.target == target ){
+			it->second.target = -1;
+			it->second.bPressed = false;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionInteraction::clear(){
+	targets.clear();
+	numTargets = 0;
+	pointers.clear();
+	events.clear();
+	bDirty = true;
+}
+
+//--------------------------------------------------------------
+int ofxLeapMotionInteraction::getNumTargets(){
+	return numTargets;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionInteraction::rebuild(){
+	bDirty = false;
+	cells.clear();
+	numCellsX = 0;
+	numCellsY = 0;
+	
+	//the grid only needs to cover the targets - fingertips outside it land in an edge cell and miss every target there
+	ofPoint min(FLT_MAX, FLT_MAX);
+	ofPoint max(-FLT_MAX, -FLT_MAX);
+	for(int i = 0; i < targets.size(); i++){
+		if( targets[i].bActive ){
+			min.set(MIN(min.x, targets[i].min.x), MIN(min.y, targets[i].min.y), 0);
+			max.set(MAX(max.x, targets[i].max.x), MAX(max.y, targets[i].max.y), 0);
+		}
+	}
+	if( min.x > max.x ){
+		return;
+	}
+	
+	gridOrigin = min;
+	numCellsX = ofClamp(ceil((max.x - min.x) / cellSize), 1, MAX_CELLS_PER_AXIS);
+	numCellsY = ofClamp(ceil((max.y - min.y) / cellSize), 1, MAX_CELLS_PER_AXIS);
+	cells.resize(numCellsX * numCellsY);
+	
+	//targets go into every cell they overlap, in the order they were added
+	for(int i = 0; i < targets.size(); i++){
+		const Target & t = targets[i];
+		if( !t.bActive ){
+			continue;
+		}
+		int x0 = getCell(t.min.x, gridOrigin.x, numCellsX);
+		int x1 = getCell(t.max.x, gridOrigin.x, numCellsX);
+		int y0 = getCell(t.min.y, gridOrigin.y, numCellsY);
+		int y1 = getCell(t.max.y, gridOrigin.y, numCellsY);
+		for(int y = y0; y <= y1; y++){
+			for(int x = x0; x <= x1; x++){
+				cells[y * numCellsX + x].push_back(i);
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------
+int ofxLeapMotionInteraction::getCell(float v, float origin, int numCells){
+	return ofClamp(floor((v - origin) / cellSize), 0, numCells - 1);
+}
+
+//--------------------------------------------------------------
+int ofxLeapMotionInteraction::getTargetAt(const ofPoint & pos){
+	if( bDirty ){
+		rebuild();
+	}
+	if( cells.empty() ){
+		return -1;
+	}
+	
+	const vector <int> & cell = cells[getCell(pos.y, gridOrigin.y, numCellsY) * numCellsX + getCell(pos.x, gridOrigin.x, numCellsX)];
+	
+	//last added is on top
+	for(int i = cell.size() - 1; i >= 0; i--){
+		const Target & t = targets[cell[i]];
+		if( pos.x >= t.min.x && pos.x <= t.max.x && pos.y >= t.min.y && pos.y <= t.max.y && pos.z >= t.min.z && pos.z <= t.max.z ){
+			return cell[i];
+		}
+	}
+	return -1;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionInteraction::update(const vector <ofxLeapMotionSimpleHand> & mappedHands){
+	events.clear();
+	
+	for(std::map <int64_t, Pointer>::iterator it = pointers.begin(); it != pointers.end(); ++it){
+		it->second.bSeen = false;
+	}
+	
+	for(int i = 0; i < mappedHands.size(); i++){
+		const ofxLeapMotionSimpleHand & hand = mappedHands[i];
+		for(int j = 0; j < hand.fingers.size(); j++){
+			const ofxLeapMotionSimpleHand::simpleFinger & finger = hand.fingers[j];
+			
+			Pointer & pointer = pointers[finger.id];
+			pointer.bSeen = true;
+			pointer.handId = hand.id;
+			pointer.finger = finger;
+			
+			//out of the touch zone a fingertip doesn't interact with anything
+			bool bTouching = finger.touchZone == OFX_LEAP_TOUCH_TOUCHING;
+			int target = finger.touchZone != OFX_LEAP_TOUCH_NONE ? getTargetAt(finger.pos) : -1;
+			
+			//a press starts by crossing the touch plane over the target and lasts while the fingertip stays on it
+			bool bPressed = false;
+			if( target >= 0 && bTouching ){
+				bPressed = pointer.bPressed ? pointer.target == target : !pointer.bTouching;
+			}
+			
+			setPointerTarget(pointer, target, bPressed);
+			pointer.bTouching = bTouching;
+		}
+	}
+	
+	//fingertips that weren't in this frame are released and leave their target
+	std::map <int64_t, Pointer>::iterator it = pointers.begin();
+	while( it != pointers.end() ){
+		if( !it->second.bSeen ){
+			setPointerTarget(it->second, -1, false);
+			pointers.erase(it++);
+		}else{
+			++it;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionInteraction::setPointerTarget(Pointer & pointer, int target, bool bPressed){
+	if( pointer.bPressed && (!bPressed || target != pointer.target) ){
+		addEvent(OFX_LEAP_TOUCH_RELEASE, pointer.target, pointer);
+		targets[pointer.target].numPressing--;
+		pointer.bPressed = false;
+	}
+	
+	if( target != pointer.target ){
+		if( pointer.target >= 0 ){
+			addEvent(OFX_LEAP_TOUCH_EXIT, pointer.target, pointer);
+			targets[pointer.target].numHovering--;
+		}
+		if( target >= 0 ){
+			addEvent(OFX_LEAP_TOUCH_ENTER, target, pointer);
+			targets[target].numHovering++;
+		}
+		pointer.target = target;
+	}
+	
+	if( bPressed && !pointer.bPressed ){
+		addEvent(OFX_LEAP_TOUCH_PRESS, target, pointer);
+		targets[target].numPressing++;
+		pointer.bPressed = true;
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionInteraction::addEvent(ofxLeapMotionTouchEventType type, int target, const Pointer & pointer){
+	ofxLeapMotionTouchEvent e;
+	e.type = type;
+	e.target = target;
+	e.handId = pointer.handId;
+	e.fingerId = pointer.finger.id;
+	e.pos = pointer.finger.pos;
+	e.touchDistance = pointer.finger.touchDistance;
+	events.push_back(e);
+}
+
+//--------------------------------------------------------------
+const vector <ofxLeapMotionTouchEvent> & ofxLeapMotionInteraction::getEvents(){
+	return events;
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionInteraction::isHovered(int target){
+	return target >= 0 && target < targets.size() && targets[target].numHovering > 0;
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionInteraction::isPressed(int target){
+	return target >= 0 && target < targets.size() && targets[target].numPressing > 0;
+}
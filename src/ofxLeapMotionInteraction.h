@@ -0,0 +1,123 @@
+//ofxLeapMotionInteraction - hover, press and release of UI targets by fingertips
+//targets are boxes in mapped coordinates (the ofxLeapMotion setMapping* space - usually screen pixels)
+//and are kept in a uniform grid, so each fingertip only tests the targets in its own cell.
+//a fingertip hovers when Leap puts it in the hovering or touching zone, and presses when it is touching.
+//
+//  interaction.setCellSize(100);
+//  int button = interaction.addTarget(ofRectangle(20, 20, 200, 80));
+//  ...
+//  if( leap.isFrameNew() ){
+//      interaction.update(leap.getSimpleHands());
+//      for(auto & e : interaction.getEvents()) if( e.type == OFX_LEAP_TOUCH_PRESS && e.target == button ) ...
+//  }
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxLeapMotionTypes.h"
+
+#include <map>
+
+enum ofxLeapMotionTouchEventType{
+	OFX_LEAP_TOUCH_ENTER = 0,           // a fingertip started hovering over the target
+	OFX_LEAP_TOUCH_PRESS,               // a fingertip over the target went through the touch plane
+	OFX_LEAP_TOUCH_RELEASE,             // a pressing fingertip pulled back, moved off the target or was lost
+	OFX_LEAP_TOUCH_EXIT                 // a fingertip stopped hovering over the target
+};
+
+class ofxLeapMotionTouchEvent{
+	
+	public:
+		
+		ofxLeapMotionTouchEventType type;
+		int target;                         // id from addTarget()
+		int64_t handId;
+		int64_t fingerId;
+		ofPoint pos;                        // mapped fingertip position
+		float touchDistance;
+};
+
+class ofxLeapMotionInteraction{
+	
+	public:
+		
+		ofxLeapMotionInteraction();
+		
+		//the grid cell size in mapped units - roughly the size of a typical target works well
+		void setCellSize(float size);
+		
+		//targets are tested in x and y only when added as a rectangle, in x, y and z when added as a box
+		//when targets overlap the one added last wins - like drawing order
+		//returns the target id
+		int addTarget(const ofRectangle & rect);
+		int addTarget(const ofPoint & min, const ofPoint & max);
+		
+		void setTarget(int target, const ofRectangle & rect);
+		void setTarget(int target, const ofPoint & min, const ofPoint & max);
+		void removeTarget(int target);
+		void clear();
+		
+		int getNumTargets();
+		
+		//call once per frame with mapped hands, eg: from ofxLeapMotion::getSimpleHands() - fills getEvents()
+		void update(const vector <ofxLeapMotionSimpleHand> & mappedHands);
+		
+		//events from the last update() in the order they happened
+		const vector <ofxLeapMotionTouchEvent> & getEvents();
+		
+		//true while at least one fingertip is over / pressing the target
+		bool isHovered(int target);
+		bool isPressed(int target);
+		
+		//the topmost target at a mapped point, -1 if none
+		int getTargetAt(const ofPoint & pos);
+	
+	protected:
+		
+		class Target{
+			public:
+				ofPoint min;
+				ofPoint max;
+				bool bActive;
+				int numHovering;
+				int numPressing;
+		};
+		
+		class Pointer{
+			public:
+				Pointer(){
+					target = -1;
+					bPressed = false;
+					bTouching = false;
+					bSeen = false;
+					handId = -1;
+				}
+				int target;
+				bool bPressed;
+				bool bTouching;             // was through the touch plane last frame - a press needs it to cross
+				bool bSeen;
+				int64_t handId;
+				ofxLeapMotionSimpleHand::simpleFinger finger;
+		};
+		
+		void rebuild();
+		int getCell(float v, float origin, int numCells);
+		void addEvent(ofxLeapMotionTouchEventType type, int target, const Pointer & pointer);
+		void setPointerTarget(Pointer & pointer, int target, bool bPressed);
+		
+		//removed targets stay in the list inactive so ids and the order between targets don't change
+		vector <Target> targets;
+		int numTargets;
+		
+		//uniform grid over the bounds of all targets - rebuilt lazily after targets change
+		float cellSize;
+		bool bDirty;
+		ofPoint gridOrigin;
+		int numCellsX;
+		int numCellsY;
+		vector <vector <int> > cells;
+		
+		//keyed by finger id
+		std::map <int64_t, Pointer> pointers;
+		vector <ofxLeapMotionTouchEvent> events;
+};
@@ -0,0 +1,469 @@
+/*
+ *  ofxLeapMotionOsc.cpp
+ *  ofxLeapMotion
+ *
+ */
+
+#include "ofxLeapMotionOsc.h"
+
+//OSC is big endian and everything is padded to 4 bytes
+//--------------------------------------------------------------
+static void writeInt32(string & out, int32_t v){
+	uint32_t u = (uint32_t)v;
+	char b[4] = { (char)(u >> 24), (char)(u >> 16), (char)(u >> 8), (char)u };
+	out.append(b, 4);
+}
+
+//--------------------------------------------------------------
+static void writeInt64(string & out, int64_t v){
+	writeInt32(out, (int32_t)((uint64_t)v >> 32));
+	writeInt32(out, (int32_t)(uint64_t)v);
+}
+
+//--------------------------------------------------------------
+static void writeFloat(string & out, float f){
+	int32_t v;
+	memcpy(&v, &f, 4);
+	writeInt32(out, v);
+}
+
+//--------------------------------------------------------------
+static void writeString(string & out, const char * s){
+	size_t len = strlen(s);
+	out.append(s, len);
+	out.append(4 - (len % 4), '\0');
+}
+
+//--------------------------------------------------------------
+static void writePoint(string & out, const ofPoint & p){
+	writeFloat(out, p.x);
+	writeFloat(out, p.y);
+	writeFloat(out, p.z);
+}
+
+//--------------------------------------------------------------
+static void setInt32(string & out, size_t pos, int32_t v){
+	uint32_t u = (uint32_t)v;
+	out[pos] = (char)(u >> 24);
+	out[pos+1] = (char)(u >> 16);
+	out[pos+2] = (char)(u >> 8);
+	out[pos+3] = (char)u;
+}
+
+//--------------------------------------------------------------
+class ofxLeapMotionOscReader{
+	public:
+	
+		ofxLeapMotionOscReader(const char * d, int s){
+			data = (const unsigned char *)d;
+			end = data + s;
+			bOk = true;
+		}
+		
+		int32_t readInt32(){
+			if( end - data < 4 ){
+				bOk = false;
+				return 0;
+			}
+			uint32_t u = ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | (uint32_t)data[3];
+			data += 4;
+			return (int32_t)u;
+		}
+		
+		int64_t readInt64(){
+			uint64_t hi = (uint32_t)readInt32();
+			uint64_t lo = (uint32_t)readInt32();
+			return (int64_t)((hi << 32) | lo);
+		}
+		
+		float readFloat(){
+			int32_t v = readInt32();
+			float f;
+			memcpy(&f, &v, 4);
+			return f;
+		}
+		
+		ofPoint readPoint(){
+			float x = readFloat();
+			float y = readFloat();
+			float z = readFloat();
+			return ofPoint(x, y, z);
+		}
+		
+		string readString(){
+			const unsigned char * start = data;
+			while( data < end && *data ){
+				data++;
+			}
+			if( data >= end ){
+				bOk = false;
+				return "";
+			}
+			string s((const char *)start, data - start);
+			size_t padded = (s.size() / 4 + 1) * 4;
+			data = start + MIN(padded, (size_t)(end - start));
+			return s;
+		}
+	
+		const unsigned char * data;
+		const unsigned char * end;
+		bool bOk;
+};
+
+// ofxLeapMotionOscSender
+//--------------------------------------------------------------
+ofxLeapMotionOscSender::ofxLeapMotionOscSender()
+		:bRunning(false)
+		,bPending(false)
+		,maxRate(0)
+		,numSent(0)
+		,numCoalesced(0) {
+	//big enough for a few hands - grows if needed but normally never reallocates
+	buffer.reserve(4096);
+}
+
+//--------------------------------------------------------------
+ofxLeapMotionOscSender::~ofxLeapMotionOscSender(){
+	close();
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionOscSender::setup(string host, int port){
+	close();
+	
+	if( !udp.connect(host, port) ){
+		return false;
+	}
+	
+	bRunning = true;
+	thread = std::thread(&ofxLeapMotionOscSender::threadedFunction, this);
+	return true;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionOscSender::close(){
+	if( thread.joinable() ){
+		{
+			std::unique_lock <std::mutex> lock(mutex);
+			bRunning = false;
+		}
+		condition.notify_all();
+		thread.join();
+	}
+	udp.close();
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionOscSender::setMaxRate(float bundlesPerSecond){
+	std::unique_lock <std::mutex> lock(mutex);
+	maxRate = MAX(0, bundlesPerSecond);
+}
+
+//--------------------------------------------------------------
+uint64_t ofxLeapMotionOscSender::getNumSent(){
+	std::unique_lock <std::mutex> lock(mutex);
+	return numSent;
+}
+
+//--------------------------------------------------------------
+uint64_t ofxLeapMotionOscSender::getNumCoalesced(){
+	std::unique_lock <std::mutex> lock(mutex);
+	return numCoalesced;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionOscSender::send(const ofxLeapMotionSimpleFrame & frame){
+	{
+		std::unique_lock <std::mutex> lock(mutex);
+		if( bPending ){
+			numCoalesced++;
+		}
+		pending = frame;
+		bPending = true;
+	}
+	condition.notify_one();
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionOscSender::encode(const ofxLeapMotionSimpleFrame & frame){
+	buffer.clear();
+	
+	writeString(buffer, "#bundle");
+	writeInt64(buffer, 1);                  // timetag 1 = immediately
+	
+	size_t sizePos;
+	
+	//each element is prefixed with its size which is filled in once it is written
+	sizePos = buffer.size();
+	writeInt32(buffer, 0);
+	writeString(buffer, "/leap/frame");
+	writeString(buffer, ",hhi");
+	writeInt64(buffer, frame.id);
+	writeInt64(buffer, frame.timestamp);
+	writeInt32(buffer, frame.hands.size());
+	setInt32(buffer, sizePos, buffer.size() - sizePos - 4);
+	
+	for(int i = 0; i < frame.hands.size(); i++){
+		const ofxLeapMotionSimpleHand & hand = frame.hands[i];
+		
+		sizePos = buffer.size();
+		writeInt32(buffer, 0);
+		writeString(buffer, "/leap/hand");
+		writeString(buffer, ",ifffffffffffffi");
+		writeInt32(buffer, hand.id);
+		writePoint(buffer, hand.handPos);
+		writePoint(buffer, hand.handNormal);
+		writePoint(buffer, hand.handVelocity);
+		writePoint(buffer, hand.sphereCenter);
+		writeFloat(buffer, hand.sphereRadius);
+		writeInt32(buffer, hand.fingers.size());
+		setInt32(buffer, sizePos, buffer.size() - sizePos - 4);
+		
+		for(int j = 0; j < hand.fingers.size(); j++){
+			const ofxLeapMotionSimpleHand::simpleFinger & finger = hand.fingers[j];
+			
+			sizePos = buffer.size();
+			writeInt32(buffer, 0);
+			writeString(buffer, "/leap/finger");
+			writeString(buffer, ",iifffffffff");
+			writeInt32(buffer, hand.id);
+			writeInt32(buffer, finger.id);
+			writePoint(buffer, finger.pos);
+			writePoint(buffer, finger.vel);
+			writePoint(buffer, finger.base);
+			setInt32(buffer, sizePos, buffer.size() - sizePos - 4);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionOscSender::threadedFunction(){
+	uint64_t lastSendTime = 0;
+	
+	while( true ){
+		float rate;
+		{
+			std::unique_lock <std::mutex> lock(mutex);
+			while( bRunning && !bPending ){
+				condition.wait(lock);
+			}
+			if( !bRunning ){
+				break;
+			}
+			rate = maxRate;
+		}
+		
+		//wait out the rate limit - frames arriving meanwhile replace the pending one
+		if( rate > 0 ){
+			uint64_t interval = 1000000.0 / rate;
+			uint64_t now = ofGetElapsedTimeMicros();
+			if( lastSendTime && now < lastSendTime + interval ){
+				std::this_thread::sleep_for(std::chrono::microseconds(lastSendTime + interval - now));
+			}
+		}
+		
+		{
+			std::unique_lock <std::mutex> lock(mutex);
+			if( !bRunning ){
+				break;
+			}
+			std::swap(sending, pending);
+			bPending = false;
+		}
+		
+		encode(sending);
+		lastSendTime = ofGetElapsedTimeMicros();
+		
+		if( udp.send(buffer.data(), buffer.size()) == (int)buffer.size() ){
+			std::unique_lock <std::mutex> lock(mutex);
+			numSent++;
+		}
+	}
+}
+
+// ofxLeapMotionOscReceiver
+//--------------------------------------------------------------
+ofxLeapMotionOscReceiver::ofxLeapMotionOscReceiver()
+		:bRunning(false)
+		,preFrameId(-1) {
+}
+
+//--------------------------------------------------------------
+ofxLeapMotionOscReceiver::~ofxLeapMotionOscReceiver(){
+	close();
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionOscReceiver::setup(int port){
+	close();
+	
+	if( !udp.bind(port) ){
+		return false;
+	}
+	
+	bRunning = true;
+	thread = std::thread(&ofxLeapMotionOscReceiver::threadedFunction, this);
+	return true;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionOscReceiver::close(){
+	if( thread.joinable() ){
+		bRunning = false;
+		thread.join();
+	}
+	udp.close();
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionOscReceiver::decode(const char * data, int size, ofxLeapMotionSimpleFrame & frame){
+	ofxLeapMotionOscReader reader(data, size);
+	if( reader.readString() != "#bundle" ){
+		return false;
+	}
+	reader.readInt64();
+	
+	frame.hands.clear();
+	bool bHasFrame = false;
+	int numHands = 0;
+	vector <int> numFingers;
+	
+	while( reader.bOk && reader.data < reader.end ){
+		int32_t elementSize = reader.readInt32();
+		if( !reader.bOk || elementSize < 0 || elementSize > reader.end - reader.data ){
+			return false;
+		}
+		
+		ofxLeapMotionOscReader msg((const char *)reader.data, elementSize);
+		reader.data += elementSize;
+		
+		string address = msg.readString();
+		string types = msg.readString();
+		
+		if( address == "/leap/frame" && types == ",hhi" ){
+			frame.id = msg.readInt64();
+			frame.timestamp = msg.readInt64();
+			numHands = msg.readInt32();
+			bHasFrame = true;
+		}else if( address == "/leap/hand" && types == ",ifffffffffffffi" ){
+			ofxLeapMotionSimpleHand hand;
+			hand.id = msg.readInt32();
+			hand.handPos = msg.readPoint();
+			hand.handNormal = msg.readPoint();
+			hand.handVelocity = msg.readPoint();
+			hand.sphereCenter = msg.readPoint();
+			hand.sphereRadius = msg.readFloat();
+			numFingers.push_back(msg.readInt32());
+			frame.hands.push_back(hand);
+		}else if( address == "/leap/finger" && types == ",iifffffffff" ){
+			int64_t handId = msg.readInt32();
+			ofxLeapMotionSimpleHand::simpleFinger finger;
+			finger.id = msg.readInt32();
+			finger.pos = msg.readPoint();
+			finger.vel = msg.readPoint();
+			finger.base = msg.readPoint();
+			
+			//fingers follow their hand so it's normally the last one
+			for(int i = (int)frame.hands.size() - 1; i >= 0; i--){
+				if( frame.hands[i].id == handId ){
+					frame.hands[i].fingers.push_back(finger);
+					break;
+				}
+			}
+		}
+		
+		if( !msg.bOk ){
+			return false;
+		}
+	}
+	
+	//a bundle cut short between two messages still parses - the counts say whether all of it arrived
+	if( !bHasFrame || frame.hands.size() != numHands ){
+		return false;
+	}
+	for(int i = 0; i < frame.hands.size(); i++){
+		if( frame.hands[i].fingers.size() != numFingers[i] ){
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionOscReceiver::threadedFunction(){
+	vector <char> packet(65536);
+	ofxLeapMotionSimpleFrame received;
+	
+	while( bRunning ){
+		int size = udp.receive(&packet[0], packet.size(), 100);
+		if( size <= 0 ){
+			continue;
+		}
+		
+		if( decode(&packet[0], size, received) ){
+			std::unique_lock <std::mutex> lock(mutex);
+			std::swap(frame, received);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionOscReceiver::isFrameNew(){
+	return getCurrentFrameID() != preFrameId;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionOscReceiver::markFrameAsOld(){
+	preFrameId = getCurrentFrameID();
+}
+
+//--------------------------------------------------------------
+int64_t ofxLeapMotionOscReceiver::getCurrentFrameID(){
+	std::unique_lock <std::mutex> lock(mutex);
+	return frame.id;
+}
+
+//--------------------------------------------------------------
+ofxLeapMotionSimpleFrame ofxLeapMotionOscReceiver::getSimpleFrame(){
+	std::unique_lock <std::mutex> lock(mutex);
+	return frame;
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionOscReceiver::getSimpleFrame(ofxLeapMotionSimpleFrame & out){
+	std::unique_lock <std::mutex> lock(mutex);
+	out = frame;
+	return frame.id >= 0;
+}
+
+//--------------------------------------------------------------
+vector <ofxLeapMotionSimpleHand> ofxLeapMotionOscReceiver::getSimpleHands(){
+	ofxLeapMotionSimpleFrame cur = getSimpleFrame();
+	
+	vector <ofxLeapMotionSimpleHand> simpleHands;
+	for(int i = 0; i < cur.hands.size(); i++){
+		simpleHands.push_back( mapping.map(cur.hands[i]) );
+	}
+	return simpleHands;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionOscReceiver::resetMapping(){
+	mapping.reset();
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionOscReceiver::setMappingX(float minX, float maxX, float outputMinX, float outputMaxX){
+	mapping.setX(minX, maxX, outputMinX, outputMaxX);
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionOscReceiver::setMappingY(float minY, float maxY, float outputMinY, float outputMaxY){
+	mapping.setY(minY, maxY, outputMinY, outputMaxY);
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionOscReceiver::setMappingZ(float minZ, float maxZ, float outputMinZ, float outputMaxZ){
+	mapping.setZ(minZ, maxZ, outputMinZ, outputMaxZ);
+}
@@ -0,0 +1,103 @@
+//ofxLeapMotionOscSender / ofxLeapMotionOscReceiver - stream simple hand frames as OSC over UDP
+//each frame is sent as one bundle:
+//
+//  /leap/frame   ,hhi              frame id, timestamp (microseconds), number of hands
+//  /leap/hand    ,ifffffffffffffi  hand id, position, normal, velocity, sphere center, sphere radius, number of fingers
+//  /leap/finger  ,iifffffffff      hand id, finger id, tip position, tip velocity, base position
+//
+//values are in Leap mm - the receiver has the same setMapping* / getSimpleHands() interface as ofxLeapMotion.
+//the sender encodes and sends from its own thread. if frames arrive faster than they can be sent 
+//(or faster than the rate limit) only the newest one is sent.
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxLeapMotionTypes.h"
+#include "ofxLeapMotionUdp.h"
+
+#include <atomic>
+#include <condition_variable>
+
+class ofxLeapMotionOscSender{
+
+	public:
+	
+		ofxLeapMotionOscSender();
+		~ofxLeapMotionOscSender();
+		
+		bool setup(string host, int port);
+		void close();
+		
+		//max bundles per second - 0 sends every frame
+		void setMaxRate(float bundlesPerSecond);
+		
+		//call with frames from ofxLeapMotion::getSimpleFrame() - never blocks
+		void send(const ofxLeapMotionSimpleFrame & frame);
+		
+		uint64_t getNumSent();
+		uint64_t getNumCoalesced();
+		
+	protected:
+	
+		void threadedFunction();
+		void encode(const ofxLeapMotionSimpleFrame & frame);
+		
+		ofxLeapMotionUdp udp;
+		std::thread thread;
+		std::mutex mutex;
+		std::condition_variable condition;
+		bool bRunning;
+		
+		//mailbox of one - a newer frame replaces one that hasn't been sent yet
+		ofxLeapMotionSimpleFrame pending;
+		bool bPending;
+		
+		//only touched by the sending thread
+		ofxLeapMotionSimpleFrame sending;
+		string buffer;
+		
+		float maxRate;
+		uint64_t numSent;
+		uint64_t numCoalesced;
+};
+
+class ofxLeapMotionOscReceiver : public ofxLeapMotionSource{
+
+	public:
+	
+		ofxLeapMotionOscReceiver();
+		~ofxLeapMotionOscReceiver();
+		
+		bool setup(int port);
+		void close();
+		
+		bool isFrameNew();
+		void markFrameAsOld();
+		int64_t getCurrentFrameID();
+		
+		ofxLeapMotionSimpleFrame getSimpleFrame();
+		bool getSimpleFrame(ofxLeapMotionSimpleFrame & frame);
+		vector <ofxLeapMotionSimpleHand> getSimpleHands();
+		
+		void resetMapping();
+		void setMappingX(float minX, float maxX, float outputMinX, float outputMaxX);
+		void setMappingY(float minY, float maxY, float outputMinY, float outputMaxY);
+		void setMappingZ(float minZ, float maxZ, float outputMinZ, float outputMaxZ);
+		
+		//decodes one bundle from the sender - returns false if it isn't one or some of it is missing
+		static bool decode(const char * data, int size, ofxLeapMotionSimpleFrame & frame);
+		
+	protected:
+	
+		void threadedFunction();
+		
+		ofxLeapMotionUdp udp;
+		std::thread thread;
+		std::atomic <bool> bRunning;
+		
+		std::mutex mutex;
+		ofxLeapMotionSimpleFrame frame;
+		int64_t preFrameId;
+		
+		ofxLeapMotionMapping mapping;
+};
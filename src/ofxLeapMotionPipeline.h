@@ -0,0 +1,224 @@
+//ofxLeapMotionPipeline - runs per frame work through a fixed list of stages on a worker thread
+//ofxLeapMotion uses it as: extract -> filter -> map -> features -> publish
+//
+//frames are pushed from the Leap thread and never block it. if the worker is still busy with a frame
+//the pending one is replaced by the newer one - so the pipeline never falls behind, it drops frames instead.
+//each stage is timed so you can see where the time goes - see getTiming()
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+
+enum ofxLeapMotionPipelineStage{
+	OFX_LEAP_STAGE_EXTRACT = 0,
+	OFX_LEAP_STAGE_FILTER,
+	OFX_LEAP_STAGE_MAP,
+	OFX_LEAP_STAGE_FEATURES,
+	OFX_LEAP_STAGE_PUBLISH,
+	OFX_LEAP_NUM_STAGES
+};
+
+class ofxLeapMotionPipelineTiming{
+	
+	public:
+		
+		ofxLeapMotionPipelineTiming()
+			:numFrames(0)
+			,lastMicros(0)
+			,averageMicros(0)
+			,maxMicros(0){
+		}
+		
+		void add(float micros){
+			averageMicros = numFrames ? averageMicros * 0.95 + micros * 0.05 : micros;
+			maxMicros = numFrames ? std::max(maxMicros, micros) : micros;
+			lastMicros = micros;
+			numFrames++;
+		}
+		
+		uint64_t numFrames;
+		float lastMicros;
+		float averageMicros;                // moving average over roughly the last 20 frames
+		float maxMicros;
+};
+
+template <class Job>
+class ofxLeapMotionPipeline{
+	
+	public:
+		
+		typedef std::function <void(Job &)> StageFunction;
+		
+		ofxLeapMotionPipeline()
+			:bRunning(false)
+			,pendingPushTime(0)
+			,bPending(false)
+			,numDropped(0)
+			,workingPushTime(0){
+		}
+		
+		~ofxLeapMotionPipeline(){
+			stop();
+		}
+		
+		//set the stages before start() - a stage without a function is skipped
+		void setStage(ofxLeapMotionPipelineStage stage, StageFunction function){
+			stages[stage] = function;
+		}
+		
+		void start(){
+			if( thread.joinable() ){
+				return;
+			}
+			bRunning = true;
+			thread = std::thread(&ofxLeapMotionPipeline::threadedFunction, this);
+		}
+		
+		//waits for the frame being processed to finish - a pending frame is thrown away
+		void stop(){
+			if( thread.joinable() ){
+				{
+					std::unique_lock <std::mutex> lock(mutex);
+					bRunning = false;
+				}
+				condition.notify_all();
+				thread.join();
+			}
+			
+			//let go of whatever the jobs hold
+			std::unique_lock <std::mutex> lock(mutex);
+			bPending = false;
+			pending = Job();
+			working = Job();
+		}
+		
+		bool isRunning(){
+			return thread.joinable();
+		}
+		
+		//runs the stages on the calling thread instead of the worker - nothing is dropped and the order is fixed
+		//for replaying frames deterministically, don't use while the worker is running
+		void process(Job & job){
+			runStages(job, now());
+		}
+		
+		//never blocks on the stages - only on a short lock to hand the job over
+		void push(const Job & job){
+			{
+				std::unique_lock <std::mutex> lock(mutex);
+				if( bPending ){
+					numDropped++;
+				}
+				pending = job;
+				pendingPushTime = now();
+				bPending = true;
+			}
+			condition.notify_one();
+		}
+		
+		ofxLeapMotionPipelineTiming getTiming(ofxLeapMotionPipelineStage stage){
+			std::unique_lock <std::mutex> lock(timingMutex);
+			return timings[stage];
+		}
+		
+		//time from push() to the end of the last stage, including waiting for the worker
+		ofxLeapMotionPipelineTiming getLatency(){
+			std::unique_lock <std::mutex> lock(timingMutex);
+			return latency;
+		}
+		
+		//frames replaced by a newer one before the worker got to them
+		uint64_t getNumDropped(){
+			std::unique_lock <std::mutex> lock(mutex);
+			return numDropped;
+		}
+		
+		void resetTimings(){
+			std::unique_lock <std::mutex> lock(timingMutex);
+			for(int i = 0; i < OFX_LEAP_NUM_STAGES; i++){
+				timings[i] = ofxLeapMotionPipelineTiming();
+			}
+			latency = ofxLeapMotionPipelineTiming();
+		}
+		
+		static std::string getStageName(ofxLeapMotionPipelineStage stage){
+			switch(stage){
+				case OFX_LEAP_STAGE_EXTRACT:	return "extract";
+				case OFX_LEAP_STAGE_FILTER:		return "filter";
+				case OFX_LEAP_STAGE_MAP:		return "map";
+				case OFX_LEAP_STAGE_FEATURES:	return "features";
+				case OFX_LEAP_STAGE_PUBLISH:	return "publish";
+				default:						return "";
+			}
+		}
+	
+	protected:
+		
+		static int64_t now(){
+			return std::chrono::duration_cast <std::chrono::microseconds> (std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+		
+		void threadedFunction(){
+			while( true ){
+				{
+					std::unique_lock <std::mutex> lock(mutex);
+					while( bRunning && !bPending ){
+						condition.wait(lock);
+					}
+					if( !bRunning ){
+						break;
+					}
+					std::swap(working, pending);
+					workingPushTime = pendingPushTime;
+					bPending = false;
+				}
+				
+				runStages(working, workingPushTime);
+			}
+		}
+		
+		void runStages(Job & job, int64_t pushTime){
+			float micros[OFX_LEAP_NUM_STAGES];
+			for(int i = 0; i < OFX_LEAP_NUM_STAGES; i++){
+				int64_t start = now();
+				if( stages[i] ){
+					stages[i](job);
+				}
+				micros[i] = now() - start;
+			}
+			
+			std::unique_lock <std::mutex> lock(timingMutex);
+			for(int i = 0; i < OFX_LEAP_NUM_STAGES; i++){
+				timings[i].add(micros[i]);
+			}
+			latency.add(now() - pushTime);
+		}
+		
+		StageFunction stages[OFX_LEAP_NUM_STAGES];
+		
+		std::thread thread;
+		std::mutex mutex;
+		std::condition_variable condition;
+		bool bRunning;
+		
+		//mailbox of one - a newer job replaces one the worker hasn't started
+		Job pending;
+		int64_t pendingPushTime;
+		bool bPending;
+		uint64_t numDropped;
+		
+		//only touched by the worker
+		Job working;
+		int64_t workingPushTime;
+		
+		std::mutex timingMutex;
+		ofxLeapMotionPipelineTiming timings[OFX_LEAP_NUM_STAGES];
+		ofxLeapMotionPipelineTiming latency;
+};
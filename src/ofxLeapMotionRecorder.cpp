@@ -0,0 +1,723 @@
+/*
+ *  ofxLeapMotionRecorder.cpp
+ *  ofxLeapMotion
+ *
+ */
+
+#include "ofxLeapMotionRecorder.h"
+
+#include <climits>
+
+static const char * fileMagic	= "OFXLEAP1";
+static const char * indexMagic	= "OFXLIDX1";
+static const uint32_t fileVersion = 2;        // 1 had no tools, gestures or the hand and finger extras - still read
+
+//values per hand / finger / tool / gesture and how finely they are quantized
+static const int numHandValues		= 22;
+static const int numFingerValues	= 11;
+static const int numToolValues		= 14;
+static const int numGestureValues	= 16;
+static const int maxValues			= numHandValues;
+static const float posScale			= 10.0;       // 0.1 mm
+static const float normalScale		= 10000.0;    // also strengths, confidence and touch distance
+static const float timeScale		= 1000.0;     // ms
+
+//what is in a frame of each file version - and the fewest bytes each part can be encoded in
+//counts read from a file are checked against them
+class ofxLeapMotionRecordingFormat{
+	
+	public:
+		
+		ofxLeapMotionRecordingFormat(uint32_t version){
+			bExtras = version >= 2;
+			numHandValues = bExtras ? ::numHandValues : 13;
+			numFingerValues = bExtras ? ::numFingerValues : 9;
+			minFrameBytes = bExtras ? 5 : 3;
+			minHandBytes = 2 + numHandValues;
+			minFingerBytes = 1 + numFingerValues;
+		}
+		
+		bool bExtras;                       // tools, gestures and the hand and finger extras
+		int numHandValues;
+		int numFingerValues;
+		int minFrameBytes;
+		int minHandBytes;
+		int minFingerBytes;
+};
+
+static const int minToolBytes		= 2 + numToolValues;
+static const int minGestureBytes	= 3 + numGestureValues;
+static const int blockHeaderBytes	= 2 * sizeof(uint32_t);
+static const int indexEntryBytes	= sizeof(uint64_t) + sizeof(int64_t) + sizeof(uint32_t);
+static const int footerBytes		= sizeof(uint32_t) + sizeof(uint64_t) + 8;
+
+//finger, tool and gesture ids are stored in the same delta values as hands so keep them apart
+static const int64_t fingerKeyOffset	= (int64_t)1 << 40;
+static const int64_t toolKeyOffset		= (int64_t)2 << 40;
+static const int64_t gestureKeyOffset	= (int64_t)3 << 40;
+
+//--------------------------------------------------------------
+static void writeVarint(string & out, uint64_t v){
+	while( v >= 0x80 ){
+		out.push_back( (char)(v | 0x80) );
+		v >>= 7;
+	}
+	out.push_back( (char)v );
+}
+
+//--------------------------------------------------------------
+static void writeSigned(string & out, int64_t v){
+	writeVarint(out, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+//--------------------------------------------------------------
+static bool readVarint(const unsigned char *& p, const unsigned char * end, uint64_t & v){
+	v = 0;
+	for(int shift = 0; shift < 64 && p < end; shift += 7){
+		unsigned char b = *p++;
+		v |= (uint64_t)(b & 0x7f) << shift;
+		if( !(b & 0x80) ){
+			return true;
+		}
+	}
+	return false;
+}
+
+//--------------------------------------------------------------
+static bool readSigned(const unsigned char *& p, const unsigned char * end, int64_t & v){
+	uint64_t u;
+	if( !readVarint(p, end, u) ){
+		return false;
+	}
+	v = (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+	return true;
+}
+
+//--------------------------------------------------------------
+template <class T> static void writeRaw(std::ostream & out, T v){
+	out.write((const char *)&v, sizeof(T));
+}
+
+//--------------------------------------------------------------
+template <class T> static bool readRaw(std::istream & in, T & v){
+	return (bool)in.read((char *)&v, sizeof(T));
+}
+
+//--------------------------------------------------------------
+static inline int32_t quantize(float v, float scale){
+	return (int32_t)floorf(v * scale + 0.5);
+}
+
+//--------------------------------------------------------------
+static void handToValues(const ofxLeapMotionSimpleHand & hand, int32_t * q){
+	q[0] = quantize(hand.handPos.x, posScale);
+	q[1] = quantize(hand.handPos.y, posScale);
+	q[2] = quantize(hand.handPos.z, posScale);
+	q[3] = quantize(hand.handNormal.x, normalScale);
+	q[4] = quantize(hand.handNormal.y, normalScale);
+	q[5] = quantize(hand.handNormal.z, normalScale);
+	q[6] = quantize(hand.handVelocity.x, posScale);
+	q[7] = quantize(hand.handVelocity.y, posScale);
+	q[8] = quantize(hand.handVelocity.z, posScale);
+	q[9] = quantize(hand.sphereCenter.x, posScale);
+	q[10] = quantize(hand.sphereCenter.y, posScale);
+	q[11] = quantize(hand.sphereCenter.z, posScale);
+	q[12] = quantize(hand.sphereRadius, posScale);
+	q[13] = quantize(hand.handDirection.x, normalScale);
+	q[14] = quantize(hand.handDirection.y, normalScale);
+	q[15] = quantize(hand.handDirection.z, normalScale);
+	q[16] = quantize(hand.confidence, normalScale);
+	q[17] = quantize(hand.pinchStrength, normalScale);
+	q[18] = quantize(hand.grabStrength, normalScale);
+	q[19] = quantize(hand.palmWidth, posScale);
+	q[20] = quantize(hand.timeVisible, timeScale);
+	q[21] = hand.bLeft;
+}
+
+//--------------------------------------------------------------
+static void valuesToHand(const int32_t * q, int num, ofxLeapMotionSimpleHand & hand){
+	hand.handPos.set(q[0] / posScale, q[1] / posScale, q[2] / posScale);
+	hand.handNormal.set(q[3] / normalScale, q[4] / normalScale, q[5] / normalScale);
+	hand.handVelocity.set(q[6] / posScale, q[7] / posScale, q[8] / posScale);
+	hand.sphereCenter.set(q[9] / posScale, q[10] / posScale, q[11] / posScale);
+	hand.sphereRadius = q[12] / posScale;
+	if( num < numHandValues ){
+		return;
+	}
+	hand.handDirection.set(q[13] / normalScale, q[14] / normalScale, q[15] / normalScale);
+	hand.confidence = q[16] / normalScale;
+	hand.pinchStrength = q[17] / normalScale;
+	hand.grabStrength = q[18] / normalScale;
+	hand.palmWidth = q[19] / posScale;
+	hand.timeVisible = q[20] / timeScale;
+	hand.bLeft = q[21] != 0;
+}
+
+//--------------------------------------------------------------
+static void fingerToValues(const ofxLeapMotionSimpleHand::simpleFinger & finger, int32_t * q){
+	q[0] = quantize(finger.pos.x, posScale);
+	q[1] = quantize(finger.pos.y, posScale);
+	q[2] = quantize(finger.pos.z, posScale);
+	q[3] = quantize(finger.vel.x, posScale);
+	q[4] = quantize(finger.vel.y, posScale);
+	q[5] = quantize(finger.vel.z, posScale);
+	q[6] = quantize(finger.base.x, posScale);
+	q[7] = quantize(finger.base.y, posScale);
+	q[8] = quantize(finger.base.z, posScale);
+	q[9] = quantize(finger.touchDistance, normalScale);
+	q[10] = finger.touchZone;
+}
+
+//--------------------------------------------------------------
+static void valuesToFinger(const int32_t * q, int num, ofxLeapMotionSimpleHand::simpleFinger & finger){
+	finger.pos.set(q[0] / posScale, q[1] / posScale, q[2] / posScale);
+	finger.vel.set(q[3] / posScale, q[4] / posScale, q[5] / posScale);
+	finger.base.set(q[6] / posScale, q[7] / posScale, q[8] / posScale);
+	if( num < numFingerValues ){
+		return;
+	}
+	finger.touchDistance = q[9] / normalScale;
+	finger.touchZone = (ofxLeapMotionTouchZone)ofClamp(q[10], OFX_LEAP_TOUCH_NONE, OFX_LEAP_TOUCH_TOUCHING);
+}
+
+//--------------------------------------------------------------
+static void toolToValues(const ofxLeapMotionSimpleTool & tool, int32_t * q){
+	q[0] = quantize(tool.pos.x, posScale);
+	q[1] = quantize(tool.pos.y, posScale);
+	q[2] = quantize(tool.pos.z, posScale);
+	q[3] = quantize(tool.vel.x, posScale);
+	q[4] = quantize(tool.vel.y, posScale);
+	q[5] = quantize(tool.vel.z, posScale);
+	q[6] = quantize(tool.direction.x, normalScale);
+	q[7] = quantize(tool.direction.y, normalScale);
+	q[8] = quantize(tool.direction.z, normalScale);
+	q[9] = quantize(tool.length, posScale);
+	q[10] = quantize(tool.width, posScale);
+	q[11] = quantize(tool.timeVisible, timeScale);
+	q[12] = quantize(tool.touchDistance, normalScale);
+	q[13] = tool.touchZone;
+}
+
+//--------------------------------------------------------------
+static void valuesToTool(const int32_t * q, ofxLeapMotionSimpleTool & tool){
+	tool.pos.set(q[0] / posScale, q[1] / posScale, q[2] / posScale);
+	tool.vel.set(q[3] / posScale, q[4] / posScale, q[5] / posScale);
+	tool.direction.set(q[6] / normalScale, q[7] / normalScale, q[8] / normalScale);
+	tool.length = q[9] / posScale;
+	tool.width = q[10] / posScale;
+	tool.timeVisible = q[11] / timeScale;
+	tool.touchDistance = q[12] / normalScale;
+	tool.touchZone = (ofxLeapMotionTouchZone)ofClamp(q[13], OFX_LEAP_TOUCH_NONE, OFX_LEAP_TOUCH_TOUCHING);
+}
+
+//--------------------------------------------------------------
+static void gestureToValues(const ofxLeapMotionSimpleGesture & gesture, int32_t * q){
+	q[0] = quantize(gesture.position.x, posScale);
+	q[1] = quantize(gesture.position.y, posScale);
+	q[2] = quantize(gesture.position.z, posScale);
+	q[3] = quantize(gesture.startPosition.x, posScale);
+	q[4] = quantize(gesture.startPosition.y, posScale);
+	q[5] = quantize(gesture.startPosition.z, posScale);
+	q[6] = quantize(gesture.direction.x, normalScale);
+	q[7] = quantize(gesture.direction.y, normalScale);
+	q[8] = quantize(gesture.direction.z, normalScale);
+	q[9] = quantize(gesture.normal.x, normalScale);
+	q[10] = quantize(gesture.normal.y, normalScale);
+	q[11] = quantize(gesture.normal.z, normalScale);
+	q[12] = quantize(gesture.speed, posScale);
+	q[13] = quantize(gesture.progress, normalScale);
+	q[14] = quantize(gesture.radius, posScale);
+	q[15] = (int32_t)MIN(gesture.durationMicros, (int64_t)INT_MAX);
+}
+
+//--------------------------------------------------------------
+static void valuesToGesture(const int32_t * q, ofxLeapMotionSimpleGesture & gesture){
+	gesture.position.set(q[0] / posScale, q[1] / posScale, q[2] / posScale);
+	gesture.startPosition.set(q[3] / posScale, q[4] / posScale, q[5] / posScale);
+	gesture.direction.set(q[6] / normalScale, q[7] / normalScale, q[8] / normalScale);
+	gesture.normal.set(q[9] / normalScale, q[10] / normalScale, q[11] / normalScale);
+	gesture.speed = q[12] / posScale;
+	gesture.progress = q[13] / normalScale;
+	gesture.radius = q[14] / posScale;
+	gesture.durationMicros = q[15];
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionRecordingValues::clear(){
+	keys.clear();
+	values.clear();
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionRecordingValues::add(int64_t key, const int32_t * q, int num){
+	keys.push_back(key);
+	values.insert(values.end(), q, q + num);
+	values.resize(keys.size() * maxValues, 0);
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionRecordingValues::swap(ofxLeapMotionRecordingValues & other){
+	keys.swap(other.keys);
+	values.swap(other.values);
+}
+
+//--------------------------------------------------------------
+const int32_t * ofxLeapMotionRecordingValues::find(int64_t key) const{
+	for(size_t i = 0; i < keys.size(); i++){
+		if( keys[i] == key ){
+			return &values[i * maxValues];
+		}
+	}
+	return NULL;
+}
+
+//--------------------------------------------------------------
+static void writeValues(string & out, const ofxLeapMotionRecordingValues & prev, ofxLeapMotionRecordingValues & cur, int64_t key, const int32_t * q, int num){
+	const int32_t * p = prev.find(key);
+	
+	for(int i = 0; i < num; i++){
+		writeSigned(out, (int64_t)q[i] - (p ? p[i] : 0));
+	}
+	cur.add(key, q, num);
+}
+
+//--------------------------------------------------------------
+static bool readValues(const unsigned char *& ptr, const unsigned char * end, const ofxLeapMotionRecordingValues & prev, ofxLeapMotionRecordingValues & cur, int64_t key, int32_t * q, int num){
+	const int32_t * p = prev.find(key);
+	
+	for(int i = 0; i < num; i++){
+		int64_t d;
+		if( !readSigned(ptr, end, d) ){
+			return false;
+		}
+		q[i] = (int32_t)(d + (p ? p[i] : 0));
+	}
+	cur.add(key, q, num);
+	return true;
+}
+
+// ofxLeapMotionRecorder
+//--------------------------------------------------------------
+ofxLeapMotionRecorder::ofxLeapMotionRecorder()
+		:framesPerBlock(256)
+		,numFrames(0)
+		,blockFrames(0)
+		,prevFrameId(0)
+		,prevTimestamp(0) {
+}
+
+//--------------------------------------------------------------
+ofxLeapMotionRecorder::~ofxLeapMotionRecorder(){
+	close();
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionRecorder::open(string path, int perBlock){
+	close();
+	
+	file.open(ofToDataPath(path).c_str(), std::ios::binary | std::ios::trunc);
+	if( !file.is_open() ){
+		ofLogError("ofxLeapMotionRecorder") << "couldn't open " << path;
+		return false;
+	}
+	
+	framesPerBlock = MAX(1, perBlock);
+	numFrames = 0;
+	blockFrames = 0;
+	blockData.clear();
+	blocks.clear();
+	
+	file.write(fileMagic, 8);
+	writeRaw(file, fileVersion);
+	
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionRecorder::isOpen(){
+	return file.is_open();
+}
+
+//--------------------------------------------------------------
+int ofxLeapMotionRecorder::getNumFrames(){
+	return numFrames;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionRecorder::addFrame(const ofxLeapMotionSimpleFrame & frame){
+	if( !file.is_open() ){
+		return;
+	}
+	
+	//each block starts from scratch so it can be decoded on its own
+	if( blockFrames == 0 ){
+		ofxLeapMotionRecordingBlock block;
+		block.offset = 0;
+		block.firstTimestamp = frame.timestamp;
+		block.firstFrame = numFrames;
+		block.numFrames = 0;
+		block.numBytes = 0;
+		blocks.push_back(block);
+		
+		prevValues.clear();
+		prevFrameId = 0;
+		prevTimestamp = 0;
+	}
+	
+	int32_t q[maxValues];
+	curValues.clear();
+	
+	writeSigned(blockData, frame.id - prevFrameId);
+	writeSigned(blockData, frame.timestamp - prevTimestamp);
+	writeVarint(blockData, frame.hands.size());
+	
+	for(int i = 0; i < frame.hands.size(); i++){
+		const ofxLeapMotionSimpleHand & hand = frame.hands[i];
+		
+		writeSigned(blockData, hand.id);
+		handToValues(hand, q);
+		writeValues(blockData, prevValues, curValues, hand.id, q, numHandValues);
+		
+		writeVarint(blockData, hand.fingers.size());
+		for(int j = 0; j < hand.fingers.size(); j++){
+			writeSigned(blockData, hand.fingers[j].id);
+			fingerToValues(hand.fingers[j], q);
+			writeValues(blockData, prevValues, curValues, fingerKeyOffset + hand.fingers[j].id, q, numFingerValues);
+		}
+	}
+	
+	writeVarint(blockData, frame.tools.size());
+	for(int i = 0; i < frame.tools.size(); i++){
+		const ofxLeapMotionSimpleTool & tool = frame.tools[i];
+		
+		writeSigned(blockData, tool.id);
+		writeSigned(blockData, tool.handId);
+		toolToValues(tool, q);
+		writeValues(blockData, prevValues, curValues, toolKeyOffset + tool.id, q, numToolValues);
+	}
+	
+	writeVarint(blockData, frame.gestures.size());
+	for(int i = 0; i < frame.gestures.size(); i++){
+		const ofxLeapMotionSimpleGesture & gesture = frame.gestures[i];
+		
+		writeSigned(blockData, gesture.id);
+		writeSigned(blockData, gesture.type);
+		writeSigned(blockData, gesture.state);
+		gestureToValues(gesture, q);
+		writeValues(blockData, prevValues, curValues, gestureKeyOffset + gesture.id, q, numGestureValues);
+	}
+	
+	prevValues.swap(curValues);
+	prevFrameId = frame.id;
+	prevTimestamp = frame.timestamp;
+	
+	blocks.back().numFrames++;
+	blockFrames++;
+	numFrames++;
+	
+	if( blockFrames >= framesPerBlock ){
+		flushBlock();
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionRecorder::flushBlock(){
+	if( blockFrames == 0 ){
+		return;
+	}
+	
+	blocks.back().offset = (uint64_t)file.tellp();
+	blocks.back().numBytes = blockData.size();
+	writeRaw(file, (uint32_t)blockData.size());
+	writeRaw(file, (uint32_t)blockFrames);
+	file.write(blockData.data(), blockData.size());
+	
+	blockData.clear();
+	blockFrames = 0;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionRecorder::close(){
+	if( !file.is_open() ){
+		return;
+	}
+	
+	flushBlock();
+	
+	uint64_t indexOffset = (uint64_t)file.tellp();
+	for(int i = 0; i < blocks.size(); i++){
+		writeRaw(file, blocks[i].offset);
+		writeRaw(file, blocks[i].firstTimestamp);
+		writeRaw(file, blocks[i].firstFrame);
+	}
+	writeRaw(file, (uint32_t)blocks.size());
+	writeRaw(file, indexOffset);
+	file.write(indexMagic, 8);
+	
+	file.close();
+}
+
+// ofxLeapMotionPlayer
+//--------------------------------------------------------------
+ofxLeapMotionPlayer::ofxLeapMotionPlayer()
+		:version(0)
+		,numFrames(0)
+		,cachedBlock(-1) {
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionPlayer::load(string filePath){
+	blocks.clear();
+	numFrames = 0;
+	cachedBlock = -1;
+	cachedFrames.clear();
+	path = ofToDataPath(filePath);
+	
+	std::ifstream file(path.c_str(), std::ios::binary);
+	char magic[8];
+	uint32_t curVersion;
+	if( !file.read(magic, 8) || memcmp(magic, fileMagic, 8) != 0 || !readRaw(file, curVersion) || curVersion < 1 || curVersion > fileVersion ){
+		ofLogError("ofxLeapMotionPlayer") << path << " is not a recording";
+		return false;
+	}
+	uint64_t headerBytes = (uint64_t)file.tellg();
+	
+	file.seekg(0, std::ios::end);
+	uint64_t fileBytes = (uint64_t)file.tellg();
+	if( fileBytes < headerBytes + footerBytes ){
+		ofLogError("ofxLeapMotionPlayer") << path << " has no index - the recording wasn't closed";
+		return false;
+	}
+	
+	//the index is found from the footer at the end of the file
+	uint32_t numBlocks;
+	uint64_t indexOffset;
+	file.seekg(fileBytes - footerBytes);
+	if( !readRaw(file, numBlocks) || !readRaw(file, indexOffset) || !file.read(magic, 8) || memcmp(magic, indexMagic, 8) != 0 ){
+		ofLogError("ofxLeapMotionPlayer") << path << " has no index - the recording wasn't closed";
+		return false;
+	}
+	
+	//the index sits between the blocks and the footer and has to fill that space exactly
+	if( indexOffset < headerBytes || indexOffset > fileBytes - footerBytes || (fileBytes - footerBytes - indexOffset) != (uint64_t)numBlocks * indexEntryBytes ){
+		ofLogError("ofxLeapMotionPlayer") << path << " has a broken index";
+		return false;
+	}
+	
+	vector <ofxLeapMotionRecordingBlock> index(numBlocks);
+	file.seekg(indexOffset);
+	for(int i = 0; i < numBlocks; i++){
+		if( !readRaw(file, index[i].offset) || !readRaw(file, index[i].firstTimestamp) || !readRaw(file, index[i].firstFrame) ){
+			ofLogError("ofxLeapMotionPlayer") << path << " has a broken index";
+			return false;
+		}
+	}
+	
+	//frame counts come from the block headers - every block has to fit before the index and follow on from the one before
+	ofxLeapMotionRecordingFormat format(curVersion);
+	uint64_t total = 0;
+	for(int i = 0; i < numBlocks; i++){
+		ofxLeapMotionRecordingBlock & block = index[i];
+		uint64_t minOffset = i > 0 ? index[i-1].offset + blockHeaderBytes + index[i-1].numBytes : headerBytes;
+		file.seekg(block.offset);
+		if( block.offset < minOffset || block.offset + blockHeaderBytes > indexOffset || !readRaw(file, block.numBytes) || !readRaw(file, block.numFrames) 
+			|| block.numBytes > indexOffset - block.offset - blockHeaderBytes || (uint64_t)block.numFrames * format.minFrameBytes > block.numBytes || block.firstFrame != total ){
+			ofLogError("ofxLeapMotionPlayer") << path << " has a broken block " << i;
+			return false;
+		}
+		total += block.numFrames;
+	}
+	if( total > INT_MAX ){
+		ofLogError("ofxLeapMotionPlayer") << path << " has too many frames";
+		return false;
+	}
+	
+	blocks.swap(index);
+	numFrames = total;
+	version = curVersion;
+	return true;
+}
+
+//--------------------------------------------------------------
+int ofxLeapMotionPlayer::getNumFrames() const{
+	return numFrames;
+}
+
+//--------------------------------------------------------------
+int ofxLeapMotionPlayer::getNumBlocks() const{
+	return blocks.size();
+}
+
+//--------------------------------------------------------------
+uint32_t ofxLeapMotionPlayer::getVersion() const{
+	return version;
+}
+
+//--------------------------------------------------------------
+const ofxLeapMotionRecordingBlock & ofxLeapMotionPlayer::getBlock(int block) const{
+	return blocks[block];
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionPlayer::readBlock(int block, vector <ofxLeapMotionSimpleFrame> & frames) const{
+	frames.clear();
+	if( block < 0 || block >= blocks.size() ){
+		return false;
+	}
+	
+	std::ifstream file(path.c_str(), std::ios::binary);
+	file.seekg(blocks[block].offset);
+	
+	//the sizes were checked by load() - the file must not have changed since
+	uint32_t numBytes, blockFrames;
+	if( !readRaw(file, numBytes) || !readRaw(file, blockFrames) || numBytes != blocks[block].numBytes || blockFrames != blocks[block].numFrames ){
+		return false;
+	}
+	
+	vector <unsigned char> data(numBytes);
+	if( numBytes && !file.read((char *)&data[0], numBytes) ){
+		return false;
+	}
+	
+	const unsigned char * p = numBytes ? &data[0] : NULL;
+	const unsigned char * end = p + numBytes;
+	
+	ofxLeapMotionRecordingFormat format(version);
+	ofxLeapMotionRecordingValues prevValues, curValues;
+	int64_t frameId = 0, timestamp = 0;
+	int32_t q[maxValues];
+	
+	frames.resize(blockFrames);
+	for(int f = 0; f < blockFrames; f++){
+		ofxLeapMotionSimpleFrame & frame = frames[f];
+		int64_t d;
+		uint64_t numHands;
+		
+		if( !readSigned(p, end, d) ){ return false; }
+		frameId += d;
+		if( !readSigned(p, end, d) ){ return false; }
+		timestamp += d;
+		if( !readVarint(p, end, numHands) || numHands > (uint64_t)(end - p) / format.minHandBytes ){ return false; }
+		
+		frame.id = frameId;
+		frame.timestamp = timestamp;
+		frame.hands.resize(numHands);
+		frame.tools.clear();
+		frame.gestures.clear();
+		curValues.clear();
+		
+		for(int i = 0; i < numHands; i++){
+			ofxLeapMotionSimpleHand & hand = frame.hands[i];
+			uint64_t numFingers;
+			
+			if( !readSigned(p, end, hand.id) ){ return false; }
+			if( !readValues(p, end, prevValues, curValues, hand.id, q, format.numHandValues) ){ return false; }
+			valuesToHand(q, format.numHandValues, hand);
+			
+			if( !readVarint(p, end, numFingers) || numFingers > (uint64_t)(end - p) / format.minFingerBytes ){ return false; }
+			hand.fingers.resize(numFingers);
+			for(int j = 0; j < numFingers; j++){
+				if( !readSigned(p, end, hand.fingers[j].id) ){ return false; }
+				if( !readValues(p, end, prevValues, curValues, fingerKeyOffset + hand.fingers[j].id, q, format.numFingerValues) ){ return false; }
+				valuesToFinger(q, format.numFingerValues, hand.fingers[j]);
+			}
+		}
+		
+		if( format.bExtras ){
+			uint64_t numTools, numGestures;
+			
+			if( !readVarint(p, end, numTools) || numTools > (uint64_t)(end - p) / minToolBytes ){ return false; }
+			frame.tools.resize(numTools);
+			for(int i = 0; i < numTools; i++){
+				ofxLeapMotionSimpleTool & tool = frame.tools[i];
+				if( !readSigned(p, end, tool.id) || !readSigned(p, end, tool.handId) ){ return false; }
+				if( !readValues(p, end, prevValues, curValues, toolKeyOffset + tool.id, q, numToolValues) ){ return false; }
+				valuesToTool(q, tool);
+			}
+			
+			if( !readVarint(p, end, numGestures) || numGestures > (uint64_t)(end - p) / minGestureBytes ){ return false; }
+			frame.gestures.resize(numGestures);
+			for(int i = 0; i < numGestures; i++){
+				ofxLeapMotionSimpleGesture & gesture = frame.gestures[i];
+				int64_t type, state;
+				if( !readSigned(p, end, gesture.id) || !readSigned(p, end, type) || !readSigned(p, end, state) ){ return false; }
+				if( !readValues(p, end, prevValues, curValues, gestureKeyOffset + gesture.id, q, numGestureValues) ){ return false; }
+				gesture.type = (ofxLeapMotionGestureType)type;
+				gesture.state = (ofxLeapMotionGestureState)state;
+				valuesToGesture(q, gesture);
+			}
+		}
+		
+		prevValues.swap(curValues);
+	}
+	
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionPlayer::getFrame(int index, ofxLeapMotionSimpleFrame & frame){
+	if( index < 0 || index >= numFrames ){
+		return false;
+	}
+	
+	//blocks are in frame order - find the last one starting at or before index
+	int lo = 0, hi = blocks.size() - 1;
+	while( lo < hi ){
+		int mid = (lo + hi + 1) / 2;
+		if( blocks[mid].firstFrame <= index ){
+			lo = mid;
+		}else{
+			hi = mid - 1;
+		}
+	}
+	int block = lo;
+	
+	if( block != cachedBlock ){
+		if( !readBlock(block, cachedFrames) ){
+			cachedBlock = -1;
+			return false;
+		}
+		cachedBlock = block;
+	}
+	
+	frame = cachedFrames[index - blocks[block].firstFrame];
+	return true;
+}
+
+//--------------------------------------------------------------
+int ofxLeapMotionPlayer::getFrameIndexAt(int64_t timestamp){
+	if( blocks.empty() || timestamp < blocks[0].firstTimestamp ){
+		return -1;
+	}
+	
+	//binary search the index for the block then scan the decoded block
+	int lo = 0, hi = blocks.size() - 1;
+	while( lo < hi ){
+		int mid = (lo + hi + 1) / 2;
+		if( blocks[mid].firstTimestamp <= timestamp ){
+			lo = mid;
+		}else{
+			hi = mid - 1;
+		}
+	}
+	
+	if( lo != cachedBlock ){
+		if( !readBlock(lo, cachedFrames) ){
+			cachedBlock = -1;
+			return -1;
+		}
+		cachedBlock = lo;
+	}
+	
+	int index = 0;
+	while( index + 1 < cachedFrames.size() && cachedFrames[index + 1].timestamp <= timestamp ){
+		index++;
+	}
+	
+	return blocks[lo].firstFrame + index;
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionPlayer::getFrameAt(int64_t timestamp, ofxLeapMotionSimpleFrame & frame){
+	return getFrame(getFrameIndexAt(timestamp), frame);
+}
@@ -0,0 +1,120 @@
+//ofxLeapMotionRecorder / ofxLeapMotionPlayer - compact recording of ofxLeapMotionSimpleFrame data
+//
+//format: positions are quantized to 0.1mm (normals to 1/10000) and each value is stored as a
+//zigzag varint delta against the same hand / finger / tool / gesture id in the previous frame.
+//frames are grouped into blocks which each start from scratch, and an index of the blocks
+//at the end of the file allows seeking and decoding blocks independently.
+//
+//  header:  "OFXLEAP1" uint32 version
+//  blocks:  uint32 numBytes, uint32 numFrames, frame data
+//  frame:   id, timestamp, hands with their fingers, tools, gestures - version 1 files stop after the fingers
+//  index:   per block - uint64 offset, int64 first timestamp, uint32 first frame
+//  footer:  uint32 numBlocks, uint64 index offset, "OFXLIDX1"
+//
+//record the frames from ofxLeapMotion::getSimpleFrame() so the positions are in Leap mm 
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxLeapMotionTypes.h"
+
+#include <fstream>
+
+class ofxLeapMotionRecordingBlock{
+
+	public:
+		
+		uint64_t offset;
+		int64_t firstTimestamp;
+		uint32_t firstFrame;
+		uint32_t numFrames;
+		uint32_t numBytes;
+};
+
+//the quantized values of each hand and finger in a frame - the next frame is delta coded against them
+//there are only a handful of ids per frame so they are kept in flat arrays that are reused frame to frame
+class ofxLeapMotionRecordingValues{
+
+	public:
+		
+		void clear();
+		void add(int64_t key, const int32_t * q, int num);
+		void swap(ofxLeapMotionRecordingValues & other);
+		
+		//NULL if the key wasn't in the frame
+		const int32_t * find(int64_t key) const;
+		
+	protected:
+		
+		vector <int64_t> keys;
+		vector <int32_t> values;
+};
+
+class ofxLeapMotionRecorder{
+
+	public:
+	
+		ofxLeapMotionRecorder();
+		~ofxLeapMotionRecorder();
+		
+		bool open(string path, int framesPerBlock = 256);
+		void addFrame(const ofxLeapMotionSimpleFrame & frame);
+		void close();
+		
+		bool isOpen();
+		int getNumFrames();
+		
+	protected:
+	
+		void flushBlock();
+	
+		std::ofstream file;
+		int framesPerBlock;
+		int numFrames;
+		
+		string blockData;
+		int blockFrames;
+		ofxLeapMotionRecordingValues prevValues;
+		ofxLeapMotionRecordingValues curValues;
+		int64_t prevFrameId;
+		int64_t prevTimestamp;
+		
+		vector <ofxLeapMotionRecordingBlock> blocks;
+};
+
+class ofxLeapMotionPlayer{
+
+	public:
+	
+		ofxLeapMotionPlayer();
+		
+		//fails without keeping anything if the file is truncated or any of its sizes or counts don't add up
+		bool load(string path);
+		
+		int getNumFrames() const;
+		int getNumBlocks() const;
+		const ofxLeapMotionRecordingBlock & getBlock(int block) const;
+		
+		//version 1 files have no tools, gestures or hand extras (direction, confidence, pinch, grab etc)
+		uint32_t getVersion() const;
+		
+		//decodes a whole block - safe to call from several threads at once
+		bool readBlock(int block, vector <ofxLeapMotionSimpleFrame> & frames) const;
+		
+		//random access - decoded blocks are cached one at a time
+		bool getFrame(int index, ofxLeapMotionSimpleFrame & frame);
+		
+		//the last frame with a timestamp at or before the given timestamp
+		bool getFrameAt(int64_t timestamp, ofxLeapMotionSimpleFrame & frame);
+		int getFrameIndexAt(int64_t timestamp);
+		
+	protected:
+	
+		string path;
+		uint32_t version;
+		vector <ofxLeapMotionRecordingBlock> blocks;
+		int numFrames;
+		
+		int cachedBlock;
+		vector <ofxLeapMotionSimpleFrame> cachedFrames;
+};
@@ -0,0 +1,458 @@
+/*
+ *  ofxLeapMotionShared.cpp
+ *  ofxLeapMotion
+ *
+ */
+
+#include "ofxLeapMotionShared.h"
+
+#ifndef TARGET_WIN32
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <signal.h>
+	#include <errno.h>
+#endif
+
+#include <chrono>
+
+//the memory layout is plain data so any process built with the same layout version can read it
+static const uint32_t sharedMagic		= 0x4c454150;   // LEAP
+static const uint32_t sharedVersion		= 2;
+static const int sharedNumSlots			= 16;
+static const int sharedMaxHands			= 4;
+static const int sharedMaxFingers		= 5;
+
+//how often a subscriber looks for a publisher that died without closing, or for one to appear
+static const uint64_t checkIntervalMillis	= 500;
+
+class ofxLeapMotionSharedFinger{
+	public:
+		int64_t id;
+		float pos[3];
+		float vel[3];
+		float base[3];
+};
+
+class ofxLeapMotionSharedHand{
+	public:
+		int64_t id;
+		float pos[3];
+		float normal[3];
+		float vel[3];
+		float sphereCenter[3];
+		float sphereRadius;
+		int32_t numFingers;
+		ofxLeapMotionSharedFinger fingers[sharedMaxFingers];
+};
+
+class ofxLeapMotionSharedSlot{
+	public:
+		std::atomic <uint32_t> seq;     // odd while the slot is being written
+		int64_t frameId;
+		int64_t timestamp;
+		int32_t numHands;
+		ofxLeapMotionSharedHand hands[sharedMaxHands];
+};
+
+class ofxLeapMotionSharedLayout{
+	public:
+		uint32_t magic;
+		uint32_t version;
+		int32_t pid;                        // the publisher process
+		std::atomic <uint64_t> generation;  // different for every publisher setup(), 0 until it is ready and after close()
+		std::atomic <uint64_t> writeCount;  // number of frames published - the latest is in slot (writeCount-1) % numSlots
+		ofxLeapMotionSharedSlot slots[sharedNumSlots];
+};
+
+class ofxLeapMotionSharedMemory{
+	public:
+		ofxLeapMotionSharedLayout * layout;
+		int fd;
+};
+
+//--------------------------------------------------------------
+static inline void copyVec(float * dst, const ofPoint & p){
+	dst[0] = p.x;
+	dst[1] = p.y;
+	dst[2] = p.z;
+}
+
+//--------------------------------------------------------------
+static ofxLeapMotionSharedMemory * openShared(string name, bool bCreate){
+#ifdef TARGET_WIN32
+	ofLogError("ofxLeapMotionShared") << "shared memory is not supported on Windows";
+	return NULL;
+#else
+	int fd = shm_open(name.c_str(), bCreate ? (O_CREAT | O_EXCL | O_RDWR) : O_RDWR, 0666);
+	if( fd < 0 ){
+		if( bCreate ){
+			ofLogError("ofxLeapMotionShared") << "couldn't create shared memory " << name;
+		}
+		return NULL;
+	}
+	
+	if( bCreate && ftruncate(fd, sizeof(ofxLeapMotionSharedLayout)) != 0 ){
+		ofLogError("ofxLeapMotionShared") << "couldn't size shared memory " << name;
+		::close(fd);
+		return NULL;
+	}
+	
+	//a subscriber can find the name between shm_open() and ftruncate() in the publisher
+	struct stat st;
+	if( !bCreate && (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(ofxLeapMotionSharedLayout)) ){
+		::close(fd);
+		return NULL;
+	}
+	
+	void * ptr = mmap(NULL, sizeof(ofxLeapMotionSharedLayout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if( ptr == MAP_FAILED ){
+		ofLogError("ofxLeapMotionShared") << "couldn't map shared memory " << name;
+		::close(fd);
+		return NULL;
+	}
+	
+	ofxLeapMotionSharedMemory * mem = new ofxLeapMotionSharedMemory();
+	mem->layout = (ofxLeapMotionSharedLayout *)ptr;
+	mem->fd = fd;
+	return mem;
+#endif
+}
+
+//--------------------------------------------------------------
+static bool isPublisherRunning(const ofxLeapMotionSharedLayout * layout){
+#ifdef TARGET_WIN32
+	return true;
+#else
+	return kill(layout->pid, 0) == 0 || errno == EPERM;
+#endif
+}
+
+//--------------------------------------------------------------
+static void closeShared(ofxLeapMotionSharedMemory *& mem){
+	if( !mem ){
+		return;
+	}
+#ifndef TARGET_WIN32
+	munmap(mem->layout, sizeof(ofxLeapMotionSharedLayout));
+	::close(mem->fd);
+#endif
+	delete mem;
+	mem = NULL;
+}
+
+// ofxLeapMotionSharedPublisher
+//--------------------------------------------------------------
+ofxLeapMotionSharedPublisher::ofxLeapMotionSharedPublisher()
+		:mem(NULL) {
+}
+
+//--------------------------------------------------------------
+ofxLeapMotionSharedPublisher::~ofxLeapMotionSharedPublisher(){
+	close();
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionSharedPublisher::setup(string sharedName){
+	close();
+	name = sharedName;
+	
+	//never reuse an object left by a publisher that crashed - a slot could be stuck odd (locked) or the layout could be older.
+	//subscribers still mapping it see that publisher is gone and move to the new object
+#ifndef TARGET_WIN32
+	shm_unlink(name.c_str());
+#endif
+	mem = openShared(name, true);
+	if( !mem ){
+		return false;
+	}
+	
+	//a new object is zero filled - the slots are all even (unlocked) and there are no frames yet
+	//the generation goes last, it tells subscribers the rest is ready
+	ofxLeapMotionSharedLayout * layout = mem->layout;
+	layout->magic = sharedMagic;
+	layout->version = sharedVersion;
+#ifndef TARGET_WIN32
+	layout->pid = getpid();
+#endif
+	uint64_t micros = std::chrono::duration_cast <std::chrono::microseconds> (std::chrono::system_clock::now().time_since_epoch()).count();
+	layout->generation.store(MAX(micros, (uint64_t)1), std::memory_order_release);
+	
+	return true;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionSharedPublisher::close(){
+#ifndef TARGET_WIN32
+	if( mem ){
+		mem->layout->generation.store(0, std::memory_order_release);
+		shm_unlink(name.c_str());
+	}
+#endif
+	closeShared(mem);
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionSharedPublisher::publish(const ofxLeapMotionSimpleFrame & frame){
+	if( !mem ){
+		return;
+	}
+	
+	ofxLeapMotionSharedLayout * layout = mem->layout;
+	uint64_t count = layout->writeCount.load(std::memory_order_relaxed);
+	ofxLeapMotionSharedSlot & slot = layout->slots[count % sharedNumSlots];
+	
+	//odd sequence = being written, readers that see it or see it change retry
+	uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+	slot.seq.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	
+	slot.frameId = frame.id;
+	slot.timestamp = frame.timestamp;
+	slot.numHands = MIN((int)frame.hands.size(), sharedMaxHands);
+	
+	for(int i = 0; i < slot.numHands; i++){
+		const ofxLeapMotionSimpleHand & src = frame.hands[i];
+		ofxLeapMotionSharedHand & dst = slot.hands[i];
+		
+		dst.id = src.id;
+		copyVec(dst.pos, src.handPos);
+		copyVec(dst.normal, src.handNormal);
+		copyVec(dst.vel, src.handVelocity);
+		copyVec(dst.sphereCenter, src.sphereCenter);
+		dst.sphereRadius = src.sphereRadius;
+		dst.numFingers = MIN((int)src.fingers.size(), sharedMaxFingers);
+		
+		for(int j = 0; j < dst.numFingers; j++){
+			dst.fingers[j].id = src.fingers[j].id;
+			copyVec(dst.fingers[j].pos, src.fingers[j].pos);
+			copyVec(dst.fingers[j].vel, src.fingers[j].vel);
+			copyVec(dst.fingers[j].base, src.fingers[j].base);
+		}
+	}
+	
+	slot.seq.store(seq + 2, std::memory_order_release);
+	layout->writeCount.store(count + 1, std::memory_order_release);
+}
+
+// ofxLeapMotionSharedSubscriber
+//--------------------------------------------------------------
+ofxLeapMotionSharedSubscriber::ofxLeapMotionSharedSubscriber()
+		:mem(NULL)
+		,generation(0)
+		,nextCheckMillis(0)
+		,preFrameId(-1) {
+}
+
+//--------------------------------------------------------------
+ofxLeapMotionSharedSubscriber::~ofxLeapMotionSharedSubscriber(){
+	close();
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionSharedSubscriber::setup(string sharedName){
+	close();
+	name = sharedName;
+	reopen();
+	return mem != NULL;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionSharedSubscriber::reopen(){
+	closeShared(mem);
+	nextCheckMillis = ofGetElapsedTimeMillis() + checkIntervalMillis;
+	
+	mem = openShared(name, false);
+	if( !mem ){
+		return;
+	}
+	
+	ofxLeapMotionSharedLayout * layout = mem->layout;
+	generation = layout->generation.load(std::memory_order_acquire);
+	if( generation == 0 ){
+		//still being set up or already closed
+		closeShared(mem);
+		return;
+	}
+	if( layout->magic != sharedMagic || layout->version != sharedVersion ){
+		ofLogError("ofxLeapMotionSharedSubscriber") << name << " isn't an ofxLeapMotion publisher or has a different version";
+		closeShared(mem);
+		return;
+	}
+	if( !isPublisherRunning(layout) ){
+		closeShared(mem);
+		return;
+	}
+	
+	//the frame count starts again with every publisher
+	preFrameId = -1;
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionSharedSubscriber::checkPublisher(){
+	uint64_t now = ofGetElapsedTimeMillis();
+	if( mem ){
+		if( mem->layout->generation.load(std::memory_order_acquire) == generation ){
+			//a publisher that crashed can't say so - make sure it is still running every so often
+			if( now < nextCheckMillis ){
+				return true;
+			}
+			nextCheckMillis = now + checkIntervalMillis;
+			if( isPublisherRunning(mem->layout) ){
+				return true;
+			}
+		}
+	}else if( name.empty() || now < nextCheckMillis ){
+		return false;
+	}
+	
+	reopen();
+	return mem != NULL;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionSharedSubscriber::close(){
+	closeShared(mem);
+	name.clear();
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionSharedSubscriber::isConnected(){
+	return checkPublisher();
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionSharedSubscriber::getSimpleFrame(ofxLeapMotionSimpleFrame & frame){
+	if( !checkPublisher() ){
+		return false;
+	}
+	
+	ofxLeapMotionSharedLayout * layout = mem->layout;
+	
+	for(int attempt = 0; attempt < 100; attempt++){
+		uint64_t count = layout->writeCount.load(std::memory_order_acquire);
+		if( count == 0 ){
+			return false;
+		}
+		
+		const ofxLeapMotionSharedSlot & slot = layout->slots[(count - 1) % sharedNumSlots];
+		uint32_t seq = slot.seq.load(std::memory_order_acquire);
+		if( seq & 1 ){
+			continue;
+		}
+		
+		frame.id = slot.frameId;
+		frame.timestamp = slot.timestamp;
+		frame.hands.resize(ofClamp(slot.numHands, 0, sharedMaxHands));
+		
+		for(int i = 0; i < frame.hands.size(); i++){
+			const ofxLeapMotionSharedHand & src = slot.hands[i];
+			ofxLeapMotionSimpleHand & dst = frame.hands[i];
+			
+			dst.id = src.id;
+			dst.handPos.set(src.pos[0], src.pos[1], src.pos[2]);
+			dst.handNormal.set(src.normal[0], src.normal[1], src.normal[2]);
+			dst.handVelocity.set(src.vel[0], src.vel[1], src.vel[2]);
+			dst.sphereCenter.set(src.sphereCenter[0], src.sphereCenter[1], src.sphereCenter[2]);
+			dst.sphereRadius = src.sphereRadius;
+			dst.fingers.resize(ofClamp(src.numFingers, 0, sharedMaxFingers));
+			
+			for(int j = 0; j < dst.fingers.size(); j++){
+				const ofxLeapMotionSharedFinger & f = src.fingers[j];
+				dst.fingers[j].id = f.id;
+				dst.fingers[j].pos.set(f.pos[0], f.pos[1], f.pos[2]);
+				dst.fingers[j].vel.set(f.vel[0], f.vel[1], f.vel[2]);
+				dst.fingers[j].base.set(f.base[0], f.base[1], f.base[2]);
+			}
+		}
+		
+		//if the publisher touched the slot while we were reading it the copy is torn - try again
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if( slot.seq.load(std::memory_order_relaxed) == seq ){
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+//--------------------------------------------------------------
+ofxLeapMotionSimpleFrame ofxLeapMotionSharedSubscriber::getSimpleFrame(){
+	ofxLeapMotionSimpleFrame frame;
+	getSimpleFrame(frame);
+	return frame;
+}
+
+//--------------------------------------------------------------
+vector <ofxLeapMotionSimpleHand> ofxLeapMotionSharedSubscriber::getSimpleHands(){
+	ofxLeapMotionSimpleFrame frame;
+	getSimpleFrame(frame);
+	
+	vector <ofxLeapMotionSimpleHand> simpleHands;
+	for(int i = 0; i < frame.hands.size(); i++){
+		simpleHands.push_back( mapping.map(frame.hands[i]) );
+	}
+	return simpleHands;
+}
+
+//--------------------------------------------------------------
+int64_t ofxLeapMotionSharedSubscriber::getCurrentFrameID(){
+	if( !checkPublisher() ){
+		return -1;
+	}
+	
+	//just the id from the latest slot - under the same sequence lock as getSimpleFrame()
+	ofxLeapMotionSharedLayout * layout = mem->layout;
+	for(int attempt = 0; attempt < 100; attempt++){
+		uint64_t count = layout->writeCount.load(std::memory_order_acquire);
+		if( count == 0 ){
+			return -1;
+		}
+		
+		const ofxLeapMotionSharedSlot & slot = layout->slots[(count - 1) % sharedNumSlots];
+		uint32_t seq = slot.seq.load(std::memory_order_acquire);
+		if( seq & 1 ){
+			continue;
+		}
+		
+		int64_t frameId = slot.frameId;
+		
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if( slot.seq.load(std::memory_order_relaxed) == seq ){
+			return frameId;
+		}
+	}
+	
+	return -1;
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionSharedSubscriber::isFrameNew(){
+	return getCurrentFrameID() != preFrameId;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionSharedSubscriber::markFrameAsOld(){
+	preFrameId = getCurrentFrameID();
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionSharedSubscriber::resetMapping(){
+	mapping.reset();
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionSharedSubscriber::setMappingX(float minX, float maxX, float outputMinX, float outputMaxX){
+	mapping.setX(minX, maxX, outputMinX, outputMaxX);
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionSharedSubscriber::setMappingY(float minY, float maxY, float outputMinY, float outputMaxY){
+	mapping.setY(minY, maxY, outputMinY, outputMaxY);
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionSharedSubscriber::setMappingZ(float minZ, float maxZ, float outputMinZ, float outputMaxZ){
+	mapping.setZ(minZ, maxZ, outputMinZ, outputMaxZ);
+}
@@ -0,0 +1,82 @@
+//ofxLeapMotionSharedPublisher / ofxLeapMotionSharedSubscriber - share simple hand frames between processes on one machine
+//the publisher writes each frame into a ring of slots in POSIX shared memory, each slot guarded by a sequence lock
+//so the publisher never waits for readers and readers never block each other. 
+//the subscriber has the same getSimpleHands() / isFrameNew() interface as ofxLeapMotion so it can stand in for it
+//in processes that don't need to open the Leap themselves.
+//a publisher always starts from a new shared memory object, and subscribers follow it when it closes, restarts or dies.
+//note: not available on Windows
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxLeapMotionTypes.h"
+
+#include <atomic>
+
+class ofxLeapMotionSharedMemory;
+
+class ofxLeapMotionSharedPublisher{
+
+	public:
+	
+		ofxLeapMotionSharedPublisher();
+		~ofxLeapMotionSharedPublisher();
+		
+		//name is the shared memory object name - it needs to start with a /
+		//whatever was left under the name by an earlier publisher is replaced
+		bool setup(string name = "/ofxLeapMotion");
+		void close();
+		
+		//publish a frame from ofxLeapMotion::getSimpleFrame() - hands past the slot capacity are dropped
+		void publish(const ofxLeapMotionSimpleFrame & frame);
+		
+	protected:
+	
+		string name;
+		ofxLeapMotionSharedMemory * mem;
+};
+
+class ofxLeapMotionSharedSubscriber : public ofxLeapMotionSource{
+
+	public:
+	
+		ofxLeapMotionSharedSubscriber();
+		~ofxLeapMotionSharedSubscriber();
+		
+		//returns false if no publisher is running yet - the subscriber keeps looking for one under the name
+		bool setup(string name = "/ofxLeapMotion");
+		void close();
+		
+		bool isConnected();
+		
+		bool isFrameNew();
+		void markFrameAsOld();
+		
+		//the Leap frame id of the latest frame published - -1 before the first one
+		int64_t getCurrentFrameID();
+		
+		//the latest frame in Leap mm - returns false if there is no frame yet
+		bool getSimpleFrame(ofxLeapMotionSimpleFrame & frame);
+		ofxLeapMotionSimpleFrame getSimpleFrame();
+		
+		//the latest hands with the mapping applied - same as ofxLeapMotion::getSimpleHands()
+		vector <ofxLeapMotionSimpleHand> getSimpleHands();
+		
+		void resetMapping();
+		void setMappingX(float minX, float maxX, float outputMinX, float outputMaxX);
+		void setMappingY(float minY, float maxY, float outputMinY, float outputMaxY);
+		void setMappingZ(float minZ, float maxZ, float outputMinZ, float outputMaxZ);
+		
+	protected:
+	
+		//maps whatever publisher is under the name now if the one mapped has gone - returns false if there is none
+		bool checkPublisher();
+		void reopen();
+	
+		string name;
+		ofxLeapMotionSharedMemory * mem;
+		uint64_t generation;
+		uint64_t nextCheckMillis;
+		ofxLeapMotionMapping mapping;
+		int64_t preFrameId;
+};
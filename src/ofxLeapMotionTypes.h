@@ -0,0 +1,376 @@
+//ofxLeapMotionTypes - the plain data types of ofxLeapMotion: simple hands and frames, mapping, camera images
+//doesn't include Leap.h - include this rather than ofxLeapMotion.h if you only pass hand data around
+
+#pragma once
+
+#include "ofConstants.h"
+#include "ofPoint.h"
+#include "ofPixels.h"
+#include "ofQuaternion.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+//same values as Leap::Pointable::Zone
+enum ofxLeapMotionTouchZone{
+	OFX_LEAP_TOUCH_NONE = 0,            // too far from the touch plane
+	OFX_LEAP_TOUCH_HOVERING,            // close to the touch plane
+	OFX_LEAP_TOUCH_TOUCHING             // through the touch plane
+};
+
+//same values as Leap::Gesture::Type
+enum ofxLeapMotionGestureType{
+	OFX_LEAP_GESTURE_INVALID = -1,
+	OFX_LEAP_GESTURE_SWIPE = 1,
+	OFX_LEAP_GESTURE_CIRCLE = 4,
+	OFX_LEAP_GESTURE_SCREEN_TAP = 5,
+	OFX_LEAP_GESTURE_KEY_TAP = 6
+};
+
+//same values as Leap::Gesture::State
+enum ofxLeapMotionGestureState{
+	OFX_LEAP_GESTURE_STATE_INVALID = -1,
+	OFX_LEAP_GESTURE_STATE_START = 1,
+	OFX_LEAP_GESTURE_STATE_UPDATE = 2,
+	OFX_LEAP_GESTURE_STATE_STOP = 3
+};
+
+class ofxLeapMotionSimpleHand{
+
+	public:
+	
+		ofxLeapMotionSimpleHand(){
+			id = -1;
+			sphereRadius = 0;
+			confidence = 1;
+			pinchStrength = 0;
+			grabStrength = 0;
+			palmWidth = 0;
+			timeVisible = 0;
+			bLeft = false;
+			resetMotion();
+		}
+    
+		struct simpleFinger{
+			simpleFinger(){
+				id = -1;
+				touchDistance = 1;
+				touchZone = OFX_LEAP_TOUCH_NONE;
+			}
+			
+			ofPoint pos;
+			ofPoint vel;
+			ofPoint base;                   // finger's base
+			int64_t id;
+			float touchDistance;            // Leap touch plane: 1 far away, 0 at the plane, -1 pushed through
+			ofxLeapMotionTouchZone touchZone;
+		};
+		
+		vector <simpleFinger>  fingers;
+		
+		int64_t id;
+		ofPoint handPos; 
+		ofPoint handNormal;
+											
+		ofPoint handVelocity;               // palm vel
+		ofPoint sphereCenter;               // palm and fingers sphere position
+		float sphereRadius;                 // and radius for hand openness
+		float confidence;                   // how well the tracking data fits the hand model - 0 to 1
+		
+		ofPoint handDirection;              // palm to fingers - not mapped, like the normal
+		float pinchStrength;                // 0 open to 1 thumb and a finger touching
+		float grabStrength;                 // 0 open to 1 fist
+		float palmWidth;                    // mm
+		float timeVisible;                  // seconds the hand has been tracked
+		bool bLeft;                         // left or right hand
+		
+		//motion since the same hand in the previous frame - in Leap mm, like Leap::Hand::translation() etc
+		//filled in once per frame by ofxLeapMotion, so pan / rotate / zoom controls don't need the SDK
+		ofPoint translation;                // palm movement
+		ofQuaternion rotation;              // turns the previous palm orientation into this one
+		float scale;                        // fingertip spread compared to the previous frame - above 1 is opening
+		float translationProbability;       // how much of the motion is each kind - the three add up to 1
+		float rotationProbability;          // or are all 0 when the hand didn't move
+		float scaleProbability;
+		
+		void updateMotion(const ofxLeapMotionSimpleHand & previous);
+		void resetMotion();
+
+		void debugDraw();
+};
+
+//a tool the Leap tracks - a pen, stick etc. held in front of the device
+class ofxLeapMotionSimpleTool{
+
+	public:
+	
+		ofxLeapMotionSimpleTool(){
+			id = -1;
+			handId = -1;
+			length = 0;
+			width = 0;
+			timeVisible = 0;
+			touchDistance = 1;
+			touchZone = OFX_LEAP_TOUCH_NONE;
+		}
+		
+		int64_t id;                         // stays the same while the tool is tracked
+		int64_t handId;                     // -1 if the Leap doesn't know which hand holds it
+		ofPoint pos;                        // tip
+		ofPoint vel;                        // tip velocity
+		ofPoint direction;                  // tip pointing direction - not mapped
+		float length;                       // mm
+		float width;                        // mm
+		float timeVisible;                  // seconds
+		float touchDistance;                // see simpleFinger
+		ofxLeapMotionTouchZone touchZone;
+};
+
+//a Leap gesture update - only the fields of its type are filled in, positions are in Leap mm
+//gestures are only reported once ofxLeapMotion::setupGestures() has enabled them
+class ofxLeapMotionSimpleGesture{
+
+	public:
+	
+		ofxLeapMotionSimpleGesture(){
+			id = -1;
+			type = OFX_LEAP_GESTURE_INVALID;
+			state = OFX_LEAP_GESTURE_STATE_INVALID;
+			speed = 0;
+			progress = 0;
+			radius = 0;
+			durationMicros = 0;
+		}
+		
+		int64_t id;                         // the same for every update of one gesture
+		ofxLeapMotionGestureType type;
+		ofxLeapMotionGestureState state;
+		ofPoint position;                   // swipe and tap position, circle center
+		ofPoint startPosition;              // swipe
+		ofPoint direction;                  // swipe and tap direction
+		ofPoint normal;                     // circle
+		float speed;                        // swipe - mm per second
+		float progress;                     // circle - number of turns, taps - 1 when done
+		float radius;                       // circle - mm
+		int64_t durationMicros;
+};
+
+//all the simple hands, tools and gestures of one Leap frame
+class ofxLeapMotionSimpleFrame{
+
+	public:
+	
+		ofxLeapMotionSimpleFrame(){
+			id = -1;
+			timestamp = 0;
+		}
+		
+		int64_t id;
+		int64_t timestamp;                  // Leap frame timestamp in microseconds
+		vector <ofxLeapMotionSimpleHand> hands;
+		vector <ofxLeapMotionSimpleTool> tools;
+		vector <ofxLeapMotionSimpleGesture> gestures;   // updates since the previous frame
+};
+
+//anything that can supply simple frames - ofxLeapMotion, a network receiver, a recording etc
+class ofxLeapMotionSource{
+
+	public:
+	
+		virtual ~ofxLeapMotionSource(){}
+		
+		//the latest frame in Leap mm - returns false if there is none
+		virtual bool getSimpleFrame(ofxLeapMotionSimpleFrame & frame) = 0;
+};
+
+//a source you push frames into yourself - for synthetic data or per device recordings
+class ofxLeapMotionFrameSource : public ofxLeapMotionSource{
+
+	public:
+	
+		void setFrame(const ofxLeapMotionSimpleFrame & frame){
+			std::unique_lock <std::mutex> lock(mutex);
+			latest = frame;
+		}
+		
+		bool getSimpleFrame(ofxLeapMotionSimpleFrame & frame){
+			std::unique_lock <std::mutex> lock(mutex);
+			if( latest.id < 0 ){
+				return false;
+			}
+			frame = latest;
+			return true;
+		}
+		
+	protected:
+		std::mutex mutex;
+		ofxLeapMotionSimpleFrame latest;
+};
+
+//the latest published frame plus a count of how many have been published - written by one thread, read by many
+//the count is a lock-free atomic. the frame pointer goes through std::atomic_load / atomic_store, which for a
+//shared_ptr take a short lock from the standard library's internal pool - held just for the pointer copy
+class ofxLeapMotionFrameStream{
+
+	public:
+	
+		ofxLeapMotionFrameStream()
+			:count(0){
+		}
+		
+		void publish(const std::shared_ptr <const ofxLeapMotionSimpleFrame> & frame){
+			std::atomic_store(&latest, frame);
+			count.fetch_add(1, std::memory_order_release);
+		}
+		
+		std::shared_ptr <const ofxLeapMotionSimpleFrame> getLatest() const{
+			return std::atomic_load(&latest);
+		}
+		
+		uint64_t getCount() const{
+			return count.load(std::memory_order_acquire);
+		}
+		
+	protected:
+		std::shared_ptr <const ofxLeapMotionSimpleFrame> latest;
+		std::atomic <uint64_t> count;
+};
+
+//one consumer's read position in a frame stream - see ofxLeapMotion::subscribe()
+//each thread that reads frames should have its own cursor - cursors don't share any state with each other
+//checking for a new frame is a single lock-free atomic load, the snapshot is only fetched when there is one - that
+//takes the stream's short pointer copy lock (see above) but never the ofxLeapMotion's mutex
+class ofxLeapMotionCursor{
+
+	public:
+	
+		ofxLeapMotionCursor()
+			:lastCount(0)
+			,lastId(-1){
+		}
+		
+		ofxLeapMotionCursor(const std::shared_ptr <ofxLeapMotionFrameStream> & stream)
+			:stream(stream)
+			,lastCount(0)
+			,lastId(-1){
+		}
+		
+		bool isFrameNew() const{
+			return stream && stream->getCount() != lastCount;
+		}
+		
+		//the newest frame if there has been one since the last poll - otherwise an empty pointer
+		//frames published in between are skipped, each consumer just reads at its own rate
+		std::shared_ptr <const ofxLeapMotionSimpleFrame> poll(){
+			if( !isFrameNew() ){
+				return std::shared_ptr <const ofxLeapMotionSimpleFrame> ();
+			}
+			
+			lastCount = stream->getCount();
+			std::shared_ptr <const ofxLeapMotionSimpleFrame> frame = stream->getLatest();
+			
+			//a frame published after we read the count may already have been returned by the previous poll
+			if( !frame || frame->id == lastId ){
+				return std::shared_ptr <const ofxLeapMotionSimpleFrame> ();
+			}
+			
+			lastId = frame->id;
+			return frame;
+		}
+		
+		//copies the newest frame into frame, returns false if there hasn't been one since the last poll
+		bool poll(ofxLeapMotionSimpleFrame & frame){
+			std::shared_ptr <const ofxLeapMotionSimpleFrame> latest = poll();
+			if( !latest ){
+				return false;
+			}
+			frame = *latest;
+			return true;
+		}
+		
+		//id of the last frame returned by poll() or -1
+		int64_t getFrameID() const{
+			return lastId;
+		}
+		
+	protected:
+		std::shared_ptr <ofxLeapMotionFrameStream> stream;
+		uint64_t lastCount;
+		int64_t lastId;
+};
+
+//maps Leap millimetres into your own coordinate space - see ofxLeapMotion::setMappingX etc
+class ofxLeapMotionMapping{
+
+	public:
+	
+		ofxLeapMotionMapping();
+		
+		void reset();
+		
+		void setX(float minX, float maxX, float outputMinX, float outputMaxX);
+		void setY(float minY, float maxY, float outputMinY, float outputMaxY);
+		void setZ(float minZ, float maxZ, float outputMinZ, float outputMaxZ);
+		
+		//normalize to the Leap interaction box before the x, y, z ranges are applied - the input ranges are then 0 to 1
+		void setNormalized(bool bNormalize, bool bClamp = true);
+		void setInteractionBox(const ofPoint & center, const ofPoint & size);
+		void resetInteractionBox();         // back to the default box, until the next Leap frame sets it
+		
+		ofPoint map(const ofPoint & p) const;
+		ofxLeapMotionSimpleHand map(const ofxLeapMotionSimpleHand & hand) const;
+		ofxLeapMotionSimpleTool map(const ofxLeapMotionSimpleTool & tool) const;
+		
+		float xOffsetIn, xOffsetOut, xScale;
+		float yOffsetIn, yOffsetOut, yScale;
+		float zOffsetIn, zOffsetOut, zScale;
+		
+		bool bNormalized;
+		bool bClamp;                        // keep normalized points inside 0 to 1
+		ofPoint boxCenter;                  // interaction box in Leap mm
+		ofPoint boxSize;
+};
+
+//the lens calibration of a camera - a 64x64 grid of (u, v) pairs, see Leap::Image::distortion()
+//the same object is shared by every image until the calibration changes
+class ofxLeapMotionDistortion{
+
+	public:
+	
+		ofxLeapMotionDistortion(){
+			width = 0;
+			height = 0;
+			version = 0;
+		}
+	
+		int width;                          // floats per row - two per grid point
+		int height;                         // rows
+		int64_t version;                    // increases every time the calibration changes
+		vector <float> map;
+};
+
+//a camera image from the Leap - 8 bit infrared intensity values
+//the images are copied once on the Leap thread into a pooled buffer, see ofxLeapMotion::updateImages()
+class ofxLeapMotionImage{
+
+	public:
+		
+		ofxLeapMotionImage(){
+			frameId = -1;
+			cameraId = 0;
+		}
+	
+		int64_t frameId;
+		int cameraId;                       // 0 = left camera, 1 = right camera
+		ofPixels pixels;
+		std::shared_ptr <const ofxLeapMotionDistortion> distortion;
+};
+
+//where ofxLeapMotion is in connecting to the Leap service and device - see ofxLeapMotion::getConnectionState()
+enum ofxLeapMotionConnectionState{
+	OFX_LEAP_CLOSED = 0,                // before open() or after close()
+	OFX_LEAP_CONNECTING,                // creating the controller or waiting for the Leap service
+	OFX_LEAP_SERVICE_CONNECTED,         // talking to the service but no device is connected
+	OFX_LEAP_CONNECTED                  // a device is connected and sending frames
+};
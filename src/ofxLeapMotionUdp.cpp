@@ -0,0 +1,160 @@
+/*
+ *  ofxLeapMotionUdp.cpp
+ *  ofxLeapMotion
+ *
+ */
+
+#include "ofxLeapMotionUdp.h"
+
+#ifdef TARGET_WIN32
+	#include <winsock2.h>
+	#include <ws2tcpip.h>
+	typedef int socklen_t;
+	#define closesocket_ closesocket
+#else
+	#include <sys/types.h>
+	#include <sys/socket.h>
+	#include <netinet/in.h>
+	#include <arpa/inet.h>
+	#include <netdb.h>
+	#include <poll.h>
+	#include <unistd.h>
+	#define closesocket_ ::close
+#endif
+
+static const int64_t invalidSocket = -1;
+
+//--------------------------------------------------------------
+ofxLeapMotionUdp::ofxLeapMotionUdp()
+		:sock(invalidSocket) {
+#ifdef TARGET_WIN32
+	static bool bWinsockStarted = false;
+	if( !bWinsockStarted ){
+		WSADATA data;
+		WSAStartup(MAKEWORD(2, 2), &data);
+		bWinsockStarted = true;
+	}
+#endif
+}
+
+//--------------------------------------------------------------
+ofxLeapMotionUdp::~ofxLeapMotionUdp(){
+	close();
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionUdp::create(){
+	close();
+	
+	int s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if( s < 0 ){
+		ofLogError("ofxLeapMotionUdp") << "couldn't create socket";
+		return false;
+	}
+	sock = s;
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionUdp::connect(string host, int port){
+	if( !create() ){
+		return false;
+	}
+	
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	
+	addrinfo * result = NULL;
+	if( getaddrinfo(host.c_str(), ofToString(port).c_str(), &hints, &result) != 0 || !result ){
+		ofLogError("ofxLeapMotionUdp") << "couldn't resolve " << host;
+		close();
+		return false;
+	}
+	
+	//lets us send to a broadcast address as well
+	int yes = 1;
+	setsockopt((int)sock, SOL_SOCKET, SO_BROADCAST, (const char *)&yes, sizeof(yes));
+	
+	bool bOk = ::connect((int)sock, result->ai_addr, result->ai_addrlen) == 0;
+	freeaddrinfo(result);
+	
+	if( !bOk ){
+		ofLogError("ofxLeapMotionUdp") << "couldn't connect to " << host << ":" << port;
+		close();
+	}
+	return bOk;
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionUdp::bind(int port){
+	if( !create() ){
+		return false;
+	}
+	
+	int yes = 1;
+	setsockopt((int)sock, SOL_SOCKET, SO_REUSEADDR, (const char *)&yes, sizeof(yes));
+	
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(port);
+	
+	if( ::bind((int)sock, (sockaddr *)&addr, sizeof(addr)) != 0 ){
+		ofLogError("ofxLeapMotionUdp") << "couldn't bind to port " << port;
+		close();
+		return false;
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionUdp::close(){
+	if( sock != invalidSocket ){
+		closesocket_((int)sock);
+		sock = invalidSocket;
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionUdp::isOpen(){
+	return sock != invalidSocket;
+}
+
+//--------------------------------------------------------------
+int ofxLeapMotionUdp::send(const char * data, int size){
+	if( sock == invalidSocket ){
+		return -1;
+	}
+	return ::send((int)sock, data, size, 0);
+}
+
+//--------------------------------------------------------------
+int ofxLeapMotionUdp::receive(char * data, int size, int timeoutMs){
+	if( sock == invalidSocket ){
+		return -1;
+	}
+	
+#ifdef TARGET_WIN32
+	fd_set readSet;
+	FD_ZERO(&readSet);
+	FD_SET((SOCKET)sock, &readSet);
+	timeval tv;
+	tv.tv_sec = timeoutMs / 1000;
+	tv.tv_usec = (timeoutMs % 1000) * 1000;
+	int ready = select(0, &readSet, NULL, NULL, &tv);
+#else
+	pollfd pfd;
+	pfd.fd = (int)sock;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	int ready = poll(&pfd, 1, timeoutMs);
+#endif
+	
+	if( ready <= 0 ){
+		return ready;
+	}
+	return recv((int)sock, data, size, 0);
+}
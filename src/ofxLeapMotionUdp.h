@@ -0,0 +1,34 @@
+//ofxLeapMotionUdp - minimal UDP socket used by the ofxLeapMotion network senders / receivers
+
+#pragma once
+
+#include "ofMain.h"
+
+class ofxLeapMotionUdp{
+
+	public:
+	
+		ofxLeapMotionUdp();
+		~ofxLeapMotionUdp();
+		
+		//for sending - sets the destination of send()
+		bool connect(string host, int port);
+		
+		//for receiving
+		bool bind(int port);
+		
+		void close();
+		bool isOpen();
+		
+		//returns the number of bytes sent or -1
+		int send(const char * data, int size);
+		
+		//waits up to timeoutMs for a packet - returns the size, 0 on timeout or -1 on error
+		int receive(char * data, int size, int timeoutMs);
+		
+	protected:
+	
+		bool create();
+	
+		int64_t sock;
+};
@@ -0,0 +1,158 @@
+/*
+ *  ofxLeapMotionUndistort.cpp
+ *  ofxLeapMotion
+ *
+ */
+
+#include "ofxLeapMotionUndistort.h"
+
+//below this many pixels per band waking the workers costs more than it saves
+static const int MIN_PIXELS_PER_BAND = 16384;
+
+//--------------------------------------------------------------
+ofxLeapMotionUndistort::ofxLeapMotionUndistort()
+		:outWidth(400)
+		,outHeight(400)
+		,numThreads(0)
+		,tableVersion(-1)
+		,tableSrcWidth(0)
+		,tableSrcHeight(0)
+		,srcStride(0) {
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionUndistort::setup(int outputWidth, int outputHeight){
+	outWidth	= MAX(1, outputWidth);
+	outHeight	= MAX(1, outputHeight);
+	tableVersion = -1;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionUndistort::setNumThreads(int num){
+	numThreads = MAX(0, num);
+}
+
+//--------------------------------------------------------------
+int ofxLeapMotionUndistort::getWidth() const{
+	return outWidth;
+}
+
+//--------------------------------------------------------------
+int ofxLeapMotionUndistort::getHeight() const{
+	return outHeight;
+}
+
+//--------------------------------------------------------------
+ofVec2f ofxLeapMotionUndistort::getRaySlope(float x, float y) const{
+	return ofVec2f( (x + 0.5) / (float)outWidth * 8.0 - 4.0, (y + 0.5) / (float)outHeight * 8.0 - 4.0 );
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionUndistort::buildTable(const ofxLeapMotionDistortion & distortion, int srcWidth, int srcHeight){
+	int numOut = outWidth * outHeight;
+	srcOffset.resize(numOut);
+	weightX.resize(numOut);
+	weightY.resize(numOut);
+	srcStride = srcWidth;
+	
+	int gridW = distortion.width / 2;
+	int gridH = distortion.height;
+	const float * grid = &distortion.map[0];
+	
+	for(int y = 0; y < outHeight; y++){
+		//position in the distortion grid
+		float gy	= ofClamp( (y + 0.5) / (float)outHeight * gridH - 0.5, 0, gridH - 1 );
+		int gy0		= MIN((int)gy, gridH - 2);
+		float fy	= gy - gy0;
+		
+		for(int x = 0; x < outWidth; x++){
+			float gx	= ofClamp( (x + 0.5) / (float)outWidth * gridW - 0.5, 0, gridW - 1 );
+			int gx0		= MIN((int)gx, gridW - 2);
+			float fx	= gx - gx0;
+			
+			const float * p00 = grid + gy0 * distortion.width + gx0 * 2;
+			const float * p01 = p00 + 2;
+			const float * p10 = p00 + distortion.width;
+			const float * p11 = p10 + 2;
+			
+			float u = (1-fy) * ((1-fx) * p00[0] + fx * p01[0]) + fy * ((1-fx) * p10[0] + fx * p11[0]);
+			float v = (1-fy) * ((1-fx) * p00[1] + fx * p01[1]) + fy * ((1-fx) * p10[1] + fx * p11[1]);
+			
+			int i = y * outWidth + x;
+			
+			//values outside 0 - 1 don't map to a pixel in the image
+			if( u < 0 || u > 1 || v < 0 || v > 1 ){
+				srcOffset[i]	= -1;
+				weightX[i]		= 0;
+				weightY[i]		= 0;
+				continue;
+			}
+			
+			float sx	= ofClamp(u * srcWidth - 0.5, 0, srcWidth - 1.001);
+			float sy	= ofClamp(v * srcHeight - 0.5, 0, srcHeight - 1.001);
+			int sx0		= MIN((int)sx, srcWidth - 2);
+			int sy0		= MIN((int)sy, srcHeight - 2);
+			
+			srcOffset[i]	= sy0 * srcWidth + sx0;
+			weightX[i]		= (uint8_t)ofClamp((sx - sx0) * 256.0, 0, 255);
+			weightY[i]		= (uint8_t)ofClamp((sy - sy0) * 256.0, 0, 255);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionUndistort::remapRows(const unsigned char * src, unsigned char * dst, int startRow, int endRow) const{
+	const int32_t * offset	= &srcOffset[0];
+	const uint8_t * wx		= &weightX[0];
+	const uint8_t * wy		= &weightY[0];
+	int stride				= srcStride;
+	
+	for(int i = startRow * outWidth; i < endRow * outWidth; i++){
+		int32_t o = offset[i];
+		if( o < 0 ){
+			dst[i] = 0;
+			continue;
+		}
+		
+		//8.8 fixed point bilinear
+		uint32_t fx = wx[i];
+		uint32_t fy = wy[i];
+		const unsigned char * s = src + o;
+		uint32_t top	= s[0] * (256 - fx) + s[1] * fx;
+		uint32_t bottom	= s[stride] * (256 - fx) + s[stride+1] * fx;
+		dst[i] = (unsigned char)( (top * (256 - fy) + bottom * fy) >> 16 );
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionUndistort::undistort(const ofxLeapMotionImage & image, ofPixels & output){
+	const ofPixels & src = image.pixels;
+	if( !image.distortion || !src.isAllocated() || src.getWidth() < 2 || src.getHeight() < 2 ){
+		return false;
+	}
+	
+	if( image.distortion->version != tableVersion || src.getWidth() != tableSrcWidth || src.getHeight() != tableSrcHeight ){
+		buildTable(*image.distortion, src.getWidth(), src.getHeight());
+		tableVersion	= image.distortion->version;
+		tableSrcWidth	= src.getWidth();
+		tableSrcHeight	= src.getHeight();
+	}
+	
+	if( output.getWidth() != outWidth || output.getHeight() != outHeight || output.getNumChannels() != 1 ){
+		output.allocate(outWidth, outHeight, OF_IMAGE_GRAYSCALE);
+	}
+	
+	int num = numThreads > 0 ? numThreads : (int)std::thread::hardware_concurrency();
+	num = ofClamp(num, 1, MAX(1, outWidth * outHeight / MIN_PIXELS_PER_BAND));
+	
+	const unsigned char * srcPix = src.getData();
+	unsigned char * dstPix = output.getData();
+	
+	int rowsPer = (outHeight + num - 1) / num;
+	workers.setNumThreads(num - 1);
+	workers.run(num, [&](int band){
+		remapRows(srcPix, dstPix, MIN(outHeight, band * rowsPer), MIN(outHeight, (band + 1) * rowsPer));
+	});
+	
+	return true;
+}
@@ -0,0 +1,51 @@
+//ofxLeapMotionUndistort - removes the lens distortion from ofxLeapMotion camera images on the CPU
+//a remap table is built from the image's distortion map once per calibration change
+//then each image is remapped with a fixed point bilinear lookup split by rows across a few long lived threads
+//the output covers the ray slopes of the distortion map (-4 to 4 in x and y), see Leap::Image::rectify()
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxLeapMotionTypes.h"
+#include "ofxLeapMotionWorkers.h"
+
+class ofxLeapMotionUndistort{
+
+	public:
+	
+		ofxLeapMotionUndistort();
+		
+		//size of the undistorted image
+		void setup(int outputWidth, int outputHeight);
+		
+		//0 uses all the cores - small images are always done on the calling thread
+		void setNumThreads(int numThreads);
+		
+		//returns false if the image has no distortion map yet
+		bool undistort(const ofxLeapMotionImage & image, ofPixels & output);
+		
+		//converts an undistorted pixel position into the ray slope of the camera
+		ofVec2f getRaySlope(float x, float y) const;
+		
+		int getWidth() const;
+		int getHeight() const;
+		
+	protected:
+		
+		void buildTable(const ofxLeapMotionDistortion & distortion, int srcWidth, int srcHeight);
+		void remapRows(const unsigned char * src, unsigned char * dst, int startRow, int endRow) const;
+		
+		int outWidth, outHeight;
+		int numThreads;
+		ofxLeapMotionWorkers workers;
+		
+		//what the table was built from
+		int64_t tableVersion;
+		int tableSrcWidth, tableSrcHeight;
+		
+		//one entry per output pixel - the top left source pixel (-1 if outside the image) and 8 bit weights 
+		vector <int32_t> srcOffset;
+		vector <uint8_t> weightX;
+		vector <uint8_t> weightY;
+		int srcStride;
+};
@@ -0,0 +1,117 @@
+/*
+ *  ofxLeapMotionWatchdog.cpp
+ *  ofxLeapMotion
+ *
+ */
+
+#include "ofxLeapMotionWatchdog.h"
+
+//--------------------------------------------------------------
+ofxLeapMotionWatchdog::ofxLeapMotionWatchdog(){
+	setup();
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionWatchdog::setup(float stallTimeoutSeconds, float minBackoffSeconds, float maxBackoffSeconds){
+	stallTimeout	= MAX(0, stallTimeoutSeconds) * 1000000.0;
+	minBackoff		= MAX(0, minBackoffSeconds) * 1000000.0;
+	maxBackoff		= MAX(minBackoffSeconds, maxBackoffSeconds) * 1000000.0;
+	reset();
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionWatchdog::reset(){
+	health = ofxLeapMotionHealth();
+	lastFrameId = -1;
+	lastFrameTime = 0;
+	nextRetryTime = 0;
+	bStarted = false;
+}
+
+//--------------------------------------------------------------
+uint64_t ofxLeapMotionWatchdog::getBackoff() const{
+	//min, 2 x min, 4 x min ... up to max
+	uint64_t backoff = minBackoff;
+	for(int i = 1; i < health.consecutiveFailures && backoff < maxBackoff; i++){
+		backoff *= 2;
+	}
+	return MIN(backoff, maxBackoff);
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionWatchdog::update(uint64_t nowMicros, int64_t frameId, bool bExpectFrames){
+	if( !bStarted ){
+		//the stall timeout for the first frame counts from the first update
+		lastFrameTime = nowMicros;
+		bStarted = true;
+	}
+	
+	if( frameId != lastFrameId && frameId >= 0 ){
+		//Leap frame ids go up by one per frame - so the difference is the number of frames since the last update
+		uint64_t numNew = (lastFrameId >= 0 && frameId > lastFrameId) ? frameId - lastFrameId : 1;
+		if( nowMicros > lastFrameTime && health.numFrames ){
+			float rate = numNew * 1000000.0 / (nowMicros - lastFrameTime);
+			health.frameRate = health.frameRate * 0.8 + rate * 0.2;
+		}
+		health.numFrames += numNew;
+		
+		lastFrameId = frameId;
+		lastFrameTime = nowMicros;
+		health.state = OFX_LEAP_WATCHDOG_HEALTHY;
+		health.consecutiveFailures = 0;
+		health.microsSinceLastFrame = 0;
+		health.microsUntilRetry = 0;
+		return false;
+	}
+	
+	health.microsSinceLastFrame = nowMicros - lastFrameTime;
+	
+	if( !bExpectFrames ){
+		//the stall timeout starts again once frames are expected
+		health.state = OFX_LEAP_WATCHDOG_PAUSED;
+		lastFrameTime = nowMicros;
+		return false;
+	}
+	
+	if( health.state == OFX_LEAP_WATCHDOG_PAUSED ){
+		health.state = lastFrameId >= 0 ? OFX_LEAP_WATCHDOG_HEALTHY : OFX_LEAP_WATCHDOG_IDLE;
+	}
+	
+	if( health.state != OFX_LEAP_WATCHDOG_STALLED ){
+		if( nowMicros - lastFrameTime < stallTimeout ){
+			return false;
+		}
+		
+		//the first reconnect happens straight away, after that it backs off
+		if( health.state == OFX_LEAP_WATCHDOG_HEALTHY ){
+			health.numStalls++;
+		}
+		nextRetryTime = health.consecutiveFailures ? nowMicros + getBackoff() : nowMicros;
+		health.state = OFX_LEAP_WATCHDOG_STALLED;
+	}
+	
+	if( nowMicros < nextRetryTime ){
+		health.microsUntilRetry = nextRetryTime - nowMicros;
+		return false;
+	}
+	
+	//the stall timeout restarts so the new connection gets time to deliver frames
+	health.state = OFX_LEAP_WATCHDOG_RECONNECTING;
+	health.consecutiveFailures++;
+	health.numReconnects++;
+	health.microsUntilRetry = 0;
+	lastFrameTime = nowMicros;
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionWatchdog::update(uint64_t nowMicros, ofxLeapMotionSource & source, bool bExpectFrames){
+	ofxLeapMotionSimpleFrame frame;
+	int64_t frameId = source.getSimpleFrame(frame) ? frame.id : lastFrameId;
+	return update(nowMicros, frameId, bExpectFrames);
+}
+
+//--------------------------------------------------------------
+ofxLeapMotionHealth ofxLeapMotionWatchdog::getHealth() const{
+	return health;
+}
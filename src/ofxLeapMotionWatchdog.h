@@ -0,0 +1,78 @@
+//ofxLeapMotionWatchdog - decides when a Leap connection has stalled and when to try reconnecting
+//a connection is unhealthy when no new frame id has arrived for the stall timeout (service loss, USB reset,
+//unplugged device all look the same). reconnect attempts back off exponentially from the min to the max delay
+//and the backoff is reset as soon as frames arrive again.
+//
+//the watchdog only makes the decision - it doesn't own any thread or clock, so it can be driven with
+//simulated time and a fake source. ofxLeapMotion runs one on its own thread, see ofxLeapMotion::setWatchdog()
+
+#pragma once
+
+#include "ofxLeapMotionTypes.h"
+
+enum ofxLeapMotionWatchdogState{
+	OFX_LEAP_WATCHDOG_IDLE = 0,         // no frames seen yet
+	OFX_LEAP_WATCHDOG_HEALTHY,          // frames are arriving
+	OFX_LEAP_WATCHDOG_PAUSED,           // frames aren't expected - eg: the app doesn't have focus
+	OFX_LEAP_WATCHDOG_STALLED,          // no frames for the stall timeout, waiting for the backoff to reconnect
+	OFX_LEAP_WATCHDOG_RECONNECTING      // a reconnect has been asked for, waiting for frames
+};
+
+class ofxLeapMotionHealth{
+
+	public:
+		
+		ofxLeapMotionHealth(){
+			state = OFX_LEAP_WATCHDOG_IDLE;
+			numFrames = 0;
+			frameRate = 0;
+			microsSinceLastFrame = 0;
+			numStalls = 0;
+			numReconnects = 0;
+			consecutiveFailures = 0;
+			microsUntilRetry = 0;
+		}
+		
+		ofxLeapMotionWatchdogState state;
+		uint64_t numFrames;                 // new frame ids seen
+		float frameRate;                    // smoothed frames per second
+		uint64_t microsSinceLastFrame;
+		uint64_t numStalls;                 // times the connection went from healthy to stalled
+		uint64_t numReconnects;             // reconnects asked for in total
+		int consecutiveFailures;            // reconnects since frames last arrived
+		uint64_t microsUntilRetry;          // when stalled - time until the next reconnect
+};
+
+class ofxLeapMotionWatchdog{
+
+	public:
+		
+		ofxLeapMotionWatchdog();
+		
+		void setup(float stallTimeoutSeconds = 2.0, float minBackoffSeconds = 0.5, float maxBackoffSeconds = 30.0);
+		void reset();
+		
+		//call regularly with the current time and the latest frame id
+		//bExpectFrames = false pauses stall detection (eg: the app lost focus and background frames are off)
+		//returns true when the caller should tear down and recreate the connection now
+		bool update(uint64_t nowMicros, int64_t frameId, bool bExpectFrames = true);
+		
+		//the same using the latest frame of any source - eg: an ofxLeapMotionFrameSource simulating drops
+		bool update(uint64_t nowMicros, ofxLeapMotionSource & source, bool bExpectFrames = true);
+		
+		ofxLeapMotionHealth getHealth() const;
+	
+	protected:
+		
+		uint64_t getBackoff() const;
+		
+		uint64_t stallTimeout;
+		uint64_t minBackoff;
+		uint64_t maxBackoff;
+		
+		ofxLeapMotionHealth health;
+		int64_t lastFrameId;
+		uint64_t lastFrameTime;
+		uint64_t nextRetryTime;
+		bool bStarted;
+};
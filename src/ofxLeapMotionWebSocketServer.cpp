@@ -0,0 +1,686 @@
+/*
+ *  ofxLeapMotionWebSocketServer.cpp
+ *  ofxLeapMotion
+ *
+ */
+
+#include "ofxLeapMotionWebSocketServer.h"
+
+#ifdef TARGET_LINUX
+	#include <sys/epoll.h>
+	#include <sys/eventfd.h>
+	#include <sys/socket.h>
+	#include <netinet/in.h>
+	#include <netinet/tcp.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <errno.h>
+	#include <pthread.h>
+	#include <time.h>
+#endif
+
+//the biggest message a client may send us - we don't use them, they are only read to find control frames
+static const size_t maxIncomingBytes = 65536;
+
+//the kernel buffer per client - about 30 frames of a few hands, the kernel doubles it
+static const int sendBufferBytes = 16384;
+
+class ofxLeapMotionWebSocketClient{
+	public:
+	
+		ofxLeapMotionWebSocketClient(){
+			sock = -1;
+			bOpen = false;
+			sendOffset = 0;
+			bWantWrite = false;
+			bClosing = false;
+		}
+		
+		int sock;
+		bool bOpen;                                 // handshake done
+		bool bClosing;                              // the close reply is queued - the socket closes once it is sent
+		string request;                             // the http request while handshaking
+		string incoming;                            // received websocket frames not parsed yet
+		string response;                            // the http response while handshaking
+		std::shared_ptr <const string> sending;     // message being sent
+		size_t sendOffset;
+		std::shared_ptr <const string> next;        // newest message waiting - replaced if a newer one arrives
+		vector <std::shared_ptr <const string> > control;  // pong and close replies - never dropped and sent before next
+		bool bWantWrite;
+};
+
+//--------------------------------------------------------------
+static void sha1(const string & input, unsigned char digest[20]){
+	uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+	
+	string msg = input;
+	uint64_t bitLen = (uint64_t)input.size() * 8;
+	msg.push_back((char)0x80);
+	while( msg.size() % 64 != 56 ){
+		msg.push_back(0);
+	}
+	for(int i = 7; i >= 0; i--){
+		msg.push_back((char)(bitLen >> (i * 8)));
+	}
+	
+	for(size_t chunk = 0; chunk < msg.size(); chunk += 64){
+		uint32_t w[80];
+		for(int i = 0; i < 16; i++){
+			const unsigned char * p = (const unsigned char *)&msg[chunk + i * 4];
+			w[i] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+		}
+		for(int i = 16; i < 80; i++){
+			uint32_t v = w[i-3] ^ w[i-8] ^ w[i-14] ^ w[i-16];
+			w[i] = (v << 1) | (v >> 31);
+		}
+		
+		uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+		for(int i = 0; i < 80; i++){
+			uint32_t f, k;
+			if( i < 20 ){
+				f = (b & c) | (~b & d);
+				k = 0x5A827999;
+			}else if( i < 40 ){
+				f = b ^ c ^ d;
+				k = 0x6ED9EBA1;
+			}else if( i < 60 ){
+				f = (b & c) | (b & d) | (c & d);
+				k = 0x8F1BBCDC;
+			}else{
+				f = b ^ c ^ d;
+				k = 0xCA62C1D6;
+			}
+			uint32_t temp = ((a << 5) | (a >> 27)) + f + e + k + w[i];
+			e = d;
+			d = c;
+			c = (b << 30) | (b >> 2);
+			b = a;
+			a = temp;
+		}
+		h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+	}
+	
+	for(int i = 0; i < 5; i++){
+		digest[i*4]		= (unsigned char)(h[i] >> 24);
+		digest[i*4+1]	= (unsigned char)(h[i] >> 16);
+		digest[i*4+2]	= (unsigned char)(h[i] >> 8);
+		digest[i*4+3]	= (unsigned char)h[i];
+	}
+}
+
+//--------------------------------------------------------------
+static string base64(const unsigned char * data, int size){
+	static const char * chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	string out;
+	for(int i = 0; i < size; i += 3){
+		uint32_t v = (uint32_t)data[i] << 16;
+		if( i + 1 < size ) v |= (uint32_t)data[i+1] << 8;
+		if( i + 2 < size ) v |= (uint32_t)data[i+2];
+		out.push_back(chars[(v >> 18) & 63]);
+		out.push_back(chars[(v >> 12) & 63]);
+		out.push_back(i + 1 < size ? chars[(v >> 6) & 63] : '=');
+		out.push_back(i + 2 < size ? chars[v & 63] : '=');
+	}
+	return out;
+}
+
+//--------------------------------------------------------------
+template <class T> static void writeLE(string & out, T v){
+	//the targets we build for are little endian
+	out.append((const char *)&v, sizeof(T));
+}
+
+//--------------------------------------------------------------
+static void writePoint(string & out, const ofPoint & p){
+	writeLE(out, (float)p.x);
+	writeLE(out, (float)p.y);
+	writeLE(out, (float)p.z);
+}
+
+//--------------------------------------------------------------
+static std::shared_ptr <const string> makeMessage(unsigned char opcode, const string & payload){
+	std::shared_ptr <string> msg(new string());
+	msg->reserve(payload.size() + 10);
+	msg->push_back((char)(0x80 | opcode));     // final frame
+	if( payload.size() < 126 ){
+		msg->push_back((char)payload.size());
+	}else if( payload.size() < 65536 ){
+		msg->push_back((char)126);
+		msg->push_back((char)(payload.size() >> 8));
+		msg->push_back((char)payload.size());
+	}else{
+		msg->push_back((char)127);
+		for(int i = 7; i >= 0; i--){
+			msg->push_back((char)((uint64_t)payload.size() >> (i * 8)));
+		}
+	}
+	msg->append(payload);
+	return msg;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionWebSocketServer::serialize(const ofxLeapMotionSimpleFrame & frame, string & out){
+	out.clear();
+	writeLE(out, (int64_t)frame.id);
+	writeLE(out, (int64_t)frame.timestamp);
+	writeLE(out, (uint8_t)MIN(frame.hands.size(), (size_t)255));
+	
+	for(int i = 0; i < frame.hands.size() && i < 255; i++){
+		const ofxLeapMotionSimpleHand & hand = frame.hands[i];
+		writeLE(out, (int32_t)hand.id);
+		writePoint(out, hand.handPos);
+		writePoint(out, hand.handNormal);
+		writePoint(out, hand.handVelocity);
+		writePoint(out, hand.sphereCenter);
+		writeLE(out, (float)hand.sphereRadius);
+		writeLE(out, (uint8_t)MIN(hand.fingers.size(), (size_t)255));
+		
+		for(int j = 0; j < hand.fingers.size() && j < 255; j++){
+			writeLE(out, (int32_t)hand.fingers[j].id);
+			writePoint(out, hand.fingers[j].pos);
+			writePoint(out, hand.fingers[j].vel);
+			writePoint(out, hand.fingers[j].base);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+ofxLeapMotionWebSocketServer::ofxLeapMotionWebSocketServer()
+		:listenSock(-1)
+		,epollFd(-1)
+		,wakeFd(-1)
+		,maxClients(256)
+		,bRunning(false)
+		,numClients(0)
+		,numDropped(0) {
+}
+
+//--------------------------------------------------------------
+ofxLeapMotionWebSocketServer::~ofxLeapMotionWebSocketServer(){
+	close();
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionWebSocketServer::setup(int port, int max){
+	close();
+	
+#ifndef TARGET_LINUX
+	ofLogError("ofxLeapMotionWebSocketServer") << "only supported on Linux";
+	return false;
+#else
+	maxClients = max;
+	
+	listenSock = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+	int yes = 1;
+	setsockopt(listenSock, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+	
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(port);
+	
+	if( listenSock < 0 || ::bind(listenSock, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(listenSock, 128) != 0 ){
+		ofLogError("ofxLeapMotionWebSocketServer") << "couldn't listen on port " << port;
+		close();
+		return false;
+	}
+	
+	epollFd = epoll_create1(0);
+	wakeFd = eventfd(0, EFD_NONBLOCK);
+	
+	epoll_event ev;
+	ev.events = EPOLLIN;
+	ev.data.fd = listenSock;
+	bool bOk = epollFd >= 0 && wakeFd >= 0 && epoll_ctl(epollFd, EPOLL_CTL_ADD, listenSock, &ev) == 0;
+	ev.data.fd = wakeFd;
+	if( !bOk || epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev) != 0 ){
+		ofLogError("ofxLeapMotionWebSocketServer") << "couldn't set up epoll: " << strerror(errno);
+		close();
+		return false;
+	}
+	
+	bRunning = true;
+	thread = std::thread(&ofxLeapMotionWebSocketServer::threadedFunction, this);
+	return true;
+#endif
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionWebSocketServer::close(){
+#ifdef TARGET_LINUX
+	if( thread.joinable() ){
+		bRunning = false;
+		uint64_t one = 1;
+		if( write(wakeFd, &one, sizeof(one)) < 0 ){
+			ofLogWarning("ofxLeapMotionWebSocketServer") << "couldn't wake the server thread";
+		}
+		thread.join();
+	}
+	
+	while( clients.size() ){
+		closeClient(clients.begin()->second);
+	}
+	
+	if( listenSock >= 0 ) ::close(listenSock);
+	if( epollFd >= 0 ) ::close(epollFd);
+	if( wakeFd >= 0 ) ::close(wakeFd);
+	listenSock = epollFd = wakeFd = -1;
+	current.reset();
+#endif
+}
+
+//--------------------------------------------------------------
+int ofxLeapMotionWebSocketServer::getNumClients(){
+	return numClients;
+}
+
+//--------------------------------------------------------------
+uint64_t ofxLeapMotionWebSocketServer::getNumDropped(){
+	return numDropped;
+}
+
+//--------------------------------------------------------------
+uint64_t ofxLeapMotionWebSocketServer::getCpuMicros(){
+#ifdef TARGET_LINUX
+	clockid_t clock;
+	timespec time;
+	if( thread.joinable() && pthread_getcpuclockid(thread.native_handle(), &clock) == 0 && clock_gettime(clock, &time) == 0 ){
+		return (uint64_t)time.tv_sec * 1000000 + time.tv_nsec / 1000;
+	}
+#endif
+	return 0;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionWebSocketServer::publish(const ofxLeapMotionSimpleFrame & frame){
+#ifdef TARGET_LINUX
+	if( !bRunning ){
+		return;
+	}
+	
+	//serialized once - every client sends the same buffer
+	serialize(frame, serialized);
+	std::shared_ptr <const string> msg = makeMessage(0x2, serialized);
+	
+	{
+		std::unique_lock <std::mutex> lock(mutex);
+		latest = msg;
+	}
+	
+	uint64_t one = 1;
+	if( write(wakeFd, &one, sizeof(one)) < 0 ){
+		//the counter is already set so the server will pick the frame up anyway
+	}
+#endif
+}
+
+#ifdef TARGET_LINUX
+
+//--------------------------------------------------------------
+void ofxLeapMotionWebSocketServer::threadedFunction(){
+	vector <epoll_event> events(64);
+	
+	while( bRunning ){
+		int num = epoll_wait(epollFd, &events[0], events.size(), 500);
+		
+		for(int i = 0; i < num && bRunning; i++){
+			int fd = events[i].data.fd;
+			
+			if( fd == listenSock ){
+				acceptClients();
+			}else if( fd == wakeFd ){
+				uint64_t count;
+				if( read(wakeFd, &count, sizeof(count)) < 0 ){
+					//nothing to read - another wake already cleared it
+				}
+				
+				{
+					std::unique_lock <std::mutex> lock(mutex);
+					current = latest;
+				}
+				
+				std::map <int, ofxLeapMotionWebSocketClient *>::iterator it;
+				for(it = clients.begin(); it != clients.end(); ){
+					ofxLeapMotionWebSocketClient * client = it->second;
+					++it;
+					if( client->bOpen && !client->bClosing ){
+						queueLatest(client);
+					}
+				}
+			}else{
+				std::map <int, ofxLeapMotionWebSocketClient *>::iterator it = clients.find(fd);
+				if( it == clients.end() ){
+					continue;
+				}
+				ofxLeapMotionWebSocketClient * client = it->second;
+				
+				if( events[i].events & (EPOLLERR | EPOLLHUP) ){
+					closeClient(client);
+					continue;
+				}
+				if( events[i].events & EPOLLIN ){
+					readClient(client);
+					if( clients.find(fd) == clients.end() ){
+						continue;
+					}
+				}
+				if( events[i].events & EPOLLOUT ){
+					writeClient(client);
+				}
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionWebSocketServer::acceptClients(){
+	while( true ){
+		int sock = accept4(listenSock, NULL, NULL, SOCK_NONBLOCK);
+		if( sock < 0 ){
+			return;
+		}
+		
+		if( (int)clients.size() >= maxClients ){
+			::close(sock);
+			continue;
+		}
+		
+		int yes = 1;
+		setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+		
+		//left to itself the kernel grows the send buffer to megabytes - seconds of stale frames for a slow client
+		//kept small, a client that can't keep up backs up here instead and gets the newest frame next
+		setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &sendBufferBytes, sizeof(sendBufferBytes));
+		
+		ofxLeapMotionWebSocketClient * client = new ofxLeapMotionWebSocketClient();
+		client->sock = sock;
+		clients[sock] = client;
+		
+		epoll_event ev;
+		ev.events = EPOLLIN;
+		ev.data.fd = sock;
+		epoll_ctl(epollFd, EPOLL_CTL_ADD, sock, &ev);
+	}
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionWebSocketServer::readClient(ofxLeapMotionWebSocketClient * client){
+	char buf[4096];
+	int sock = client->sock;
+	
+	while( true ){
+		ssize_t n = recv(sock, buf, sizeof(buf), 0);
+		if( n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) ){
+			closeClient(client);
+			return;
+		}
+		if( n < 0 ){
+			break;
+		}
+		
+		if( client->bClosing ){
+			continue;
+		}
+		
+		if( client->bOpen ){
+			client->incoming.append(buf, n);
+		}else{
+			client->request.append(buf, n);
+			size_t headerEnd = client->request.find("\r\n\r\n");
+			if( headerEnd == string::npos ){
+				if( client->request.size() > 16384 ){
+					closeClient(client);
+					return;
+				}
+				continue;
+			}
+			
+			//anything after the request is already websocket frames
+			client->incoming = client->request.substr(headerEnd + 4);
+			client->request.resize(headerEnd + 2);
+			if( !handshake(client) ){
+				return;
+			}
+		}
+		
+		readFrames(client);
+		if( !clients.count(sock) ){
+			return;
+		}
+		
+		//what is left is the start of a single frame
+		if( client->incoming.size() > maxIncomingBytes + 14 ){
+			closeClient(client);
+			return;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxLeapMotionWebSocketServer::handshake(ofxLeapMotionWebSocketClient * client){
+	//header names are case insensitive - look for the key line in a lower case copy
+	string lower = client->request;
+	std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+	
+	string key;
+	size_t keyPos = lower.find("\r\nsec-websocket-key:");
+	if( keyPos != string::npos ){
+		size_t start = client->request.find_first_not_of(" \t", keyPos + 20);
+		size_t end = client->request.find("\r\n", start);
+		if( start != string::npos && end != string::npos ){
+			key = client->request.substr(start, end - start);
+			key.erase(key.find_last_not_of(" \t") + 1);
+		}
+	}
+	
+	if( key.empty() ){
+		closeClient(client);
+		return false;
+	}
+	
+	unsigned char digest[20];
+	sha1(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11", digest);
+	
+	client->response = "HTTP/1.1 101 Switching Protocols\r\n"
+		"Upgrade: websocket\r\n"
+		"Connection: Upgrade\r\n"
+		"Sec-WebSocket-Accept: " + base64(digest, 20) + "\r\n\r\n";
+	client->request.clear();
+	client->bOpen = true;
+	numClients++;
+	
+	//the response goes out like a message - writing can close the client
+	int sock = client->sock;
+	client->sending.reset(new string(client->response));
+	client->sendOffset = 0;
+	writeClient(client);
+	
+	return clients.count(sock) > 0;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionWebSocketServer::readFrames(ofxLeapMotionWebSocketClient * client){
+	//replying can close the client, after that only the socket number is safe to use
+	int sock = client->sock;
+	string & in = client->incoming;
+	size_t pos = 0;
+	
+	//whole frames only - a frame split across reads waits in incoming for the rest
+	while( !client->bClosing && in.size() - pos >= 2 ){
+		const unsigned char * p = (const unsigned char *)in.data() + pos;
+		unsigned char opcode = p[0] & 0x0F;
+		bool bMasked = p[1] & 0x80;
+		uint64_t length = p[1] & 0x7F;
+		size_t headerSize = 2;
+		
+		//clients must mask every frame, control frames fit in 125 bytes and can't be fragmented
+		bool bControl = opcode & 0x8;
+		if( !bMasked || (bControl && !(p[0] & 0x80)) || (opcode > 0x2 && opcode < 0x8) || opcode > 0xA ){
+			closeClient(client);
+			return;
+		}
+		
+		if( length == 126 ){
+			headerSize += 2;
+		}else if( length == 127 ){
+			headerSize += 8;
+		}
+		if( in.size() - pos < headerSize + 4 ){
+			break;
+		}
+		if( length == 126 ){
+			length = ((uint64_t)p[2] << 8) | p[3];
+		}else if( length == 127 ){
+			length = 0;
+			for(int i = 0; i < 8; i++){
+				length = (length << 8) | p[2 + i];
+			}
+		}
+		
+		if( length > maxIncomingBytes || (bControl && length > 125) ){
+			closeClient(client);
+			return;
+		}
+		if( in.size() - pos < headerSize + 4 + length ){
+			break;
+		}
+		
+		const unsigned char * mask = p + headerSize;
+		string payload((const char *)mask + 4, length);
+		for(size_t i = 0; i < length; i++){
+			payload[i] ^= mask[i % 4];
+		}
+		pos += headerSize + 4 + length;
+		
+		if( opcode == 0x9 ){
+			queueControl(client, makeMessage(0xA, payload));
+		}else if( opcode == 0x8 ){
+			//echo the status code back then close once it is sent
+			queueControl(client, makeMessage(0x8, payload.substr(0, MIN(payload.size(), (size_t)2))));
+			if( clients.count(sock) ){
+				client->bClosing = true;
+				client->next.reset();
+				if( !client->sending ){
+					closeClient(client);
+				}
+			}
+			return;
+		}
+		//data and pong frames are ignored
+		
+		if( !clients.count(sock) ){
+			return;
+		}
+	}
+	
+	in.erase(0, pos);
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionWebSocketServer::queueControl(ofxLeapMotionWebSocketClient * client, std::shared_ptr <const string> msg){
+	if( client->sending ){
+		client->control.push_back(msg);
+		return;
+	}
+	
+	client->sending = msg;
+	client->sendOffset = 0;
+	writeClient(client);
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionWebSocketServer::queueLatest(ofxLeapMotionWebSocketClient * client){
+	if( !current ){
+		return;
+	}
+	
+	if( client->sending ){
+		//still busy - the newest frame waits, anything older that was waiting is dropped
+		if( client->next ){
+			numDropped++;
+		}
+		client->next = current;
+		return;
+	}
+	
+	client->sending = current;
+	client->sendOffset = 0;
+	writeClient(client);
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionWebSocketServer::writeClient(ofxLeapMotionWebSocketClient * client){
+	while( client->sending ){
+		const string & msg = *client->sending;
+		ssize_t n = send(client->sock, msg.data() + client->sendOffset, msg.size() - client->sendOffset, MSG_NOSIGNAL);
+		if( n < 0 ){
+			if( errno == EAGAIN || errno == EWOULDBLOCK ){
+				break;
+			}
+			closeClient(client);
+			return;
+		}
+		
+		client->sendOffset += n;
+		if( client->sendOffset >= msg.size() ){
+			if( client->control.size() ){
+				client->sending = client->control.front();
+				client->control.erase(client->control.begin());
+			}else{
+				client->sending = client->next;
+				client->next.reset();
+			}
+			client->sendOffset = 0;
+		}
+	}
+	
+	//the close reply is out
+	if( client->bClosing && !client->sending ){
+		closeClient(client);
+		return;
+	}
+	
+	updateEvents(client);
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionWebSocketServer::updateEvents(ofxLeapMotionWebSocketClient * client){
+	//only ask for writable events while something is left to send
+	bool bWantWrite = (bool)client->sending;
+	if( bWantWrite == client->bWantWrite ){
+		return;
+	}
+	
+	epoll_event ev;
+	ev.events = EPOLLIN | (bWantWrite ? EPOLLOUT : 0);
+	ev.data.fd = client->sock;
+	epoll_ctl(epollFd, EPOLL_CTL_MOD, client->sock, &ev);
+	client->bWantWrite = bWantWrite;
+}
+
+//--------------------------------------------------------------
+void ofxLeapMotionWebSocketServer::closeClient(ofxLeapMotionWebSocketClient * client){
+	epoll_ctl(epollFd, EPOLL_CTL_DEL, client->sock, NULL);
+	::close(client->sock);
+	if( client->bOpen ){
+		numClients--;
+	}
+	clients.erase(client->sock);
+	delete client;
+}
+
+#else
+
+void ofxLeapMotionWebSocketServer::threadedFunction(){}
+void ofxLeapMotionWebSocketServer::acceptClients(){}
+void ofxLeapMotionWebSocketServer::readClient(ofxLeapMotionWebSocketClient * client){}
+bool ofxLeapMotionWebSocketServer::handshake(ofxLeapMotionWebSocketClient * client){ return false; }
+void ofxLeapMotionWebSocketServer::readFrames(ofxLeapMotionWebSocketClient * client){}
+void ofxLeapMotionWebSocketServer::queueControl(ofxLeapMotionWebSocketClient * client, std::shared_ptr <const string> msg){}
+void ofxLeapMotionWebSocketServer::writeClient(ofxLeapMotionWebSocketClient * client){}
+void ofxLeapMotionWebSocketServer::queueLatest(ofxLeapMotionWebSocketClient * client){}
+void ofxLeapMotionWebSocketServer::closeClient(ofxLeapMotionWebSocketClient * client){}
+void ofxLeapMotionWebSocketServer::updateEvents(ofxLeapMotionWebSocketClient * client){}
+
+#endif
@@ -0,0 +1,75 @@
+//ofxLeapMotionWebSocketServer - streams simple hand frames to browsers over WebSockets
+//a single epoll thread serves every client. each frame is serialized once and the same buffer is 
+//sent to all clients. a client that can't keep up only ever has the frame it is sending plus the 
+//newest one waiting - older frames are dropped rather than queued, and the socket send buffers are kept small.
+//messages from clients are ignored apart from ping, answered with a pong, and close, answered before the socket is closed.
+//
+//binary message layout (little endian):
+//  int64 frame id, int64 timestamp (microseconds), uint8 number of hands, then per hand:
+//    int32 id, float32 x 13 (position, normal, velocity, sphere center, sphere radius), uint8 number of fingers, then per finger:
+//      int32 id, float32 x 9 (tip position, tip velocity, base position)
+//
+//values are in Leap mm. note: Linux only
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxLeapMotionTypes.h"
+
+#include <atomic>
+
+class ofxLeapMotionWebSocketClient;
+
+class ofxLeapMotionWebSocketServer{
+
+	public:
+	
+		ofxLeapMotionWebSocketServer();
+		~ofxLeapMotionWebSocketServer();
+		
+		bool setup(int port = 9002, int maxClients = 256);
+		void close();
+		
+		//call from the app thread with frames from ofxLeapMotion::getSimpleFrame()
+		void publish(const ofxLeapMotionSimpleFrame & frame);
+		
+		int getNumClients();
+		uint64_t getNumDropped();
+		
+		//CPU time the server thread has used since setup() - what serving the clients costs
+		uint64_t getCpuMicros();
+		
+		static void serialize(const ofxLeapMotionSimpleFrame & frame, string & out);
+		
+	protected:
+	
+		void threadedFunction();
+		void acceptClients();
+		void readClient(ofxLeapMotionWebSocketClient * client);
+		bool handshake(ofxLeapMotionWebSocketClient * client);
+		void readFrames(ofxLeapMotionWebSocketClient * client);
+		void queueControl(ofxLeapMotionWebSocketClient * client, std::shared_ptr <const string> msg);
+		void writeClient(ofxLeapMotionWebSocketClient * client);
+		void queueLatest(ofxLeapMotionWebSocketClient * client);
+		void closeClient(ofxLeapMotionWebSocketClient * client);
+		void updateEvents(ofxLeapMotionWebSocketClient * client);
+		
+		int listenSock;
+		int epollFd;
+		int wakeFd;
+		int maxClients;
+		
+		std::thread thread;
+		std::atomic <bool> bRunning;
+		
+		std::mutex mutex;
+		std::shared_ptr <const string> latest;     // the newest frame as a complete websocket message
+		string serialized;
+		
+		//only touched by the server thread
+		std::map <int, ofxLeapMotionWebSocketClient *> clients;
+		std::shared_ptr <const string> current;
+		
+		std::atomic <int> numClients;
+		std::atomic <uint64_t> numDropped;
+};
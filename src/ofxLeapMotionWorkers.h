@@ -0,0 +1,142 @@
+//ofxLeapMotionWorkers - a few long lived threads for work that is split up the same way every frame
+//run() hands the indices 0 to count-1 out to the workers and the calling thread and returns once all are done,
+//so the per frame cost is a wake up and a wait instead of creating and joining threads.
+//only one run() at a time - give each user its own workers.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+class ofxLeapMotionWorkers{
+	
+	public:
+		
+		ofxLeapMotionWorkers()
+			:numThreads(0)
+			,bRunning(false)
+			,generation(0)
+			,job(NULL)
+			,count(0)
+			,next(0)
+			,numBusy(0){
+		}
+		
+		~ofxLeapMotionWorkers(){
+			stop();
+		}
+		
+		//threads besides the calling one - they are started by the first run() after a change
+		void setNumThreads(int num){
+			num = std::max(0, num);
+			if( num != numThreads ){
+				stop();
+				numThreads = num;
+			}
+		}
+		
+		int getNumThreads() const{
+			return numThreads;
+		}
+		
+		void run(int num, const std::function <void(int)> & function){
+			if( numThreads == 0 || num <= 1 ){
+				for(int i = 0; i < num; i++){
+					function(i);
+				}
+				return;
+			}
+			
+			start();
+			{
+				std::unique_lock <std::mutex> lock(mutex);
+				job = &function;
+				count = num;
+				next = 0;
+				numBusy = threads.size();
+				generation++;
+			}
+			condition.notify_all();
+			
+			work();
+			
+			std::unique_lock <std::mutex> lock(mutex);
+			finished.wait(lock, [this](){ return numBusy == 0; });
+			job = NULL;
+		}
+		
+		void stop(){
+			if( threads.empty() ){
+				return;
+			}
+			{
+				std::unique_lock <std::mutex> lock(mutex);
+				bRunning = false;
+			}
+			condition.notify_all();
+			for(size_t i = 0; i < threads.size(); i++){
+				threads[i].join();
+			}
+			threads.clear();
+		}
+	
+	protected:
+		
+		void start(){
+			if( !threads.empty() ){
+				return;
+			}
+			bRunning = true;
+			for(int i = 0; i < numThreads; i++){
+				threads.push_back( std::thread(&ofxLeapMotionWorkers::threadedFunction, this, generation) );
+			}
+		}
+		
+		void work(){
+			for(int i = next++; i < count; i = next++){
+				(*job)(i);
+			}
+		}
+		
+		void threadedFunction(uint64_t seen){
+			while( true ){
+				{
+					std::unique_lock <std::mutex> lock(mutex);
+					condition.wait(lock, [&](){ return !bRunning || generation != seen; });
+					if( !bRunning ){
+						return;
+					}
+					seen = generation;
+				}
+				
+				work();
+				
+				{
+					std::unique_lock <std::mutex> lock(mutex);
+					numBusy--;
+				}
+				finished.notify_one();
+			}
+		}
+		
+		int numThreads;
+		std::vector <std::thread> threads;
+		
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::condition_variable finished;
+		bool bRunning;
+		uint64_t generation;
+		
+		//the current run() - set under the mutex before the workers are woken
+		const std::function <void(int)> * job;
+		int count;
+		std::atomic <int> next;
+		int numBusy;
+};
@@ -0,0 +1,545 @@
+#include "ofxLeapFake.h"
+#include "Leap.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace{
+	std::atomic <uint64_t> connectDelay(0);
+	std::atomic <uint64_t> frameInterval(1000);
+	std::atomic <int64_t> numFrames(0);
+	std::atomic <int> numControllers(0);
+}
+
+//--------------------------------------------------------------
+void ofxLeapFake::setup(uint64_t connectDelayMicros, uint64_t frameIntervalMicros){
+	connectDelay = connectDelayMicros;
+	frameInterval = frameIntervalMicros;
+}
+
+//--------------------------------------------------------------
+int64_t ofxLeapFake::getNumFrames(){
+	return numFrames;
+}
+
+//--------------------------------------------------------------
+int ofxLeapFake::getNumControllers(){
+	return numControllers;
+}
+
+namespace Leap{
+
+//what every Leap object points to - counted so copies share it, like the real handles
+class SharedObject{
+	
+	public:
+		
+		SharedObject():refs(1){}
+		virtual ~SharedObject(){}
+		
+		std::atomic <int> refs;
+};
+
+//a frame is only its id - the hands follow from it
+struct FakeFrame : public SharedObject{
+	int64_t id;
+};
+
+struct FakeHand : public SharedObject{
+	int64_t frameId;
+	int32_t id;
+};
+
+struct FakeFinger : public SharedObject{
+	int64_t frameId;
+	int32_t handId;
+	int index;
+};
+
+//the service connection and the thread calling the listener
+struct FakeController : public SharedObject{
+	FakeController()
+		:owner(NULL)
+		,listener(NULL)
+		,bRunning(false)
+		,bConnected(false)
+		,frameId(0){
+	}
+	
+	const Controller * owner;
+	Listener * listener;
+	std::mutex listenerMutex;
+	std::thread thread;
+	std::mutex runningMutex;
+	std::condition_variable runningCondition;
+	std::atomic <bool> bRunning;
+	std::atomic <bool> bConnected;
+	std::atomic <int64_t> frameId;
+	uint64_t connectDelay;
+	uint64_t frameInterval;
+};
+
+//gives the fake access to the handle of each type
+template <class T>
+struct Handle : public T{
+	Handle(SharedObject * object){
+		if( this->m_object ){
+			if( --this->m_object->refs == 0 ){
+				delete this->m_object;
+			}
+		}
+		this->m_object = object;
+	}
+};
+
+//--------------------------------------------------------------
+template <class T>
+static T makeHandle(SharedObject * object){
+	return Handle <T> (object);
+}
+
+//--------------------------------------------------------------
+static SharedObject * share(SharedObject * object){
+	object->refs++;
+	return object;
+}
+
+//the palm moves along x with the frame id and the fingers spread around it - like makeTestHand()
+//--------------------------------------------------------------
+static float getTime(int64_t frameId){
+	return (frameId % 100) / 100.0f;
+}
+
+//--------------------------------------------------------------
+static Vector getPalm(int64_t frameId, int32_t handId){
+	return Vector(-100 + 200 * getTime(frameId) + handId * 50, 200, 0);
+}
+
+// Interface
+//--------------------------------------------------------------
+Interface::Interface(void * owner):m_object(NULL){
+}
+
+//--------------------------------------------------------------
+Interface::Interface(Implementation * reference, void * owner):m_object(NULL){
+}
+
+//--------------------------------------------------------------
+Interface::Interface(SharedObject * object):m_object(object){
+}
+
+//--------------------------------------------------------------
+Interface::Interface(const Interface & rhs):m_object(rhs.m_object){
+	if( m_object ){
+		m_object->refs++;
+	}
+}
+
+//--------------------------------------------------------------
+Interface & Interface::operator=(const Interface & rhs){
+	if( rhs.m_object ){
+		rhs.m_object->refs++;
+	}
+	if( m_object && --m_object->refs == 0 ){
+		delete m_object;
+	}
+	m_object = rhs.m_object;
+	return *this;
+}
+
+//--------------------------------------------------------------
+Interface::~Interface(){
+	if( m_object && --m_object->refs == 0 ){
+		delete m_object;
+	}
+}
+
+//--------------------------------------------------------------
+Interface::Implementation * Interface::reference() const{
+	return NULL;
+}
+
+//--------------------------------------------------------------
+void Interface::deleteCString(const char * cstr){
+	delete [] cstr;
+}
+
+// Controller
+//--------------------------------------------------------------
+Controller::Controller():Interface(new FakeController()){
+	FakeController * controller = (FakeController *)m_object;
+	controller->owner = this;
+	controller->connectDelay = connectDelay;
+	controller->frameInterval = frameInterval;
+	numControllers++;
+}
+
+//--------------------------------------------------------------
+Controller::~Controller(){
+	//the listener gets copies of the controller - only the one the app made stops the service thread
+	FakeController * controller = (FakeController *)m_object;
+	if( controller->owner == this ){
+		controller->runningMutex.lock();
+			controller->bRunning = false;
+		controller->runningMutex.unlock();
+		controller->runningCondition.notify_all();
+		if( controller->thread.joinable() ){
+			controller->thread.join();
+		}
+		numControllers--;
+	}
+}
+
+//the waits end early when the controller is deleted - so close() isn't timed waiting for the fake
+//--------------------------------------------------------------
+static bool waitUntil(FakeController * controller, std::chrono::steady_clock::time_point time){
+	std::unique_lock <std::mutex> lock(controller->runningMutex);
+	controller->runningCondition.wait_until(lock, time, [controller](){ return !controller->bRunning; });
+	return controller->bRunning;
+}
+
+//the pretend service - connects after the delay, then a frame every interval until the controller is deleted
+//--------------------------------------------------------------
+static void runService(FakeController * controller, Controller handle){
+	std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now() + std::chrono::microseconds(controller->connectDelay);
+	if( !waitUntil(controller, next) ){
+		return;
+	}
+	
+	bool bConnectSent = false;
+	while( controller->bRunning ){
+		//the real service can call a listener that is being removed - the listener has to cope with that
+		Listener * listener;
+		controller->listenerMutex.lock();
+			listener = controller->listener;
+		controller->listenerMutex.unlock();
+		
+		if( listener ){
+			if( !bConnectSent ){
+				controller->bConnected = true;
+				listener->onServiceConnect(handle);
+				listener->onConnect(handle);
+				bConnectSent = true;
+			}
+			controller->frameId++;
+			numFrames++;
+			listener->onFrame(handle);
+		}
+		
+		next += std::chrono::microseconds(controller->frameInterval);
+		waitUntil(controller, next);
+	}
+}
+
+//--------------------------------------------------------------
+bool Controller::addListener(Listener & listener){
+	FakeController * controller = (FakeController *)m_object;
+	controller->listenerMutex.lock();
+		controller->listener = &listener;
+	controller->listenerMutex.unlock();
+	
+	if( !controller->thread.joinable() ){
+		controller->bRunning = true;
+		controller->thread = std::thread(runService, controller, *this);
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+bool Controller::removeListener(Listener & listener){
+	FakeController * controller = (FakeController *)m_object;
+	std::lock_guard <std::mutex> lock(controller->listenerMutex);
+	if( controller->listener == &listener ){
+		controller->listener = NULL;
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+Frame Controller::frame(int history) const{
+	FakeFrame * frame = new FakeFrame();
+	frame->id = ((FakeController *)m_object)->frameId - history;
+	return makeHandle <Frame> (frame);
+}
+
+//--------------------------------------------------------------
+bool Controller::isConnected() const{
+	return ((FakeController *)m_object)->bConnected;
+}
+
+//--------------------------------------------------------------
+bool Controller::isServiceConnected() const{
+	return ((FakeController *)m_object)->bConnected;
+}
+
+//--------------------------------------------------------------
+void Controller::enableGesture(Gesture::Type type, bool enable) const{
+}
+
+//--------------------------------------------------------------
+void Controller::setPolicyFlags(PolicyFlag flags) const{
+}
+
+// Frame
+//--------------------------------------------------------------
+Frame::Frame():Interface((SharedObject *)NULL){
+}
+
+//--------------------------------------------------------------
+int64_t Frame::id() const{
+	return m_object ? ((FakeFrame *)m_object)->id : -1;
+}
+
+//--------------------------------------------------------------
+int64_t Frame::timestamp() const{
+	return m_object ? ((FakeFrame *)m_object)->id * 8000 : 0;
+}
+
+//--------------------------------------------------------------
+bool Frame::isValid() const{
+	return m_object != NULL;
+}
+
+//--------------------------------------------------------------
+bool Frame::operator==(const Frame & frame) const{
+	return id() == frame.id();
+}
+
+//--------------------------------------------------------------
+HandList Frame::hands() const{
+	return m_object ? makeHandle <HandList> (share(m_object)) : HandList();
+}
+
+//--------------------------------------------------------------
+ToolList Frame::tools() const{
+	return ToolList();
+}
+
+//--------------------------------------------------------------
+ImageList Frame::images() const{
+	return ImageList();
+}
+
+//--------------------------------------------------------------
+GestureList Frame::gestures() const{
+	return GestureList();
+}
+
+//--------------------------------------------------------------
+GestureList Frame::gestures(const Frame & sinceFrame) const{
+	return GestureList();
+}
+
+//--------------------------------------------------------------
+InteractionBox Frame::interactionBox() const{
+	return InteractionBox();
+}
+
+// lists
+//--------------------------------------------------------------
+HandList::HandList():Interface((SharedObject *)NULL){
+}
+
+//--------------------------------------------------------------
+int HandList::count() const{
+	return m_object ? ((FakeFrame *)m_object)->id % 3 : 0;
+}
+
+//--------------------------------------------------------------
+Hand HandList::operator[](int index) const{
+	FakeHand * hand = new FakeHand();
+	hand->frameId = ((FakeFrame *)m_object)->id;
+	hand->id = index + 1;
+	return makeHandle <Hand> (hand);
+}
+
+//--------------------------------------------------------------
+FingerList::FingerList():Interface((SharedObject *)NULL){
+}
+
+//--------------------------------------------------------------
+int FingerList::count() const{
+	return m_object ? 5 : 0;
+}
+
+//--------------------------------------------------------------
+Finger FingerList::operator[](int index) const{
+	FakeFinger * finger = new FakeFinger();
+	finger->frameId = ((FakeHand *)m_object)->frameId;
+	finger->handId = ((FakeHand *)m_object)->id;
+	finger->index = index;
+	return makeHandle <Finger> (finger);
+}
+
+//--------------------------------------------------------------
+ToolList::ToolList():Interface((SharedObject *)NULL){
+}
+
+//--------------------------------------------------------------
+int ToolList::count() const{
+	return 0;
+}
+
+//--------------------------------------------------------------
+Tool ToolList::operator[](int index) const{
+	return Tool();
+}
+
+//--------------------------------------------------------------
+ImageList::ImageList():Interface((SharedObject *)NULL){
+}
+
+//--------------------------------------------------------------
+int ImageList::count() const{
+	return 0;
+}
+
+//--------------------------------------------------------------
+Image ImageList::operator[](int index) const{
+	return Image();
+}
+
+//--------------------------------------------------------------
+GestureList::GestureList():Interface((SharedObject *)NULL){
+}
+
+//--------------------------------------------------------------
+int GestureList::count() const{
+	return 0;
+}
+
+//--------------------------------------------------------------
+Gesture GestureList::operator[](int index) const{
+	return Gesture();
+}
+
+// InteractionBox - never valid, so the mapping keeps its default box
+//--------------------------------------------------------------
+InteractionBox::InteractionBox():Interface((SharedObject *)NULL){
+}
+
+bool InteractionBox::isValid() const{ return false; }
+Vector InteractionBox::center() const{ return Vector(); }
+float InteractionBox::width() const{ return 0; }
+float InteractionBox::height() const{ return 0; }
+float InteractionBox::depth() const{ return 0; }
+
+// Hand
+//--------------------------------------------------------------
+Hand::Hand():Interface((SharedObject *)NULL){
+}
+
+//--------------------------------------------------------------
+static const FakeHand & getHand(SharedObject * object){
+	return *(FakeHand *)object;
+}
+
+bool Hand::isValid() const{ return m_object != NULL; }
+int32_t Hand::id() const{ return m_object ? getHand(m_object).id : -1; }
+Vector Hand::palmPosition() const{ return getPalm(getHand(m_object).frameId, getHand(m_object).id); }
+Vector Hand::palmVelocity() const{ return Vector(200, 0, 0); }
+Vector Hand::palmNormal() const{ return Vector(0, -1, 0); }
+Vector Hand::direction() const{ return Vector(0, 0, -1); }
+Vector Hand::sphereCenter() const{ return palmPosition() + Vector(0, 40, 0); }
+float Hand::sphereRadius() const{ return 60; }
+float Hand::palmWidth() const{ return 80; }
+float Hand::confidence() const{ return 1; }
+float Hand::pinchStrength() const{ return 0; }
+float Hand::grabStrength() const{ return 0; }
+float Hand::timeVisible() const{ return getHand(m_object).frameId * 0.008f; }
+bool Hand::isLeft() const{ return false; }
+
+//--------------------------------------------------------------
+FingerList Hand::fingers() const{
+	return m_object ? makeHandle <FingerList> (share(m_object)) : FingerList();
+}
+
+// Pointable / Finger / Tool
+//--------------------------------------------------------------
+Pointable::Pointable():Interface((SharedObject *)NULL){
+}
+
+//--------------------------------------------------------------
+Finger::Finger(){
+}
+
+//--------------------------------------------------------------
+Tool::Tool(){
+}
+
+//--------------------------------------------------------------
+static const FakeFinger & getFinger(SharedObject * object){
+	return *(FakeFinger *)object;
+}
+
+//--------------------------------------------------------------
+Vector Pointable::tipPosition() const{
+	const FakeFinger & finger = getFinger(m_object);
+	float t = getTime(finger.frameId);
+	return getPalm(finger.frameId, finger.handId) + Vector(-40 + finger.index * 20, 10, -60 - 20 * t);
+}
+
+int32_t Pointable::id() const{ return m_object ? getFinger(m_object).handId * 10 + getFinger(m_object).index : -1; }
+Vector Pointable::tipVelocity() const{ return Vector(200, 0, 0); }
+Vector Pointable::direction() const{ return Vector(0, 0, -1); }
+float Pointable::length() const{ return 50; }
+float Pointable::width() const{ return 16; }
+float Pointable::timeVisible() const{ return 0; }
+float Pointable::touchDistance() const{ return 1; }
+Pointable::Zone Pointable::touchZone() const{ return ZONE_NONE; }
+Hand Pointable::hand() const{ return Hand(); }
+
+// Image - there are none
+//--------------------------------------------------------------
+Image::Image():Interface((SharedObject *)NULL){
+}
+
+int32_t Image::id() const{ return -1; }
+const unsigned char * Image::data() const{ return NULL; }
+const float * Image::distortion() const{ return NULL; }
+int Image::width() const{ return 0; }
+int Image::height() const{ return 0; }
+int Image::distortionWidth() const{ return 0; }
+int Image::distortionHeight() const{ return 0; }
+
+// Gesture - there are none
+//--------------------------------------------------------------
+Gesture::Gesture():Interface((SharedObject *)NULL){
+}
+
+//--------------------------------------------------------------
+Gesture::Gesture(const Gesture & rhs):Interface(rhs){
+}
+
+int32_t Gesture::id() const{ return -1; }
+Gesture::Type Gesture::type() const{ return TYPE_INVALID; }
+Gesture::State Gesture::state() const{ return STATE_INVALID; }
+int64_t Gesture::duration() const{ return 0; }
+float Gesture::durationSeconds() const{ return 0; }
+
+SwipeGesture::SwipeGesture(const Gesture & rhs):Gesture(rhs){}
+Vector SwipeGesture::startPosition() const{ return Vector(); }
+Vector SwipeGesture::position() const{ return Vector(); }
+Vector SwipeGesture::direction() const{ return Vector(); }
+float SwipeGesture::speed() const{ return 0; }
+
+CircleGesture::CircleGesture(const Gesture & rhs):Gesture(rhs){}
+Vector CircleGesture::center() const{ return Vector(); }
+Vector CircleGesture::normal() const{ return Vector(); }
+float CircleGesture::progress() const{ return 0; }
+float CircleGesture::radius() const{ return 0; }
+
+ScreenTapGesture::ScreenTapGesture(const Gesture & rhs):Gesture(rhs){}
+Vector ScreenTapGesture::position() const{ return Vector(); }
+Vector ScreenTapGesture::direction() const{ return Vector(); }
+float ScreenTapGesture::progress() const{ return 0; }
+
+KeyTapGesture::KeyTapGesture(const Gesture & rhs):Gesture(rhs){}
+Vector KeyTapGesture::position() const{ return Vector(); }
+Vector KeyTapGesture::direction() const{ return Vector(); }
+float KeyTapGesture::progress() const{ return 0; }
+
+}
@@ -0,0 +1,24 @@
+//ofxLeapFake - a stand in for libLeap so the tests run without a device or the Leap service
+//
+//the tests project compiles ofxLeapFake.cpp in - its Leap:: definitions are linked ahead of the addon's libLeap.so
+//(see config.make). a Leap::Controller connects to a pretend service after a fixed delay and then calls the
+//listener's onFrame() from its own thread, like the service does. the frames have the hands makeTestFrame() makes:
+//id % 3 hands of 5 fingers, timestamp id * 8000 - ids start from 1 for each controller
+//
+//note: linux and osx only - on windows libLeap's symbols are imported and can't be replaced this way
+
+#pragma once
+
+#include <stdint.h>
+
+namespace ofxLeapFake{
+	
+	//applies to controllers created afterwards - the defaults are to connect straight away and send 1000 frames a second
+	void setup(uint64_t connectDelayMicros = 0, uint64_t frameIntervalMicros = 1000);
+	
+	//onFrame() calls made by every controller so far - counted as they start
+	int64_t getNumFrames();
+	
+	//controllers that are still alive
+	int getNumControllers();
+}
@@ -0,0 +1,48 @@
+#include "tests.h"
+#include "ofxStrip.h"
+
+//ofxStrip::generate with speed based widths - the taper the example draws the finger trails with
+//--------------------------------------------------------------
+void benchStrip(){
+	const int numTrails = 20;
+	const int numPts = 200;
+	
+	vector < vector <ofPoint> > trails(numTrails);
+	for(int i = 0; i < numTrails; i++){
+		for(int j = 0; j < numPts; j++){
+			float t = j / (float)numPts;
+			trails[i].push_back( ofPoint(cos(t * 12 + i) * 200, sin(t * 9 + i) * 150, t * 50) );
+		}
+	}
+	
+	ofxStrip strip;
+	vector <float> widths;
+	
+	//the widths must taper from slow to fast points
+	ofxStrip::getWidthsFromSpeed(trails[0], 2, 10, 20, widths);
+	LEAP_CHECK( widths.size() == numPts );
+	LEAP_CHECK( widths[0] == 10 );
+	strip.generate(trails[0], widths, ofPoint(0, 0, 1));
+	LEAP_CHECK( strip.mesh.getVertices().size() == numPts * 2 );
+	
+	double micros = ofxLeapTest::bench([&](){
+		for(int i = 0; i < numTrails; i++){
+			ofxStrip::getWidthsFromSpeed(trails[i], 2, 10, 20, widths);
+			strip.generate(trails[i], widths, ofPoint(0, 0, 1));
+		}
+	});
+	
+	ofxLeapTest::report("20 trails x 200 points", micros, "us per frame");
+	ofxLeapTest::report("segments", numTrails * (numPts - 1) * 1000.0 / micros, "per ms");
+	
+	ofxStripBatch batch;
+	micros = ofxLeapTest::bench([&](){
+		batch.begin();
+		for(int i = 0; i < numTrails; i++){
+			ofxStrip::getWidthsFromSpeed(trails[i], 2, 10, 20, widths);
+			batch.add(trails[i], widths, ofPoint(0, 0, 1), ofFloatColor(1, 1, 1));
+		}
+	});
+	
+	ofxLeapTest::report("batched 20 trails x 200 points", micros, "us per frame");
+}
@@ -0,0 +1,164 @@
+#include "ofMain.h"
+#include "tests.h"
+
+#include <chrono>
+
+int ofxLeapTest::numChecks = 0;
+int ofxLeapTest::numFailed = 0;
+bool ofxLeapTest::bUpdateGolden = false;
+
+//--------------------------------------------------------------
+void ofxLeapTest::check(bool bPassed, const char * expression, const char * file, int line){
+	numChecks++;
+	if( !bPassed ){
+		numFailed++;
+		cout << "FAILED: " << expression << " - " << file << ":" << line << endl;
+	}
+}
+
+//--------------------------------------------------------------
+double ofxLeapTest::bench(std::function <void()> function, double seconds){
+	typedef std::chrono::steady_clock clock;
+	
+	//warm up caches and scratch buffers first
+	function();
+	
+	int numCalls = 0;
+	clock::time_point start = clock::now();
+	double elapsed = 0;
+	while( elapsed < seconds ){
+		for(int i = 0; i < 10; i++){
+			function();
+		}
+		numCalls += 10;
+		elapsed = std::chrono::duration <double> (clock::now() - start).count();
+	}
+	return elapsed * 1000000.0 / numCalls;
+}
+
+//--------------------------------------------------------------
+void ofxLeapTest::report(string name, double value, string unit){
+	cout << "  " << name << ": " << value << " " << unit << endl;
+}
+
+//--------------------------------------------------------------
+ofxLeapMotionSimpleHand makeTestHand(int64_t id, float t){
+	ofxLeapMotionSimpleHand hand;
+	hand.id = id;
+	hand.handPos.set(-100 + 200 * t + id * 50, 200, 0);
+	hand.handNormal.set(0, -1, 0);
+	hand.handDirection.set(0, 0, -1);
+	hand.handVelocity.set(200, 0, 0);
+	hand.sphereCenter = hand.handPos + ofPoint(0, 40, 0);
+	hand.sphereRadius = 60;
+	hand.palmWidth = 80;
+	
+	for(int i = 0; i < 5; i++){
+		ofxLeapMotionSimpleHand::simpleFinger finger;
+		finger.id = id * 10 + i;
+		finger.pos = hand.handPos + ofPoint(-40 + i * 20, 10, -60 - 20 * t);
+		finger.vel = hand.handVelocity;
+		finger.base = hand.handPos + ofPoint(-40 + i * 20, 0, -20);
+		hand.fingers.push_back(finger);
+	}
+	
+	return hand;
+}
+
+//--------------------------------------------------------------
+ofxLeapMotionSimpleFrame makeTestFrame(int64_t id, int numHands){
+	ofxLeapMotionSimpleFrame frame;
+	frame.id = id;
+	frame.timestamp = id * 8000;
+	for(int i = 0; i < numHands; i++){
+		frame.hands.push_back( makeTestHand(i + 1, (id % 100) / 100.0) );
+	}
+	return frame;
+}
+
+//--------------------------------------------------------------
+ofxLeapMotionImage makeTestImage(int camera, int width, int height, const vector <ofPoint> & dots){
+	std::shared_ptr <ofxLeapMotionDistortion> distortion(new ofxLeapMotionDistortion());
+	distortion->width = 128;
+	distortion->height = 64;
+	distortion->version = 1;
+	for(int y = 0; y < 64; y++){
+		for(int x = 0; x < 64; x++){
+			float dx = x / 63.0 - 0.5;
+			float dy = y / 63.0 - 0.5;
+			float k = 1.0 - 0.2 * (dx * dx + dy * dy);
+			distortion->map.push_back(0.5 + dx * 1.2 * k);
+			distortion->map.push_back(0.5 + dy * 1.2 * k);
+		}
+	}
+	
+	ofxLeapMotionImage image;
+	image.cameraId = camera;
+	image.frameId = 1;
+	image.distortion = distortion;
+	image.pixels.allocate(width, height, OF_IMAGE_GRAYSCALE);
+	unsigned char * pix = image.pixels.getData();
+	for(int y = 0; y < height; y++){
+		for(int x = 0; x < width; x++){
+			unsigned char v = (x * 7 + y * 3) % 40;
+			for(int i = 0; i < dots.size(); i++){
+				if( ofDist(x, y, dots[i].x, dots[i].y) < 4 ){
+					v = 255;
+				}
+			}
+			pix[y * width + x] = v;
+		}
+	}
+	return image;
+}
+
+//========================================================================
+int main(int argc, char * argv[]){
+	bool bBench = false;
+	for(int i = 1; i < argc; i++){
+		string arg = argv[i];
+		if( arg == "bench" ){
+			bBench = true;
+		}else if( arg == "golden" ){
+			ofxLeapTest::bUpdateGolden = true;
+		}
+	}
+	
+	testUndistort();
+	testBlobTracker();
+	testRecorder();
+	testColumnExporter();
+	testShared();
+	testWebSocket();
+	testOsc();
+	testFusion();
+	testFrameStress();
+	testStartup();
+	testWatchdog();
+	testOpenClose();
+	testInteraction();
+	testReplay();
+	testInterpolation();
+	
+	if( bBench ){
+		cout << "strip" << endl;
+		benchStrip();
+		cout << "undistort" << endl;
+		benchUndistort();
+		cout << "blob tracker" << endl;
+		benchBlobTracker();
+		cout << "recorder" << endl;
+		benchRecorder();
+		cout << "startup" << endl;
+		benchStartup();
+		cout << "interaction" << endl;
+		benchInteraction();
+		cout << "interpolation" << endl;
+		benchInterpolation();
+		cout << "websocket" << endl;
+		benchWebSocket();
+	}
+	
+	cout << ofxLeapTest::numChecks - ofxLeapTest::numFailed << " / " << ofxLeapTest::numChecks << " checks passed" << endl;
+	return ofxLeapTest::numFailed ? 1 : 0;
+}
@@ -0,0 +1,46 @@
+#include "tests.h"
+#include "ofxLeapMotionBlobTracker.h"
+
+//--------------------------------------------------------------
+static void makeStereoPair(int numDots, ofxLeapMotionImage & left, ofxLeapMotionImage & right){
+	vector <ofPoint> leftDots, rightDots;
+	for(int i = 0; i < numDots; i++){
+		float y = 60 + i * 120.0 / MAX(1, numDots - 1);
+		leftDots.push_back(ofPoint(340, y));
+		rightDots.push_back(ofPoint(300, y));
+	}
+	left = makeTestImage(0, 640, 240, leftDots);
+	right = makeTestImage(1, 640, 240, rightDots);
+}
+
+//the same dot a little further right in the left camera is one point in front of the cameras
+//--------------------------------------------------------------
+void testBlobTracker(){
+	ofxLeapMotionImage left, right;
+	makeStereoPair(1, left, right);
+	
+	ofxLeapMotionBlobTracker tracker;
+	for(int i = 0; i < 20; i++){
+		LEAP_CHECK( tracker.update(left, right) );
+		LEAP_CHECK( tracker.getBlobs(0).size() == 1 );
+		LEAP_CHECK( tracker.getBlobs(1).size() == 1 );
+		LEAP_CHECK( tracker.getPoints().size() == 1 );
+	}
+	LEAP_CHECK( tracker.getPoints()[0].y > 0 );
+	
+	//a camera without a distortion map yet gives nothing
+	LEAP_CHECK( !tracker.update(left, ofxLeapMotionImage()) );
+	LEAP_CHECK( tracker.getPoints().empty() );
+}
+
+//--------------------------------------------------------------
+void benchBlobTracker(){
+	ofxLeapMotionImage left, right;
+	makeStereoPair(4, left, right);
+	
+	ofxLeapMotionBlobTracker tracker;
+	double micros = ofxLeapTest::bench([&](){
+		tracker.update(left, right);
+	});
+	ofxLeapTest::report("400x400 stereo pair, 4 dots", micros, "us per update");
+}
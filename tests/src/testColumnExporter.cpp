@@ -0,0 +1,81 @@
+#include "tests.h"
+#include "ofxLeapMotionColumnExporter.h"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+static const string recordingPath = "test_columns.ofxleap";
+static const string outputDir = "test_columns";
+
+//--------------------------------------------------------------
+static bool fileExists(const string & path){
+	return std::ifstream(ofToDataPath(path).c_str()).good();
+}
+
+//--------------------------------------------------------------
+static vector <float> readFloatColumn(const string & name){
+	std::ifstream file(ofToDataPath(outputDir + "/" + name + ".bin").c_str(), std::ios::binary);
+	string data((std::istreambuf_iterator <char> (file)), std::istreambuf_iterator <char> ());
+	vector <float> values(data.size() / sizeof(float));
+	if( values.size() ){
+		memcpy(&values[0], data.data(), values.size() * sizeof(float));
+	}
+	return values;
+}
+
+//--------------------------------------------------------------
+void testColumnExporter(){
+	ofxLeapMotionRecorder recorder;
+	LEAP_CHECK( recorder.open(recordingPath, 8) );
+	for(int i = 0; i < 50; i++){
+		ofxLeapMotionSimpleFrame frame = makeTestFrame(i + 1, 2);
+		frame.hands[1].confidence = 0.5;
+		frame.hands[1].pinchStrength = i / 50.0;
+		frame.hands[1].grabStrength = 0.25;
+		recorder.addFrame(frame);
+	}
+	recorder.close();
+	
+	ofxLeapMotionColumnExporter exporter;
+	LEAP_CHECK( exporter.convert(recordingPath, outputDir) == 100 );
+	LEAP_CHECK( fileExists(outputDir + "/columns.txt") );
+	
+	std::ifstream palm(ofToDataPath(outputDir + "/palm_x.bin").c_str(), std::ios::binary | std::ios::ate);
+	LEAP_CHECK( palm.tellg() == 100 * sizeof(float) );
+	
+	//the hand extras of version 2 recordings - rows go frame by frame, hand by hand
+	vector <float> direction = readFloatColumn("direction_z");
+	vector <float> confidence = readFloatColumn("confidence");
+	vector <float> pinch = readFloatColumn("pinch");
+	vector <float> grab = readFloatColumn("grab");
+	LEAP_CHECK( direction.size() == 100 && confidence.size() == 100 && pinch.size() == 100 && grab.size() == 100 );
+	if( pinch.size() == 100 && confidence.size() == 100 && grab.size() == 100 && direction.size() == 100 ){
+		LEAP_CHECK( fabs(direction[0] + 1) < 0.001 && confidence[0] == 1 && pinch[0] == 0 && grab[0] == 0 );
+		LEAP_CHECK( fabs(confidence[21] - 0.5) < 0.001 && fabs(pinch[21] - 10 / 50.0) < 0.001 && fabs(grab[21] - 0.25) < 0.001 );
+	}
+	
+	//version 1 recordings don't have them - NaN like a missing finger
+	writeVersion1Recording(recordingPath);
+	LEAP_CHECK( exporter.convert(recordingPath, outputDir) == 1 );
+	vector <float> palmX = readFloatColumn("palm_x");
+	pinch = readFloatColumn("pinch");
+	direction = readFloatColumn("direction_x");
+	LEAP_CHECK( palmX.size() == 1 && pinch.size() == 1 && direction.size() == 1 );
+	if( palmX.size() == 1 && pinch.size() == 1 && direction.size() == 1 ){
+		LEAP_CHECK( fabs(palmX[0] - 10) < 0.001 && std::isnan(pinch[0]) && std::isnan(direction[0]) );
+	}
+	
+	//a file where the output folder should be - nothing can be opened so there must be no columns.txt
+	std::ofstream(ofToDataPath(outputDir + "_file").c_str()) << "not a folder";
+	LEAP_CHECK( exporter.convert(recordingPath, outputDir + "_file") == -1 );
+	LEAP_CHECK( !fileExists(outputDir + "_file/columns.txt") );
+	
+	//a recording that can't be loaded leaves the folder alone
+	LEAP_CHECK( exporter.convert("test_missing.ofxleap", outputDir) == -1 );
+	LEAP_CHECK( fileExists(outputDir + "/columns.txt") );
+	
+	ofFile::removeFile(recordingPath);
+	ofFile::removeFile(outputDir + "_file");
+	ofDirectory::removeDirectory(outputDir, true);
+}
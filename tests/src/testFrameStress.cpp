@@ -0,0 +1,135 @@
+#include "tests.h"
+#include "ofxLeapMotion.h"
+#include "ofxLeapFake.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+//frames like makeTestFrame() makes - the hands and timestamp follow from the id, so a torn frame shows up
+//--------------------------------------------------------------
+static bool isWholeFrame(const ofxLeapMotionSimpleFrame & frame){
+	if( frame.timestamp != frame.id * 8000 || frame.hands.size() != frame.id % 3 ){
+		return false;
+	}
+	for(int i = 0; i < frame.hands.size(); i++){
+		if( frame.hands[i].id != i + 1 || frame.hands[i].fingers.size() != 5 ){
+			return false;
+		}
+	}
+	return true;
+}
+
+//frames are published on one thread while others read them every way an app can - build with -fsanitize=thread
+//the fake Leap calls onFrame() from its own thread, so the frames take the same way live ones do: the Leap callback
+//hands them to the pipeline worker, which runs the stages and publishes
+//--------------------------------------------------------------
+void testFrameStress(){
+	const int numFrames = 20000;
+	
+	ofxLeapFake::setup(0, 100);
+	
+	ofxLeapMotion leap;
+	std::atomic <bool> bDone(false);
+	std::atomic <int> numBad(0);
+	std::atomic <int> numPolled(0);
+	int64_t numFramesBefore = ofxLeapFake::getNumFrames();
+	
+	//the mapping changes while the worker and the other threads map with it
+	std::thread writer([&](){
+		int i = 0;
+		while( !bDone ){
+			leap.setMappingX(-200, 200, 0, i++ % 2 ? 1024 : 1920);
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+		}
+	});
+	
+	//the single isFrameNew() state, frame ids only ever go forward
+	//the snapshot is published just before the id, so a frame can be one ahead of getCurrentFrameID() but never behind
+	std::thread polling([&](){
+		int64_t lastId = -1;
+		int64_t lastCurrentId = -1;
+		ofxLeapMotionSimpleFrame frame;
+		while( !bDone ){
+			//isFrameNew() is also true after open() until the first frame arrives - with nothing to get yet
+			if( leap.isFrameNew() && leap.getCurrentFrameID() > 0 ){
+				int64_t currentId = leap.getCurrentFrameID();
+				if( !leap.getSimpleFrame(frame) || !isWholeFrame(frame) || frame.id < lastId || frame.id < currentId ){
+					numBad++;
+				}
+				lastId = frame.id;
+				leap.markFrameAsOld();
+			}
+			int64_t currentId = leap.getCurrentFrameID();
+			if( currentId < lastCurrentId ){
+				numBad++;
+			}
+			lastCurrentId = currentId;
+		}
+	});
+	
+	//cursors see each frame at most once
+	std::thread cursors([&](){
+		ofxLeapMotionCursor cursor = leap.subscribe();
+		int64_t lastId = -1;
+		while( !bDone ){
+			std::shared_ptr <const ofxLeapMotionSimpleFrame> frame = cursor.poll();
+			if( frame ){
+				if( !isWholeFrame(*frame) || frame->id <= lastId ){
+					numBad++;
+				}
+				lastId = frame->id;
+				numPolled++;
+			}
+		}
+	});
+	
+	//mapped hands, snapshots, the interpolated history and mapping points from the app thread
+	std::thread hands([&](){
+		while( !bDone ){
+			vector <ofxLeapMotionSimpleHand> simpleHands = leap.getSimpleHands();
+			for(int i = 0; i < simpleHands.size(); i++){
+				if( simpleHands[i].fingers.size() != 5 ){
+					numBad++;
+				}
+			}
+			std::shared_ptr <const ofxLeapMotionSimpleFrame> snapshot = leap.getSimpleFrameSnapshot();
+			if( snapshot && !isWholeFrame(*snapshot) ){
+				numBad++;
+			}
+			leap.getSimpleHandsAt(leap.getCurrentFrameID() * 8000 - 4000);
+			
+			//only x is mapped - y comes through whichever mapping is current
+			ofxLeapMotionSimpleFrame frame;
+			if( leap.getSimpleFrame(frame) && frame.hands.size() ){
+				ofPoint pos = frame.hands[0].handPos;
+				if( leap.getMappedSimpleHand(frame.hands[0]).handPos.y != pos.y || leap.getMappedofPoint(pos).y != pos.y ){
+					numBad++;
+				}
+			}
+		}
+	});
+	
+	//until the Leap thread has sent enough frames - the worker drops the ones it can't keep up with
+	leap.open();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	while( ofxLeapFake::getNumFrames() - numFramesBefore < numFrames && std::chrono::steady_clock::now() - start < std::chrono::seconds(30) ){
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	int64_t lastId = leap.getCurrentFrameID();
+	ofxLeapMotionSimpleFrame lastFrame = leap.getSimpleFrame();
+	
+	bDone = true;
+	writer.join();
+	polling.join();
+	cursors.join();
+	hands.join();
+	leap.close();
+	ofxLeapFake::setup();
+	
+	LEAP_CHECK( numBad == 0 );
+	LEAP_CHECK( ofxLeapFake::getNumFrames() - numFramesBefore >= numFrames );
+	LEAP_CHECK( lastId > numFrames / 2 );
+	LEAP_CHECK( numPolled > 0 );
+	LEAP_CHECK( isWholeFrame(lastFrame) );
+}
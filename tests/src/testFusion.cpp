@@ -0,0 +1,152 @@
+#include "tests.h"
+#include "ofxLeapMotionFusion.h"
+
+//--------------------------------------------------------------
+static ofxLeapMotionSimpleFrame makeSourceFrame(int64_t id, float x, float confidence = 1){
+	ofxLeapMotionSimpleFrame frame = makeTestFrame(id, 1);
+	frame.hands[0].handPos.x = x;
+	frame.hands[0].confidence = confidence;
+	return frame;
+}
+
+//--------------------------------------------------------------
+void testFusion(){
+	ofxLeapMotionFrameSource a, b;
+	ofxLeapMotionFusion fusion;
+	fusion.addSource(&a);
+	fusion.addSource(&b);
+	fusion.setSourceTimeout(0.1);
+	
+	//hands far apart stay two hands
+	a.setFrame( makeSourceFrame(1, -300) );
+	b.setFrame( makeSourceFrame(1, 300) );
+	LEAP_CHECK( fusion.update() );
+	LEAP_CHECK( fusion.getSimpleFrame().hands.size() == 2 );
+	
+	//a stops sending - its hand stays until b is more than the timeout ahead
+	for(int i = 2; i < 12; i++){
+		b.setFrame( makeSourceFrame(i, 300) );
+		fusion.update();
+		LEAP_CHECK( fusion.getSimpleFrame().hands.size() == 2 );
+	}
+	for(int i = 12; i < 20; i++){
+		b.setFrame( makeSourceFrame(i, 300) );
+		fusion.update();
+	}
+	LEAP_CHECK( fusion.getSimpleFrame().hands.size() == 1 );
+	LEAP_CHECK( fusion.getSimpleFrame().hands[0].handPos.x == 300 );
+	
+	//and comes back with its next frame
+	a.setFrame( makeSourceFrame(20, -300) );
+	b.setFrame( makeSourceFrame(20, 300) );
+	LEAP_CHECK( fusion.update() );
+	LEAP_CHECK( fusion.getSimpleFrame().hands.size() == 2 );
+	
+	//a source with no frame at all drops out straight away
+	ofxLeapMotionSimpleFrame none;
+	none.id = -1;
+	a.setFrame(none);
+	LEAP_CHECK( fusion.update() );
+	LEAP_CHECK( fusion.getSimpleFrame().hands.size() == 1 );
+	LEAP_CHECK( !fusion.update() );
+	
+	//both sources see the same hand within the association distance - one hand, confidence weighted, that keeps its id
+	//while it moves. b's hand ids change every frame, the merged id mustn't
+	ofxLeapMotionFrameSource c, d;
+	ofxLeapMotionFusion both;
+	both.addSource(&c);
+	both.addSource(&d);
+	int64_t mergedId = -1;
+	for(int i = 1; i <= 10; i++){
+		c.setFrame( makeSourceFrame(i, 10 * i, 1) );
+		ofxLeapMotionSimpleFrame seen = makeSourceFrame(i, 10 * i + 30, 0.25);
+		seen.hands[0].id = 100 + i;
+		d.setFrame(seen);
+		LEAP_CHECK( both.update() );
+		
+		const ofxLeapMotionSimpleFrame & merged = both.getSimpleFrame();
+		LEAP_CHECK( merged.hands.size() == 1 );
+		if( merged.hands.size() != 1 ){
+			break;
+		}
+		
+		//(10i * 1 + (10i + 30) * 0.25) / 1.25
+		LEAP_CHECK( fabs(merged.hands[0].handPos.x - (10 * i + 6)) < 0.001 );
+		LEAP_CHECK( merged.hands[0].confidence == 1 );
+		if( i == 1 ){
+			mergedId = merged.hands[0].id;
+		}
+		LEAP_CHECK( merged.hands[0].id == mergedId );
+		LEAP_CHECK( merged.hands[0].fingers[0].id == mergedId * 10 );
+	}
+	
+	//just past the association distance they're two hands again - the closer one keeps the id
+	c.setFrame( makeSourceFrame(11, 100, 1) );
+	d.setFrame( makeSourceFrame(11, 181, 0.25) );
+	LEAP_CHECK( both.update() );
+	LEAP_CHECK( both.getSimpleFrame().hands.size() == 2 );
+	if( both.getSimpleFrame().hands.size() == 2 ){
+		LEAP_CHECK( both.getSimpleFrame().hands[0].handPos.x == 100 );
+		LEAP_CHECK( both.getSimpleFrame().hands[0].id == mergedId );
+		LEAP_CHECK( both.getSimpleFrame().hands[1].id != mergedId );
+	}
+	
+	//two hands close together from one source never merge with each other - d's hand joins the more confident one
+	ofxLeapMotionSimpleFrame pair = makeTestFrame(12, 2);
+	pair.hands[0].handPos.set(0, 200, 0);
+	pair.hands[0].confidence = 1;
+	pair.hands[1].handPos.set(20, 200, 0);
+	pair.hands[1].confidence = 0.9;
+	c.setFrame(pair);
+	ofxLeapMotionSimpleFrame between = makeSourceFrame(12, 10, 0.5);
+	between.hands[0].handPos.y = 200;
+	between.hands[0].handPos.z = 0;
+	d.setFrame(between);
+	LEAP_CHECK( both.update() );
+	LEAP_CHECK( both.getSimpleFrame().hands.size() == 2 );
+	if( both.getSimpleFrame().hands.size() == 2 ){
+		LEAP_CHECK( fabs(both.getSimpleFrame().hands[0].handPos.x - 10 / 3.0) < 0.001 );
+		LEAP_CHECK( both.getSimpleFrame().hands[1].handPos.x == 20 );
+	}
+	
+	//a source turned 90 degrees around y - the directions turn with it, only positions are moved
+	ofxLeapMotionFrameSource turned;
+	ofxLeapMotionFusion single;
+	single.addSource(&turned);
+	ofMatrix4x4 transform;
+	transform.makeRotationMatrix(90, 0, 1, 0);
+	transform.postMultTranslate(0, 0, 500);
+	single.setTransform(0, transform);
+	
+	ofxLeapMotionSimpleFrame frame = makeSourceFrame(1, 0);
+	frame.hands[0].translation.set(0, 0, -10);
+	ofMatrix4x4 palmTurn;
+	palmTurn.makeRotationMatrix(45, 1, 0, 0);
+	frame.hands[0].rotation = palmTurn.getRotate();
+	turned.setFrame(frame);
+	LEAP_CHECK( single.update() );
+	
+	const ofxLeapMotionSimpleHand & in = frame.hands[0];
+	ofxLeapMotionSimpleHand out = single.getSimpleFrame().hands[0];
+	ofQuaternion rotation = transform.getRotate();
+	LEAP_CHECK( out.handPos.distance(in.handPos * transform) < 0.001 );
+	LEAP_CHECK( out.handDirection.distance(rotation * in.handDirection) < 0.001 );
+	LEAP_CHECK( out.handDirection.distance(in.handDirection) > 1 );
+	LEAP_CHECK( out.handNormal.distance(rotation * in.handNormal) < 0.001 );
+	LEAP_CHECK( out.translation.distance(rotation * in.translation) < 0.001 );
+	
+	//the palm's turn around the device's x is a turn around the shared space's -z - turning a direction in the shared
+	//space must give what turning it on the device and then moving it over does
+	ofMatrix4x4 sharedTurn;
+	sharedTurn.makeRotationMatrix(45, 0, 0, -1);
+	ofQuaternion expected = sharedTurn.getRotate();
+	LEAP_CHECK( fabs(out.rotation.x() - expected.x()) < 0.001 && fabs(out.rotation.y() - expected.y()) < 0.001 );
+	LEAP_CHECK( fabs(out.rotation.z() - expected.z()) < 0.001 && fabs(out.rotation.w() - expected.w()) < 0.001 );
+	for(int i = 0; i < 3; i++){
+		ofPoint v(i == 0, i == 1, i == 2);
+		LEAP_CHECK( (out.rotation * (rotation * v)).distance(rotation * (in.rotation * v)) < 0.001 );
+	}
+	
+	//the palm to fingers direction still points from the palm towards the fingers
+	LEAP_CHECK( out.handDirection.dot(out.fingers[2].pos - out.handPos) > 0 );
+}
@@ -0,0 +1,133 @@
+#include "tests.h"
+#include "ofxLeapMotionInteraction.h"
+
+//a 100 x 100 grid of 16 x 16 buttons, 20 pixels apart - 10k targets over 2000 x 2000 pixels
+//--------------------------------------------------------------
+static void addButtons(ofxLeapMotionInteraction & interaction){
+	interaction.setCellSize(40);
+	for(int y = 0; y < 100; y++){
+		for(int x = 0; x < 100; x++){
+			interaction.addTarget(ofRectangle(x * 20, y * 20, 16, 16));
+		}
+	}
+}
+
+//4 hands of 5 fingertips spread over the buttons, pushing through the touch plane and back with t
+//--------------------------------------------------------------
+static vector <ofxLeapMotionSimpleHand> makeTouchHands(int frame){
+	vector <ofxLeapMotionSimpleHand> hands;
+	for(int i = 0; i < 4; i++){
+		ofxLeapMotionSimpleHand hand;
+		hand.id = i + 1;
+		for(int j = 0; j < 5; j++){
+			ofxLeapMotionSimpleHand::simpleFinger finger;
+			finger.id = hand.id * 10 + j;
+			finger.pos.set(100 + i * 450 + j * 37 + frame % 200, 300 + i * 400 + (frame * 3 + j * 11) % 300, 0);
+			finger.touchDistance = cos((frame + j * 7) * 0.1);
+			finger.touchZone = finger.touchDistance < 0 ? OFX_LEAP_TOUCH_TOUCHING : OFX_LEAP_TOUCH_HOVERING;
+			hand.fingers.push_back(finger);
+		}
+		hands.push_back(hand);
+	}
+	return hands;
+}
+
+//the grid must find the same target as testing every one of them
+//--------------------------------------------------------------
+void testInteraction(){
+	ofxLeapMotionInteraction interaction;
+	addButtons(interaction);
+	LEAP_CHECK( interaction.getNumTargets() == 10000 );
+	
+	//a button added on top of others wins where they overlap
+	vector <ofRectangle> rects;
+	for(int y = 0; y < 100; y++){
+		for(int x = 0; x < 100; x++){
+			rects.push_back( ofRectangle(x * 20, y * 20, 16, 16) );
+		}
+	}
+	rects.push_back( ofRectangle(500, 500, 100, 100) );
+	interaction.addTarget(rects.back());
+	
+	//points on a grid that doesn't line up with the buttons, a little past them on every side
+	int numWrong = 0;
+	for(float y = -50; y < 2050; y += 13.7){
+		for(float x = -50; x < 2050; x += 13.7){
+			int expected = -1;
+			for(int i = rects.size() - 1; i >= 0; i--){
+				if( x >= rects[i].getMinX() && x <= rects[i].getMaxX() && y >= rects[i].getMinY() && y <= rects[i].getMaxY() ){
+					expected = i;
+					break;
+				}
+			}
+			numWrong += interaction.getTargetAt(ofPoint(x, y)) != expected;
+		}
+	}
+	LEAP_CHECK( numWrong == 0 );
+	
+	//a press needs the fingertip to cross the touch plane over the button, and is released when it pulls back
+	ofxLeapMotionInteraction button;
+	int id = button.addTarget(ofRectangle(0, 0, 100, 100));
+	
+	vector <ofxLeapMotionSimpleHand> hands(1);
+	hands[0].id = 1;
+	hands[0].fingers.resize(1);
+	ofxLeapMotionSimpleHand::simpleFinger & finger = hands[0].fingers[0];
+	finger.id = 10;
+	finger.pos.set(50, 50, 0);
+	finger.touchDistance = 0.5;
+	finger.touchZone = OFX_LEAP_TOUCH_HOVERING;
+	
+	button.update(hands);
+	LEAP_CHECK( button.getEvents().size() == 1 && button.getEvents()[0].type == OFX_LEAP_TOUCH_ENTER );
+	LEAP_CHECK( button.isHovered(id) && !button.isPressed(id) );
+	
+	finger.touchDistance = -0.2;
+	finger.touchZone = OFX_LEAP_TOUCH_TOUCHING;
+	button.update(hands);
+	LEAP_CHECK( button.getEvents().size() == 1 && button.getEvents()[0].type == OFX_LEAP_TOUCH_PRESS );
+	LEAP_CHECK( button.isPressed(id) );
+	
+	finger.touchDistance = 0.5;
+	finger.touchZone = OFX_LEAP_TOUCH_HOVERING;
+	button.update(hands);
+	LEAP_CHECK( button.getEvents().size() == 1 && button.getEvents()[0].type == OFX_LEAP_TOUCH_RELEASE );
+	LEAP_CHECK( !button.isPressed(id) );
+	
+	hands.clear();
+	button.update(hands);
+	LEAP_CHECK( button.getEvents().size() == 1 && button.getEvents()[0].type == OFX_LEAP_TOUCH_EXIT );
+	LEAP_CHECK( !button.isHovered(id) );
+}
+
+//--------------------------------------------------------------
+void benchInteraction(){
+	ofxLeapMotionInteraction interaction;
+	addButtons(interaction);
+	
+	//the frames are made up front so only update() is timed
+	vector < vector <ofxLeapMotionSimpleHand> > frames;
+	for(int i = 0; i < 1000; i++){
+		frames.push_back( makeTouchHands(i) );
+	}
+	
+	int frame = 0;
+	int numEvents = 0;
+	double micros = ofxLeapTest::bench([&](){
+		interaction.update(frames[frame]);
+		numEvents += interaction.getEvents().size();
+		frame = (frame + 1) % frames.size();
+	});
+	LEAP_CHECK( numEvents > 0 );
+	
+	ofxLeapTest::report("10k targets x 20 fingertips", micros, "us per update");
+	
+	//moving a target marks the grid for a rebuild on the next update
+	micros = ofxLeapTest::bench([&](){
+		interaction.setTarget(0, ofRectangle(0, 0, 16, 16));
+		interaction.update(frames[frame]);
+		frame = (frame + 1) % frames.size();
+	}, 0.2);
+	
+	ofxLeapTest::report("10k targets x 20 fingertips, with a grid rebuild", micros, "us per update");
+}
@@ -0,0 +1,121 @@
+#include "tests.h"
+#include "ofxLeapMotion.h"
+
+//hand 1 moves and turns 90 degrees around x between the two frames, hand 2 is only in the first, hand 3 only in the
+//second
+//--------------------------------------------------------------
+static void replayTwoFrames(ofxLeapMotion & leap){
+	ofxLeapMotionSimpleFrame a = makeTestFrame(1, 2);
+	a.hands[0].handPos.set(0, 200, 0);
+	a.hands[0].handNormal.set(0, -1, 0);
+	a.hands[0].handDirection.set(0, 0, -1);
+	a.hands[0].fingers[0].pos.set(-40, 210, -60);
+	
+	ofxLeapMotionSimpleFrame b = makeTestFrame(2, 1);
+	b.hands[0].handPos.set(100, 200, 40);
+	b.hands[0].handNormal.set(0, 0, -1);
+	b.hands[0].handDirection.set(0, 1, 0);
+	b.hands[0].fingers[0].pos.set(60, 250, 40);
+	b.hands.push_back( makeTestHand(3, 0.5) );
+	
+	leap.replayFrame(a);
+	leap.replayFrame(b);
+}
+
+//--------------------------------------------------------------
+static const ofxLeapMotionSimpleHand * findHand(const ofxLeapMotionSimpleFrame & frame, int64_t id){
+	for(int i = 0; i < frame.hands.size(); i++){
+		if( frame.hands[i].id == id ){
+			return &frame.hands[i];
+		}
+	}
+	return NULL;
+}
+
+//--------------------------------------------------------------
+void testInterpolation(){
+	ofxLeapMotion leap;
+	ofxLeapMotionSimpleFrame frame;
+	LEAP_CHECK( !leap.getSimpleFrameAt(12000, frame) );
+	
+	replayTwoFrames(leap);
+	
+	//a quarter of the way - the first frame is the nearer one so hand 2 is still there and hand 3 isn't yet
+	LEAP_CHECK( leap.getSimpleFrameAt(10000, frame) );
+	LEAP_CHECK( frame.id == 1 );
+	LEAP_CHECK( frame.timestamp == 10000 );
+	LEAP_CHECK( frame.hands.size() == 2 );
+	LEAP_CHECK( findHand(frame, 2) != NULL );
+	LEAP_CHECK( findHand(frame, 3) == NULL );
+	
+	const ofxLeapMotionSimpleHand * hand = findHand(frame, 1);
+	LEAP_CHECK( hand != NULL );
+	if( hand ){
+		float s = sin(PI / 8), c = cos(PI / 8);
+		LEAP_CHECK( hand->handPos.distance(ofPoint(25, 200, 10)) < 0.001 );
+		LEAP_CHECK( hand->fingers[0].pos.distance(ofPoint(-15, 220, -35)) < 0.001 );
+		
+		//22.5 degrees of the turn - a normalized lerp would be 0.07 off here
+		LEAP_CHECK( hand->handNormal.distance(ofPoint(0, -c, -s)) < 0.001 );
+		LEAP_CHECK( hand->handDirection.distance(ofPoint(0, s, -c)) < 0.001 );
+		LEAP_CHECK( fabs(hand->handDirection.dot(hand->handNormal)) < 0.001 );
+	}
+	
+	//the hand only in the first frame is that frame's, untouched
+	ofxLeapMotionSimpleFrame a = makeTestFrame(1, 2);
+	hand = findHand(frame, 2);
+	if( hand ){
+		LEAP_CHECK( hand->handPos == a.hands[1].handPos );
+		LEAP_CHECK( hand->fingers[4].pos == a.hands[1].fingers[4].pos );
+	}
+	
+	//three quarters - now the second frame decides
+	LEAP_CHECK( leap.getSimpleFrameAt(14000, frame) );
+	LEAP_CHECK( frame.id == 2 );
+	LEAP_CHECK( frame.hands.size() == 2 );
+	LEAP_CHECK( findHand(frame, 2) == NULL );
+	LEAP_CHECK( findHand(frame, 3) != NULL );
+	
+	hand = findHand(frame, 1);
+	LEAP_CHECK( hand != NULL );
+	if( hand ){
+		float s = sin(3 * PI / 8), c = cos(3 * PI / 8);
+		LEAP_CHECK( hand->handPos.distance(ofPoint(75, 200, 30)) < 0.001 );
+		LEAP_CHECK( hand->fingers[0].pos.distance(ofPoint(35, 240, 15)) < 0.001 );
+		LEAP_CHECK( hand->handNormal.distance(ofPoint(0, -c, -s)) < 0.001 );
+		LEAP_CHECK( hand->handDirection.distance(ofPoint(0, s, -c)) < 0.001 );
+	}
+	
+	hand = findHand(frame, 3);
+	if( hand ){
+		LEAP_CHECK( hand->handPos == makeTestHand(3, 0.5).handPos );
+	}
+	
+	//outside the history it's the nearest frame, not an extrapolation
+	LEAP_CHECK( leap.getSimpleFrameAt(0, frame) );
+	LEAP_CHECK( frame.id == 1 && frame.hands.size() == 2 && frame.hands[0].handPos == ofPoint(0, 200, 0) );
+	LEAP_CHECK( leap.getSimpleFrameAt(100000, frame) );
+	LEAP_CHECK( frame.id == 2 && frame.hands[0].handPos == ofPoint(100, 200, 40) );
+}
+
+//--------------------------------------------------------------
+void benchInterpolation(){
+	ofxLeapMotion leap;
+	leap.setHistorySize(32);
+	for(int i = 1; i <= 32; i++){
+		leap.replayFrame( makeTestFrame(i, 2) );
+	}
+	
+	//anywhere within the history - the frame search and two hands of five fingers
+	int64_t timestamp = 8000;
+	int numHands = 0;
+	ofxLeapMotionSimpleFrame frame;
+	double micros = ofxLeapTest::bench([&](){
+		leap.getSimpleFrameAt(timestamp, frame);
+		numHands += frame.hands.size();
+		timestamp = 8000 + (timestamp + 1237) % (31 * 8000);
+	});
+	LEAP_CHECK( numHands > 0 );
+	
+	ofxLeapTest::report("getSimpleFrameAt, 32 frames of 2 hands", micros, "us per call");
+}
@@ -0,0 +1,77 @@
+#include "tests.h"
+#include "ofxLeapMotion.h"
+#include "ofxLeapFake.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+//open() and close() over and over while the app thread reads - build with -fsanitize=address to catch
+//callbacks running into a deleted controller or released buffers. the fake Leap connects straight away and sends
+//a frame every 500us, so most cycles close while onFrame() calls are arriving
+//--------------------------------------------------------------
+void testOpenClose(){
+	const int numCycles = 2000;
+	
+	ofxLeapFake::setup(0, 500);
+	
+	ofxLeapMotion leap;
+	std::atomic <bool> bDone(false);
+	std::atomic <int> numStates(0);
+	
+	leap.setConnectionCallback([&](ofxLeapMotionConnectionState state){
+		numStates++;
+	});
+	
+	//what an app's update() does every frame, while the connection comes and goes underneath it
+	std::thread reader([&](){
+		while( !bDone ){
+			leap.isFrameNew();
+			leap.getSimpleHands();
+			leap.getSimpleFrameSnapshot();
+			leap.getConnectionState();
+			leap.markFrameAsOld();
+		}
+	});
+	
+	int numClosed = 0;
+	int numWithFrames = 0;
+	for(int i = 0; i < numCycles; i++){
+		int64_t numFrames = ofxLeapFake::getNumFrames();
+		leap.open();
+		
+		//close straight away, while the controller is being made, and once callbacks are arriving
+		if( i % 3 == 1 ){
+			std::this_thread::yield();
+		}else if( i % 3 == 2 ){
+			std::this_thread::sleep_for(std::chrono::microseconds(2000));
+		}
+		
+		leap.close();
+		numClosed += leap.getConnectionState() == OFX_LEAP_CLOSED;
+		numWithFrames += ofxLeapFake::getNumFrames() > numFrames;
+	}
+	
+	bDone = true;
+	reader.join();
+	
+	LEAP_CHECK( numClosed == numCycles );
+	LEAP_CHECK( numStates > 0 );
+	
+	//the race this is here for only happens with callbacks arriving - and every controller must be gone again
+	LEAP_CHECK( numWithFrames > numCycles / 10 );
+	LEAP_CHECK( ofxLeapFake::getNumControllers() == 0 );
+	
+	//destroyed while open - the destructor closes
+	for(int i = 0; i < 200; i++){
+		ofxLeapMotion * other = new ofxLeapMotion();
+		other->open();
+		if( i % 2 ){
+			std::this_thread::sleep_for(std::chrono::microseconds(2000));
+		}
+		delete other;
+	}
+	LEAP_CHECK( ofxLeapFake::getNumControllers() == 0 );
+	
+	ofxLeapFake::setup();
+}
@@ -0,0 +1,138 @@
+#include "tests.h"
+#include "ofxLeapMotionOsc.h"
+
+static const int testPort = 19010;
+static const int rawPort = 19011;
+
+//polls until the receiver has the frame or the time is up
+//--------------------------------------------------------------
+static bool waitForFrame(ofxLeapMotionOscReceiver & receiver, int64_t id, int millis = 2000){
+	uint64_t end = ofGetElapsedTimeMillis() + millis;
+	while( receiver.getCurrentFrameID() != id ){
+		if( ofGetElapsedTimeMillis() > end ){
+			return false;
+		}
+		ofSleepMillis(1);
+	}
+	return true;
+}
+
+//the sender counts a bundle once send() returns - which can be after the receiver has it
+//--------------------------------------------------------------
+static bool waitForCount(ofxLeapMotionOscSender & sender, uint64_t count, int millis = 1000){
+	uint64_t end = ofGetElapsedTimeMillis() + millis;
+	while( sender.getNumSent() + sender.getNumCoalesced() < count ){
+		if( ofGetElapsedTimeMillis() > end ){
+			return false;
+		}
+		ofSleepMillis(1);
+	}
+	return true;
+}
+
+//everything the bundle carries must come back bit for bit - the floats are sent as their bytes
+//--------------------------------------------------------------
+static bool isSameFrame(const ofxLeapMotionSimpleFrame & a, const ofxLeapMotionSimpleFrame & b){
+	if( a.id != b.id || a.timestamp != b.timestamp || a.hands.size() != b.hands.size() ){
+		return false;
+	}
+	for(int i = 0; i < a.hands.size(); i++){
+		const ofxLeapMotionSimpleHand & ha = a.hands[i];
+		const ofxLeapMotionSimpleHand & hb = b.hands[i];
+		if( ha.id != hb.id || ha.handPos != hb.handPos || ha.handNormal != hb.handNormal || ha.handVelocity != hb.handVelocity ){
+			return false;
+		}
+		if( ha.sphereCenter != hb.sphereCenter || ha.sphereRadius != hb.sphereRadius || ha.fingers.size() != hb.fingers.size() ){
+			return false;
+		}
+		for(int j = 0; j < ha.fingers.size(); j++){
+			const ofxLeapMotionSimpleHand::simpleFinger & fa = ha.fingers[j];
+			const ofxLeapMotionSimpleHand::simpleFinger & fb = hb.fingers[j];
+			if( fa.id != fb.id || fa.pos != fb.pos || fa.vel != fb.vel || fa.base != fb.base ){
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+void testOsc(){
+	ofxLeapMotionOscReceiver receiver;
+	ofxLeapMotionOscSender sender;
+	LEAP_CHECK( receiver.setup(testPort) );
+	LEAP_CHECK( sender.setup("127.0.0.1", testPort) );
+	
+	//nothing received yet
+	ofxLeapMotionSimpleFrame received;
+	LEAP_CHECK( !receiver.getSimpleFrame(received) );
+	LEAP_CHECK( !receiver.isFrameNew() );
+	
+	//frames with two hands, one hand and none make it over loopback as they were sent
+	for(int i = 0; i < 3; i++){
+		ofxLeapMotionSimpleFrame frame = makeTestFrame(7 + i, 2 - i);
+		sender.send(frame);
+		LEAP_CHECK( waitForFrame(receiver, frame.id) );
+		LEAP_CHECK( receiver.isFrameNew() );
+		LEAP_CHECK( receiver.getSimpleFrame(received) );
+		LEAP_CHECK( isSameFrame(frame, received) );
+		receiver.markFrameAsOld();
+		LEAP_CHECK( !receiver.isFrameNew() );
+	}
+	LEAP_CHECK( waitForCount(sender, 3) );
+	LEAP_CHECK( sender.getNumSent() == 3 );
+	LEAP_CHECK( sender.getNumCoalesced() == 0 );
+	
+	//the same bytes caught with a plain socket - decode() takes the whole bundle and nothing shorter, even one cut
+	//between two messages
+	ofxLeapMotionUdp raw;
+	ofxLeapMotionOscSender rawSender;
+	LEAP_CHECK( raw.bind(rawPort) );
+	LEAP_CHECK( rawSender.setup("127.0.0.1", rawPort) );
+	ofxLeapMotionSimpleFrame frame = makeTestFrame(20, 2);
+	rawSender.send(frame);
+	vector <char> packet(65536);
+	int size = raw.receive(&packet[0], packet.size(), 2000);
+	LEAP_CHECK( size > 0 );
+	
+	if( size > 0 ){
+		LEAP_CHECK( ofxLeapMotionOscReceiver::decode(&packet[0], size, received) );
+		LEAP_CHECK( isSameFrame(frame, received) );
+		
+		int numAccepted = 0;
+		for(int i = 0; i < size; i++){
+			ofxLeapMotionSimpleFrame truncated;
+			numAccepted += ofxLeapMotionOscReceiver::decode(&packet[0], i, truncated);
+		}
+		LEAP_CHECK( numAccepted == 0 );
+		
+		//an element that claims more bytes than are left
+		vector <char> corrupt(packet.begin(), packet.begin() + size);
+		corrupt[16] = 0x7f;
+		LEAP_CHECK( !ofxLeapMotionOscReceiver::decode(&corrupt[0], size, received) );
+	}
+	rawSender.close();
+	raw.close();
+	
+	//a burst faster than the rate limit - the frames in between are replaced, only the newest gets through. the
+	//sender takes one frame at the start and one for every 50ms the burst lasts
+	sender.setMaxRate(20);
+	uint64_t sentBefore = sender.getNumSent();
+	uint64_t coalescedBefore = sender.getNumCoalesced();
+	const int burst = 100;
+	uint64_t start = ofGetElapsedTimeMillis();
+	for(int i = 0; i < burst; i++){
+		sender.send( makeTestFrame(100 + i, 1) );
+	}
+	uint64_t maxTaken = 2 + (ofGetElapsedTimeMillis() - start) / 50;
+	LEAP_CHECK( sender.getNumCoalesced() - coalescedBefore >= burst - maxTaken );
+	LEAP_CHECK( waitForFrame(receiver, 100 + burst - 1) );
+	
+	//every frame was either sent or replaced
+	LEAP_CHECK( waitForCount(sender, sentBefore + coalescedBefore + burst) );
+	LEAP_CHECK( sender.getNumSent() - sentBefore <= maxTaken + 1 );
+	LEAP_CHECK( sender.getNumSent() - sentBefore + sender.getNumCoalesced() - coalescedBefore == burst );
+	
+	sender.close();
+	receiver.close();
+}
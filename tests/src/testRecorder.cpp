@@ -0,0 +1,276 @@
+#include "tests.h"
+#include "ofxLeapMotionRecorder.h"
+
+#include <fstream>
+
+static const string recordingPath = "test_recording.ofxleap";
+static const string brokenPath = "test_broken.ofxleap";
+
+//--------------------------------------------------------------
+static string readFile(const string & path){
+	std::ifstream file(ofToDataPath(path).c_str(), std::ios::binary);
+	return string(std::istreambuf_iterator <char> (file), std::istreambuf_iterator <char> ());
+}
+
+//--------------------------------------------------------------
+static void writeFile(const string & path, const string & data){
+	std::ofstream file(ofToDataPath(path).c_str(), std::ios::binary | std::ios::trunc);
+	file.write(data.data(), data.size());
+}
+
+//--------------------------------------------------------------
+static void putSigned(string & out, int64_t v){
+	uint64_t u = ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+	while( u >= 0x80 ){
+		out.push_back( (char)(u | 0x80) );
+		u >>= 7;
+	}
+	out.push_back( (char)u );
+}
+
+//--------------------------------------------------------------
+template <class T> static void putRaw(string & out, T v){
+	out.append((const char *)&v, sizeof(T));
+}
+
+//a version 1 recording written byte by byte - one frame (id 5, 40ms) with hand 1 at (10, 200, -3) and its finger 10
+//--------------------------------------------------------------
+void writeVersion1Recording(const string & path){
+	string frame;
+	putSigned(frame, 5);
+	putSigned(frame, 40000);
+	frame.push_back(1);                 // hands - counts aren't zigzag coded
+	putSigned(frame, 1);
+	int32_t hand[13] = {100, 2000, -30, 0, -10000, 0, 0, 0, 0, 100, 2400, -30, 600};
+	for(int i = 0; i < 13; i++){
+		putSigned(frame, hand[i]);
+	}
+	frame.push_back(1);                 // fingers
+	putSigned(frame, 10);
+	int32_t finger[9] = {100, 2100, -600, 0, 0, 0, 100, 2000, -200};
+	for(int i = 0; i < 9; i++){
+		putSigned(frame, finger[i]);
+	}
+	
+	string data = "OFXLEAP1";
+	putRaw(data, (uint32_t)1);
+	uint64_t blockOffset = data.size();
+	putRaw(data, (uint32_t)frame.size());
+	putRaw(data, (uint32_t)1);
+	data += frame;
+	uint64_t indexOffset = data.size();
+	putRaw(data, blockOffset);
+	putRaw(data, (int64_t)40000);
+	putRaw(data, (uint32_t)0);
+	putRaw(data, (uint32_t)1);
+	putRaw(data, indexOffset);
+	data += "OFXLIDX1";
+	writeFile(path, data);
+}
+
+//a frame with everything version 2 added - tools, gestures and the hand and finger extras
+//--------------------------------------------------------------
+static ofxLeapMotionSimpleFrame makeFullFrame(int64_t id){
+	ofxLeapMotionSimpleFrame frame = makeTestFrame(id, 2);
+	frame.hands[1].bLeft = true;
+	frame.hands[1].confidence = 0.75;
+	frame.hands[1].pinchStrength = 0.5;
+	frame.hands[1].grabStrength = 0.25;
+	frame.hands[1].timeVisible = id * 0.008;
+	frame.hands[1].fingers[1].touchDistance = -0.3;
+	frame.hands[1].fingers[1].touchZone = OFX_LEAP_TOUCH_TOUCHING;
+	
+	ofxLeapMotionSimpleTool tool;
+	tool.id = 7;
+	tool.handId = 2;
+	tool.pos.set(20, 180 + id, -40);
+	tool.direction.set(0, 0, -1);
+	tool.length = 120;
+	tool.width = 8;
+	tool.touchDistance = 0.4;
+	tool.touchZone = OFX_LEAP_TOUCH_HOVERING;
+	frame.tools.push_back(tool);
+	
+	ofxLeapMotionSimpleGesture gesture;
+	gesture.id = 3;
+	gesture.type = OFX_LEAP_GESTURE_CIRCLE;
+	gesture.state = id % 10 ? OFX_LEAP_GESTURE_STATE_UPDATE : OFX_LEAP_GESTURE_STATE_STOP;
+	gesture.position.set(0, 200, 0);
+	gesture.normal.set(0, 0, 1);
+	gesture.progress = id * 0.1;
+	gesture.radius = 30;
+	gesture.durationMicros = id * 8000;
+	frame.gestures.push_back(gesture);
+	return frame;
+}
+
+//loads the file and decodes every block - whatever is in it, this must fail cleanly instead of crashing
+//--------------------------------------------------------------
+static bool loadAll(const string & path){
+	ofxLeapMotionPlayer player;
+	if( !player.load(path) ){
+		return false;
+	}
+	vector <ofxLeapMotionSimpleFrame> frames;
+	for(int i = 0; i < player.getNumBlocks(); i++){
+		if( !player.readBlock(i, frames) ){
+			return false;
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+void testRecorder(){
+	ofxLeapMotionRecorder recorder;
+	LEAP_CHECK( recorder.open(recordingPath, 16) );
+	for(int i = 0; i < 100; i++){
+		recorder.addFrame( makeTestFrame(i + 1, i % 3) );
+	}
+	recorder.close();
+	
+	ofxLeapMotionPlayer player;
+	LEAP_CHECK( player.load(recordingPath) );
+	LEAP_CHECK( player.getNumFrames() == 100 );
+	LEAP_CHECK( player.getNumBlocks() == 7 );
+	
+	//positions come back to within the 0.1mm they were quantized to
+	for(int i = 0; i < 100; i++){
+		ofxLeapMotionSimpleFrame expected = makeTestFrame(i + 1, i % 3);
+		ofxLeapMotionSimpleFrame frame;
+		LEAP_CHECK( player.getFrame(i, frame) );
+		LEAP_CHECK( frame.id == expected.id && frame.timestamp == expected.timestamp );
+		LEAP_CHECK( frame.hands.size() == expected.hands.size() );
+		for(int j = 0; j < frame.hands.size() && j < expected.hands.size(); j++){
+			LEAP_CHECK( frame.hands[j].id == expected.hands[j].id );
+			LEAP_CHECK( frame.hands[j].handPos.distance(expected.hands[j].handPos) < 0.1 );
+			LEAP_CHECK( frame.hands[j].fingers.size() == 5 );
+			LEAP_CHECK( frame.hands[j].fingers[4].pos.distance(expected.hands[j].fingers[4].pos) < 0.1 );
+		}
+	}
+	LEAP_CHECK( player.getFrameIndexAt(50 * 8000) == 49 );
+	
+	//tools, gestures and the hand and finger extras come back too
+	LEAP_CHECK( recorder.open(recordingPath, 16) );
+	for(int i = 0; i < 40; i++){
+		recorder.addFrame( makeFullFrame(i + 1) );
+	}
+	recorder.close();
+	LEAP_CHECK( player.load(recordingPath) );
+	for(int i = 0; i < 40; i++){
+		ofxLeapMotionSimpleFrame expected = makeFullFrame(i + 1);
+		ofxLeapMotionSimpleFrame frame;
+		LEAP_CHECK( player.getFrame(i, frame) );
+		
+		LEAP_CHECK( frame.hands.size() == 2 );
+		if( frame.hands.size() == 2 ){
+			const ofxLeapMotionSimpleHand & hand = frame.hands[1];
+			const ofxLeapMotionSimpleHand & e = expected.hands[1];
+			LEAP_CHECK( hand.handDirection.distance(e.handDirection) < 0.001 );
+			LEAP_CHECK( hand.bLeft && !frame.hands[0].bLeft );
+			LEAP_CHECK( fabs(hand.confidence - e.confidence) < 0.001 && fabs(hand.pinchStrength - e.pinchStrength) < 0.001 && fabs(hand.grabStrength - e.grabStrength) < 0.001 );
+			LEAP_CHECK( fabs(hand.palmWidth - e.palmWidth) < 0.1 && fabs(hand.timeVisible - e.timeVisible) < 0.001 );
+			LEAP_CHECK( fabs(hand.fingers[1].touchDistance - e.fingers[1].touchDistance) < 0.001 );
+			LEAP_CHECK( hand.fingers[1].touchZone == OFX_LEAP_TOUCH_TOUCHING && hand.fingers[0].touchZone == OFX_LEAP_TOUCH_NONE );
+		}
+		
+		LEAP_CHECK( frame.tools.size() == 1 );
+		if( frame.tools.size() == 1 ){
+			const ofxLeapMotionSimpleTool & tool = frame.tools[0];
+			LEAP_CHECK( tool.id == 7 && tool.handId == 2 && tool.touchZone == OFX_LEAP_TOUCH_HOVERING );
+			LEAP_CHECK( tool.pos.distance(expected.tools[0].pos) < 0.1 && tool.direction.distance(expected.tools[0].direction) < 0.001 );
+			LEAP_CHECK( fabs(tool.length - 120) < 0.1 && fabs(tool.width - 8) < 0.1 && fabs(tool.touchDistance - 0.4) < 0.001 );
+		}
+		
+		LEAP_CHECK( frame.gestures.size() == 1 );
+		if( frame.gestures.size() == 1 ){
+			const ofxLeapMotionSimpleGesture & gesture = frame.gestures[0];
+			const ofxLeapMotionSimpleGesture & e = expected.gestures[0];
+			LEAP_CHECK( gesture.id == 3 && gesture.type == OFX_LEAP_GESTURE_CIRCLE && gesture.state == e.state );
+			LEAP_CHECK( gesture.position.distance(e.position) < 0.1 && gesture.normal.distance(e.normal) < 0.001 );
+			LEAP_CHECK( fabs(gesture.progress - e.progress) < 0.001 && fabs(gesture.radius - 30) < 0.1 && gesture.durationMicros == e.durationMicros );
+		}
+	}
+	
+	//version 1 recordings still load - without the version 2 fields
+	writeVersion1Recording(brokenPath);
+	ofxLeapMotionSimpleFrame old;
+	LEAP_CHECK( player.load(brokenPath) && player.getNumFrames() == 1 && player.getFrame(0, old) );
+	LEAP_CHECK( old.id == 5 && old.timestamp == 40000 && old.hands.size() == 1 && old.tools.empty() && old.gestures.empty() );
+	if( old.hands.size() == 1 ){
+		LEAP_CHECK( old.hands[0].handPos.distance(ofPoint(10, 200, -3)) < 0.001 && old.hands[0].sphereRadius == 60 );
+		LEAP_CHECK( old.hands[0].confidence == 1 && !old.hands[0].bLeft );
+		LEAP_CHECK( old.hands[0].fingers.size() == 1 && old.hands[0].fingers[0].id == 10 );
+		LEAP_CHECK( old.hands[0].fingers[0].touchZone == OFX_LEAP_TOUCH_NONE );
+	}
+	
+	//the byte checks below run on the first recording
+	recorder.open(recordingPath, 16);
+	for(int i = 0; i < 100; i++){
+		recorder.addFrame( makeTestFrame(i + 1, i % 3) );
+	}
+	recorder.close();
+	
+	string data = readFile(recordingPath);
+	
+	//cut short anywhere the index is gone
+	for(int i = 0; i < data.size(); i += 7){
+		writeFile(brokenPath, data.substr(0, i));
+		LEAP_CHECK( !player.load(brokenPath) );
+		LEAP_CHECK( player.getNumFrames() == 0 );
+	}
+	
+	//flipped bytes anywhere must not crash or ask for huge buffers
+	for(int i = 0; i < data.size(); i++){
+		string broken = data;
+		broken[i] ^= 0xff;
+		writeFile(brokenPath, broken);
+		loadAll(brokenPath);
+	}
+	
+	//a block header claiming more frames than it has bytes for
+	string broken = data;
+	uint32_t hugeCount = 0x7fffffff;
+	memcpy(&broken[12 + 4], &hugeCount, 4);
+	writeFile(brokenPath, broken);
+	LEAP_CHECK( !player.load(brokenPath) );
+	
+	//an index claiming more blocks than the file holds
+	broken = data;
+	memcpy(&broken[data.size() - 20], &hugeCount, 4);
+	writeFile(brokenPath, broken);
+	LEAP_CHECK( !player.load(brokenPath) );
+	
+	LEAP_CHECK( loadAll(recordingPath) );
+	
+	ofFile::removeFile(brokenPath);
+	ofFile::removeFile(recordingPath);
+}
+
+//--------------------------------------------------------------
+void benchRecorder(){
+	vector <ofxLeapMotionSimpleFrame> frames;
+	for(int i = 0; i < 256; i++){
+		frames.push_back( makeTestFrame(i + 1, 2) );
+	}
+	
+	ofxLeapMotionRecorder recorder;
+	recorder.open(recordingPath, 256);
+	double micros = ofxLeapTest::bench([&](){
+		for(int i = 0; i < frames.size(); i++){
+			recorder.addFrame(frames[i]);
+		}
+	});
+	recorder.close();
+	ofxLeapTest::report("encode 2 hands", micros / frames.size(), "us per frame");
+	
+	ofxLeapMotionPlayer player;
+	player.load(recordingPath);
+	vector <ofxLeapMotionSimpleFrame> decoded;
+	micros = ofxLeapTest::bench([&](){
+		player.readBlock(0, decoded);
+	});
+	ofxLeapTest::report("decode 2 hands", micros / MAX(1, decoded.size()), "us per frame");
+	
+	ofFile::removeFile(recordingPath);
+}
@@ -0,0 +1,277 @@
+#include "tests.h"
+#include "ofxLeapMotion.h"
+#include "ofxLeapMotionRecorder.h"
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+
+static const string replayPath = "test_replay.ofxleap";
+static const string goldenPath = "replay/gestures.txt";
+
+//--------------------------------------------------------------
+static ofxLeapMotionSimpleGesture makeGesture(int64_t id, ofxLeapMotionGestureType type, bool bStop){
+	ofxLeapMotionSimpleGesture gesture;
+	gesture.id = id;
+	gesture.type = type;
+	gesture.state = bStop ? OFX_LEAP_GESTURE_STATE_STOP : OFX_LEAP_GESTURE_STATE_UPDATE;
+	return gesture;
+}
+
+//a made up session - one hand all the way through, a second one for a while, a tool, and a swipe right, a full
+//circle, a screen tap, a key tap and a swipe up one after the other
+//--------------------------------------------------------------
+static ofxLeapMotionSimpleFrame makeSessionFrame(int64_t id){
+	ofxLeapMotionSimpleFrame frame;
+	frame.id = id;
+	frame.timestamp = id * 8000;
+	
+	ofxLeapMotionSimpleHand hand = makeTestHand(1, (id % 120) / 120.0);
+	hand.handPos.y += 40 * sin(id * 0.05);
+	hand.confidence = 1;
+	frame.hands.push_back(hand);
+	
+	if( id >= 60 && id < 180 ){
+		ofxLeapMotionSimpleHand other = makeTestHand(2, 0.5);
+		other.bLeft = true;
+		for(int i = 0; i < other.fingers.size(); i++){
+			other.fingers[i].pos += (other.fingers[i].pos - other.handPos) * (id - 60) * 0.005;
+		}
+		frame.hands.push_back(other);
+	}
+	
+	if( id >= 90 && id < 140 ){
+		ofxLeapMotionSimpleTool tool;
+		tool.id = 20;
+		tool.pos.set(40, 150 + id, -30);
+		tool.direction.set(0, 0, -1);
+		tool.length = 120;
+		tool.width = 8;
+		frame.tools.push_back(tool);
+	}
+	
+	if( id >= 20 && id <= 35 ){
+		ofxLeapMotionSimpleGesture swipe = makeGesture(10, OFX_LEAP_GESTURE_SWIPE, id == 35);
+		swipe.startPosition.set(-80, 200, 0);
+		swipe.position.set(-80 + (id - 20) * 10, 200, 0);
+		swipe.direction.set(1, 0, 0);
+		swipe.speed = 1250;
+		swipe.durationMicros = (id - 20) * 8000;
+		frame.gestures.push_back(swipe);
+	}
+	
+	if( id >= 50 && id <= 110 ){
+		ofxLeapMotionSimpleGesture circle = makeGesture(11, OFX_LEAP_GESTURE_CIRCLE, id == 110);
+		circle.position.set(0, 220, -20);
+		circle.normal.set(0, 0, -1);
+		circle.radius = 40;
+		circle.progress = (id - 50) / 40.0;
+		circle.durationMicros = (id - 50) * 8000;
+		frame.gestures.push_back(circle);
+	}
+	
+	if( id == 130 ){
+		ofxLeapMotionSimpleGesture tap = makeGesture(12, OFX_LEAP_GESTURE_SCREEN_TAP, true);
+		tap.position.set(30, 250, -60);
+		tap.direction.set(0, 0, -1);
+		tap.progress = 1;
+		frame.gestures.push_back(tap);
+	}
+	
+	if( id == 150 ){
+		ofxLeapMotionSimpleGesture tap = makeGesture(13, OFX_LEAP_GESTURE_KEY_TAP, true);
+		tap.position.set(-20, 180, 10);
+		tap.direction.set(0, -1, 0);
+		tap.progress = 1;
+		frame.gestures.push_back(tap);
+	}
+	
+	if( id >= 170 && id <= 185 ){
+		ofxLeapMotionSimpleGesture swipe = makeGesture(14, OFX_LEAP_GESTURE_SWIPE, id == 185);
+		swipe.startPosition.set(0, 150, 0);
+		swipe.position.set(0, 150 + (id - 170) * 10, 0);
+		swipe.direction.set(0, 1, 0);
+		swipe.speed = 1250;
+		swipe.durationMicros = (id - 170) * 8000;
+		frame.gestures.push_back(swipe);
+	}
+	
+	return frame;
+}
+
+//a filter with state of its own - halves the jitter of each palm
+//--------------------------------------------------------------
+static std::function <void(ofxLeapMotionSimpleFrame &)> makeSmoothing(){
+	std::shared_ptr < std::map <int64_t, ofPoint> > previous(new std::map <int64_t, ofPoint> ());
+	return [previous](ofxLeapMotionSimpleFrame & frame){
+		for(int i = 0; i < frame.hands.size(); i++){
+			ofxLeapMotionSimpleHand & hand = frame.hands[i];
+			if( previous->count(hand.id) ){
+				hand.handPos = hand.handPos * 0.5 + (*previous)[hand.id] * 0.5;
+			}
+			(*previous)[hand.id] = hand.handPos;
+		}
+	};
+}
+
+//--------------------------------------------------------------
+static void setupLeap(ofxLeapMotion & leap){
+	leap.setFilter( makeSmoothing() );
+	leap.setMappingX(-200, 200, 0, 1024);
+	leap.setMappingY(0, 400, 768, 0);
+	leap.setMappingZ(-200, 200, -1, 1);
+}
+
+//--------------------------------------------------------------
+static string format(const char * name, const ofPoint & p){
+	char text[128];
+	snprintf(text, sizeof(text), " %s %.2f %.2f %.2f", name, p.x, p.y, p.z);
+	return text;
+}
+
+//what an app sees after each frame - the mapped hands and tools, the motion and the gesture results
+//rounded so the text only changes when the results do
+//--------------------------------------------------------------
+static string describe(ofxLeapMotion & leap){
+	char text[256];
+	string out;
+	
+	ofxLeapMotionSimpleFrame frame = leap.getSimpleFrame();
+	vector <ofxLeapMotionSimpleHand> hands = leap.getSimpleHands();
+	vector <ofxLeapMotionSimpleTool> tools = leap.getSimpleTools();
+	
+	snprintf(text, sizeof(text), "frame %lld hands %d tools %d gestures %d", (long long)frame.id, (int)hands.size(), (int)tools.size(), (int)frame.gestures.size());
+	out += text;
+	out += "\n";
+	
+	for(int i = 0; i < hands.size() && i < frame.hands.size(); i++){
+		snprintf(text, sizeof(text), "  hand %lld", (long long)hands[i].id);
+		out += text;
+		out += format("pos", hands[i].handPos);
+		out += format("translation", frame.hands[i].translation);
+		snprintf(text, sizeof(text), " scale %.3f probabilities %.2f %.2f %.2f", frame.hands[i].scale, frame.hands[i].translationProbability, frame.hands[i].rotationProbability, frame.hands[i].scaleProbability);
+		out += text;
+		out += "\n";
+	}
+	
+	for(int i = 0; i < tools.size(); i++){
+		snprintf(text, sizeof(text), "  tool %lld", (long long)tools[i].id);
+		out += text;
+		out += format("pos", tools[i].pos);
+		out += "\n";
+	}
+	
+	leap.updateGestures();
+	snprintf(text, sizeof(text), "  gesture %d swipe %.1f %lld circle %.3f %.2f", leap.iGestures, leap.swipeSpeed, (long long)leap.swipeDurationMicros, leap.circleProgress, leap.circleRadius);
+	out += text;
+	out += format("center", leap.circleCenter);
+	out += format("screenTap", leap.screenTapPosition);
+	out += format("keyTap", leap.keyTapPosition);
+	out += "\n";
+	
+	return out;
+}
+
+//--------------------------------------------------------------
+static string readText(const string & path){
+	std::ifstream file(ofToDataPath(path).c_str(), std::ios::binary);
+	return string(std::istreambuf_iterator <char> (file), std::istreambuf_iterator <char> ());
+}
+
+//--------------------------------------------------------------
+static bool writeText(const string & path, const string & text){
+	std::ofstream file(ofToDataPath(path).c_str(), std::ios::binary | std::ios::trunc);
+	file.write(text.data(), text.size());
+	return file.good();
+}
+
+//the line number of the first difference - so a failure says where the results changed
+//--------------------------------------------------------------
+static int getFirstDifferentLine(const string & a, const string & b){
+	int line = 1;
+	for(size_t i = 0; i < a.size() && i < b.size(); i++){
+		if( a[i] != b[i] ){
+			return line;
+		}
+		line += a[i] == '\n';
+	}
+	return a.size() == b.size() ? 0 : line;
+}
+
+//a recording replayed frame by frame must give exactly what the golden file has - and replay() the same every time,
+//whatever the ofxLeapMotion did before
+//--------------------------------------------------------------
+void testReplay(){
+	const int numFrames = 240;
+	
+	ofxLeapMotionRecorder recorder;
+	LEAP_CHECK( recorder.open(replayPath, 64) );
+	for(int i = 0; i < numFrames; i++){
+		recorder.addFrame( makeSessionFrame(i + 1) );
+	}
+	recorder.close();
+	
+	ofxLeapMotionPlayer player;
+	LEAP_CHECK( player.load(replayPath) );
+	LEAP_CHECK( player.getNumFrames() == numFrames );
+	
+	//frame by frame through a new ofxLeapMotion - nothing to reset
+	vector <string> described;
+	string results;
+	ofxLeapMotion leap;
+	setupLeap(leap);
+	for(int i = 0; i < player.getNumFrames(); i++){
+		ofxLeapMotionSimpleFrame frame;
+		LEAP_CHECK( player.getFrame(i, frame) );
+		LEAP_CHECK( leap.replayFrame(frame) );
+		described.push_back( describe(leap) );
+		results += described.back();
+	}
+	
+	//every gesture must have been seen, in order
+	LEAP_CHECK( results.find("gesture 3 ") < results.find("circle 1.000") );
+	LEAP_CHECK( results.find("circle 1.000") < results.find("gesture 1 ") );
+	LEAP_CHECK( results.find("gesture 1 ") < results.find("gesture 2 ") );
+	LEAP_CHECK( results.find("gesture 2 ") < results.find("gesture 6 ") );
+	LEAP_CHECK( results.find("gesture 6 ") != string::npos );
+	
+	if( ofxLeapTest::bUpdateGolden ){
+		ofDirectory::createDirectory(ofToDataPath("replay"), false, true);
+		LEAP_CHECK( writeText(goldenPath, results) );
+		cout << "wrote " << goldenPath << endl;
+	}else{
+		string golden = readText(goldenPath);
+		LEAP_CHECK( !golden.empty() );
+		LEAP_CHECK( golden == results );
+		if( !golden.empty() && golden != results ){
+			cout << "  " << goldenPath << " differs from line " << getFirstDifferentLine(golden, results) << " - run bin/tests golden if the change is intended" << endl;
+		}
+	}
+	
+	//replay() after the frames above, with the same settings but a fresh filter, ends up in the same place
+	setupLeap(leap);
+	LEAP_CHECK( leap.replay(player) == numFrames );
+	LEAP_CHECK( describe(leap) == described.back() );
+	
+	//a short recording replayed after a different session left its gestures and motion behind
+	//must give what the first frames did from scratch - a circle center left over would show here
+	LEAP_CHECK( recorder.open(replayPath, 64) );
+	for(int i = 0; i < 30; i++){
+		recorder.addFrame( makeSessionFrame(i + 1) );
+	}
+	recorder.close();
+	LEAP_CHECK( player.load(replayPath) );
+	
+	ofxLeapMotion other;
+	setupLeap(other);
+	for(int i = 0; i < 60; i++){
+		ofxLeapMotionSimpleFrame frame = makeSessionFrame(100 + i);
+		frame.id += 1000;
+		other.replayFrame(frame);
+	}
+	setupLeap(other);
+	LEAP_CHECK( other.replay(player) == 30 );
+	LEAP_CHECK( describe(other) == described[29] );
+	
+	std::remove(ofToDataPath(replayPath).c_str());
+}
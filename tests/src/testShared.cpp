@@ -0,0 +1,102 @@
+#include "tests.h"
+#include "ofxLeapMotionShared.h"
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static const string sharedName = "/ofxLeapMotionTest";
+
+//--------------------------------------------------------------
+static int64_t readFrameId(ofxLeapMotionSharedSubscriber & subscriber){
+	ofxLeapMotionSimpleFrame frame;
+	return subscriber.getSimpleFrame(frame) ? frame.id : -1;
+}
+
+//--------------------------------------------------------------
+void testShared(){
+	//junk left under the name, like a publisher that crashed with an older layout
+	int fd = shm_open(sharedName.c_str(), O_CREAT | O_RDWR, 0666);
+	LEAP_CHECK( fd >= 0 );
+	LEAP_CHECK( ftruncate(fd, 64) == 0 );
+	LEAP_CHECK( write(fd, "0123456789abcdef0123456789abcdef", 32) == 32 );
+	close(fd);
+	
+	ofxLeapMotionSharedSubscriber subscriber;
+	LEAP_CHECK( !subscriber.setup(sharedName) );
+	
+	ofxLeapMotionSharedPublisher publisher;
+	LEAP_CHECK( publisher.setup(sharedName) );
+	LEAP_CHECK( subscriber.setup(sharedName) );
+	LEAP_CHECK( readFrameId(subscriber) == -1 );
+	
+	LEAP_CHECK( subscriber.getCurrentFrameID() == -1 );
+	
+	publisher.publish( makeTestFrame(5, 2) );
+	LEAP_CHECK( subscriber.isFrameNew() );
+	LEAP_CHECK( readFrameId(subscriber) == 5 );
+	LEAP_CHECK( subscriber.getCurrentFrameID() == 5 );
+	LEAP_CHECK( subscriber.getSimpleFrame().hands.size() == 2 );
+	subscriber.markFrameAsOld();
+	LEAP_CHECK( !subscriber.isFrameNew() );
+	
+	//the id is the Leap's, not a count of the frames published - and more frames than there are slots wrap around
+	for(int i = 0; i < 40; i++){
+		publisher.publish( makeTestFrame(1000 + i * 3, 1) );
+		LEAP_CHECK( subscriber.getCurrentFrameID() == 1000 + i * 3 );
+	}
+	LEAP_CHECK( subscriber.isFrameNew() );
+	subscriber.markFrameAsOld();
+	LEAP_CHECK( !subscriber.isFrameNew() );
+	
+	//a restarted publisher is picked up straight away
+	publisher.close();
+	LEAP_CHECK( publisher.setup(sharedName) );
+	publisher.publish( makeTestFrame(7, 1) );
+	LEAP_CHECK( readFrameId(subscriber) == 7 );
+	LEAP_CHECK( subscriber.isFrameNew() );
+	
+	//a closed one is noticed straight away
+	publisher.close();
+	LEAP_CHECK( !subscriber.isConnected() );
+	LEAP_CHECK( readFrameId(subscriber) == -1 );
+	
+	//a publisher that dies without closing - in another process
+	int ready[2], quit[2];
+	LEAP_CHECK( pipe(ready) == 0 && pipe(quit) == 0 );
+	pid_t child = fork();
+	if( child == 0 ){
+		ofxLeapMotionSharedPublisher crashing;
+		crashing.setup(sharedName);
+		crashing.publish( makeTestFrame(9, 1) );
+		char c = 0;
+		write(ready[1], &c, 1);
+		read(quit[0], &c, 1);
+		_exit(0);
+	}
+	char c = 0;
+	LEAP_CHECK( read(ready[0], &c, 1) == 1 );
+	ofSleepMillis(600);
+	LEAP_CHECK( readFrameId(subscriber) == 9 );
+	LEAP_CHECK( write(quit[1], &c, 1) == 1 );
+	waitpid(child, NULL, 0);
+	
+	//left behind under the name it isn't mapped again, and a new publisher replaces it
+	ofSleepMillis(600);
+	LEAP_CHECK( readFrameId(subscriber) == -1 );
+	ofxLeapMotionSharedSubscriber late;
+	LEAP_CHECK( !late.setup(sharedName) );
+	
+	LEAP_CHECK( publisher.setup(sharedName) );
+	publisher.publish( makeTestFrame(11, 1) );
+	ofSleepMillis(600);
+	LEAP_CHECK( readFrameId(subscriber) == 11 );
+	LEAP_CHECK( readFrameId(late) == 11 );
+	
+	publisher.close();
+	for(int i = 0; i < 2; i++){
+		close(ready[i]);
+		close(quit[i]);
+	}
+}
@@ -0,0 +1,99 @@
+#include "tests.h"
+#include "ofxLeapMotion.h"
+#include "ofxLeapFake.h"
+
+#include <chrono>
+#include <thread>
+
+typedef std::chrono::steady_clock startupClock;
+
+//how long the fake Leap service takes to connect - like a service that is running, with a device plugged in
+static const uint64_t serviceConnectMicros = 20000;
+
+//--------------------------------------------------------------
+static double getMicrosSince(startupClock::time_point start){
+	return std::chrono::duration <double, std::micro> (startupClock::now() - start).count();
+}
+
+//open() must hand the controller to the startup thread and return straight away, connected or not
+//--------------------------------------------------------------
+void testStartup(){
+	ofxLeapMotion leap;
+	LEAP_CHECK( leap.getConnectionState() == OFX_LEAP_CLOSED );
+	
+	leap.open();
+	LEAP_CHECK( leap.getConnectionState() != OFX_LEAP_CLOSED );
+	
+	//a second open() while running does nothing
+	leap.open();
+	LEAP_CHECK( leap.getConnectionState() != OFX_LEAP_CLOSED );
+	
+	leap.close();
+	LEAP_CHECK( leap.getConnectionState() == OFX_LEAP_CLOSED );
+	LEAP_CHECK( !leap.isConnected() );
+	
+	//and it can be opened again after closing - connecting once the service does, not before
+	ofxLeapFake::setup(serviceConnectMicros);
+	startupClock::time_point start = startupClock::now();
+	leap.open();
+	LEAP_CHECK( leap.getConnectionState() != OFX_LEAP_CLOSED );
+	LEAP_CHECK( !leap.isConnected() );
+	while( getMicrosSince(start) < 1000000 && !leap.isConnected() ){
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	LEAP_CHECK( leap.isConnected() );
+	LEAP_CHECK( getMicrosSince(start) >= serviceConnectMicros );
+	leap.close();
+	LEAP_CHECK( leap.getConnectionState() == OFX_LEAP_CLOSED );
+	ofxLeapFake::setup();
+}
+
+//what setup() pays for the Leap - against the fake service, which connects serviceConnectMicros after the controller
+//is made. so "open() to connected" less that is what ofxLeapMotion adds, and the numbers don't depend on the machine's Leap
+//--------------------------------------------------------------
+void benchStartup(){
+	const int numRuns = 20;
+	
+	ofxLeapFake::setup(serviceConnectMicros);
+	
+	double constructMicros = 0;
+	double openMicros = 0;
+	double closeMicros = 0;
+	double connectMicros = 0;
+	int numConnected = 0;
+	
+	for(int i = 0; i < numRuns; i++){
+		startupClock::time_point start = startupClock::now();
+		ofxLeapMotion * leap = new ofxLeapMotion();
+		constructMicros += getMicrosSince(start);
+		
+		start = startupClock::now();
+		leap->open();
+		openMicros += getMicrosSince(start);
+		
+		//the controller is made on the startup thread - polled finely so the wait doesn't add much
+		while( getMicrosSince(start) < 1000000 && !leap->isConnected() ){
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+		}
+		if( leap->isConnected() ){
+			connectMicros += getMicrosSince(start);
+			numConnected++;
+		}
+		
+		start = startupClock::now();
+		leap->close();
+		closeMicros += getMicrosSince(start);
+		
+		delete leap;
+	}
+	LEAP_CHECK( numConnected == numRuns );
+	
+	ofxLeapTest::report("construct", constructMicros / numRuns, "us");
+	ofxLeapTest::report("open() returns", openMicros / numRuns, "us");
+	if( numConnected ){
+		ofxLeapTest::report("open() to connected", connectMicros / numConnected, "us - the fake service takes " + ofToString(serviceConnectMicros));
+	}
+	ofxLeapTest::report("close()", closeMicros / numRuns, "us");
+	
+	ofxLeapFake::setup();
+}
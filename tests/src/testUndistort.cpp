@@ -0,0 +1,57 @@
+#include "tests.h"
+#include "ofxLeapMotionUndistort.h"
+
+//the rows split across the workers must give exactly what one thread gives
+//--------------------------------------------------------------
+void testUndistort(){
+	vector <ofPoint> dots;
+	dots.push_back(ofPoint(320, 120));
+	ofxLeapMotionImage image = makeTestImage(0, 640, 240, dots);
+	
+	ofxLeapMotionUndistort single;
+	single.setup(400, 400);
+	single.setNumThreads(1);
+	ofPixels expected;
+	LEAP_CHECK( single.undistort(image, expected) );
+	LEAP_CHECK( expected.getWidth() == 400 && expected.getHeight() == 400 );
+	
+	//the dot in the middle of the image stays in the middle
+	LEAP_CHECK( expected.getData()[200 * 400 + 200] > 200 );
+	
+	ofxLeapMotionUndistort threaded;
+	threaded.setup(400, 400);
+	threaded.setNumThreads(4);
+	for(int i = 0; i < 20; i++){
+		ofPixels output;
+		LEAP_CHECK( threaded.undistort(image, output) );
+		LEAP_CHECK( memcmp(output.getData(), expected.getData(), 400 * 400) == 0 );
+	}
+	
+	//no distortion map yet
+	ofxLeapMotionImage empty;
+	ofPixels output;
+	LEAP_CHECK( !threaded.undistort(empty, output) );
+}
+
+//--------------------------------------------------------------
+void benchUndistort(){
+	vector <ofPoint> dots;
+	ofxLeapMotionImage image = makeTestImage(0, 640, 240, dots);
+	ofPixels output;
+	
+	int sizes[] = {100, 400, 800};
+	int threads[] = {1, 0};
+	for(int s = 0; s < 3; s++){
+		for(int t = 0; t < 2; t++){
+			ofxLeapMotionUndistort undistort;
+			undistort.setup(sizes[s], sizes[s]);
+			undistort.setNumThreads(threads[t]);
+			double micros = ofxLeapTest::bench([&](){
+				undistort.undistort(image, output);
+			});
+			
+			string name = ofToString(sizes[s]) + "x" + ofToString(sizes[s]) + (threads[t] == 1 ? " one thread" : " all cores");
+			ofxLeapTest::report(name, sizes[s] * sizes[s] / micros, "MP/s");
+		}
+	}
+}
@@ -0,0 +1,134 @@
+#include "tests.h"
+#include "ofxLeapMotion.h"
+#include "ofxLeapMotionWatchdog.h"
+
+#include <chrono>
+#include <thread>
+
+//takes the Leap frames itself and never calls onFrameInternal()
+class ofxLeapTestOwnFrames : public ofxLeapMotion{
+	
+	public:
+		
+		~ofxLeapTestOwnFrames(){
+			close();
+		}
+		
+		void onFrame(const Leap::Controller& contr){
+		}
+};
+
+//the watchdog driven by simulated time and a fake source - frames every 10ms, then dropped, then back
+//--------------------------------------------------------------
+void testWatchdog(){
+	const uint64_t step = 10000;
+	
+	ofxLeapMotionWatchdog watchdog;
+	watchdog.setup(1.0, 0.5, 4.0);
+	
+	ofxLeapMotionFrameSource source;
+	uint64_t now = 0;
+	int64_t id = 0;
+	
+	//nothing from the source yet - idle until the stall timeout, then the first reconnect straight away
+	LEAP_CHECK( !watchdog.update(now, source) );
+	LEAP_CHECK( watchdog.getHealth().state == OFX_LEAP_WATCHDOG_IDLE );
+	now += 1000000;
+	LEAP_CHECK( watchdog.update(now, source) );
+	LEAP_CHECK( watchdog.getHealth().state == OFX_LEAP_WATCHDOG_RECONNECTING );
+	LEAP_CHECK( watchdog.getHealth().numStalls == 0 );
+	
+	//frames arriving - healthy, the failures are forgotten and the frame rate follows the source
+	int numReconnects = 0;
+	for(int i = 0; i < 200; i++){
+		now += step;
+		source.setFrame( makeTestFrame(++id, 1) );
+		numReconnects += watchdog.update(now, source);
+	}
+	ofxLeapMotionHealth health = watchdog.getHealth();
+	LEAP_CHECK( numReconnects == 0 );
+	LEAP_CHECK( health.state == OFX_LEAP_WATCHDOG_HEALTHY );
+	LEAP_CHECK( health.consecutiveFailures == 0 );
+	LEAP_CHECK( health.numFrames == 200 );
+	LEAP_CHECK( health.frameRate > 90 && health.frameRate < 110 );
+	
+	//the source drops a few frames at a time - still healthy, the skipped ids still count
+	for(int i = 0; i < 50; i++){
+		now += step * 3;
+		id += 3;
+		source.setFrame( makeTestFrame(id, 1) );
+		numReconnects += watchdog.update(now, source);
+	}
+	LEAP_CHECK( numReconnects == 0 );
+	LEAP_CHECK( watchdog.getHealth().numFrames == 350 );
+	
+	//the source stops - no reconnect before the stall timeout
+	uint64_t stallStart = now;
+	while( now - stallStart < 1000000 - step ){
+		now += step;
+		LEAP_CHECK( !watchdog.update(now, source) );
+	}
+	LEAP_CHECK( watchdog.getHealth().state == OFX_LEAP_WATCHDOG_HEALTHY );
+	LEAP_CHECK( watchdog.getHealth().microsSinceLastFrame >= 900000 );
+	
+	//then a reconnect, and retries backing off 0.5, 1, 2, 4, 4 seconds while nothing comes back
+	now += step;
+	LEAP_CHECK( watchdog.update(now, source) );
+	LEAP_CHECK( watchdog.getHealth().numStalls == 1 );
+	
+	vector <uint64_t> retries;
+	uint64_t lastRetry = now;
+	while( retries.size() < 5 ){
+		now += step;
+		if( watchdog.update(now, source) ){
+			retries.push_back(now - lastRetry);
+			lastRetry = now;
+		}
+	}
+	
+	//each retry waits the stall timeout for frames, then the backoff
+	uint64_t expected[] = {500000, 1000000, 2000000, 4000000, 4000000};
+	for(int i = 0; i < retries.size(); i++){
+		LEAP_CHECK( retries[i] >= 1000000 + expected[i] - step && retries[i] <= 1000000 + expected[i] + step );
+	}
+	health = watchdog.getHealth();
+	LEAP_CHECK( health.numReconnects == 7 );
+	LEAP_CHECK( health.consecutiveFailures == 6 );
+	LEAP_CHECK( health.numStalls == 1 );
+	
+	//frames come back - healthy again with the backoff reset
+	now += step;
+	source.setFrame( makeTestFrame(++id, 1) );
+	LEAP_CHECK( !watchdog.update(now, source) );
+	LEAP_CHECK( watchdog.getHealth().state == OFX_LEAP_WATCHDOG_HEALTHY );
+	LEAP_CHECK( watchdog.getHealth().consecutiveFailures == 0 );
+	
+	//no frames expected (eg: unfocused, or no device connected) - paused however long it lasts
+	for(int i = 0; i < 1000; i++){
+		now += step;
+		LEAP_CHECK( !watchdog.update(now, source, false) );
+	}
+	LEAP_CHECK( watchdog.getHealth().state == OFX_LEAP_WATCHDOG_PAUSED );
+	
+	//once frames are expected again the stall timeout starts from then
+	now += step;
+	LEAP_CHECK( !watchdog.update(now, source) );
+	LEAP_CHECK( watchdog.getHealth().state == OFX_LEAP_WATCHDOG_HEALTHY );
+	now += 1000000;
+	LEAP_CHECK( watchdog.update(now, source) );
+	LEAP_CHECK( watchdog.getHealth().numStalls == 2 );
+	
+	//reset() forgets everything
+	watchdog.reset();
+	health = watchdog.getHealth();
+	LEAP_CHECK( health.state == OFX_LEAP_WATCHDOG_IDLE && health.numFrames == 0 && health.numReconnects == 0 );
+	
+	//a connection is watched by the frames arriving, not by what the app does with them
+	//with a device this overrides onFrame() and gets no reconnects - without one frames aren't expected at all
+	ofxLeapTestOwnFrames leap;
+	leap.setWatchdog(true, 0.1, 0.05, 0.1);
+	leap.open();
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	LEAP_CHECK( leap.getHealth().numReconnects == 0 );
+	leap.close();
+}
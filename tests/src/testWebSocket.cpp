@@ -0,0 +1,302 @@
+#include "tests.h"
+#include "ofxLeapMotionWebSocketServer.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <thread>
+
+static const int testPort = 19002;
+
+//--------------------------------------------------------------
+static int connectClient(int receiveBufferBytes = 0){
+	int sock = socket(AF_INET, SOCK_STREAM, 0);
+	if( receiveBufferBytes ){
+		setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &receiveBufferBytes, sizeof(receiveBufferBytes));
+	}
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons(testPort);
+	if( connect(sock, (sockaddr *)&addr, sizeof(addr)) != 0 ){
+		close(sock);
+		return -1;
+	}
+	return sock;
+}
+
+//--------------------------------------------------------------
+static void sendAll(int sock, const string & data){
+	if( send(sock, data.data(), data.size(), MSG_NOSIGNAL) != (ssize_t)data.size() ){
+		cout << "couldn't send to the test server" << endl;
+	}
+}
+
+//everything that arrives within the time - stops early at the end of the stream
+//--------------------------------------------------------------
+static string receive(int sock, int millis, bool * bEnded = NULL){
+	string data;
+	if( bEnded ){
+		*bEnded = false;
+	}
+	uint64_t end = ofGetElapsedTimeMillis() + millis;
+	while( ofGetElapsedTimeMillis() < end ){
+		pollfd p = { sock, POLLIN, 0 };
+		if( poll(&p, 1, 20) <= 0 ){
+			continue;
+		}
+		char buf[4096];
+		ssize_t n = recv(sock, buf, sizeof(buf), 0);
+		if( n <= 0 ){
+			if( bEnded ){
+				*bEnded = true;
+			}
+			break;
+		}
+		data.append(buf, n);
+	}
+	return data;
+}
+
+//a masked client frame
+//--------------------------------------------------------------
+static string clientFrame(unsigned char opcode, const string & payload){
+	const unsigned char mask[4] = { 0x12, 0x34, 0x56, 0x78 };
+	string frame;
+	frame.push_back((char)(0x80 | opcode));
+	frame.push_back((char)(0x80 | payload.size()));
+	frame.append((const char *)mask, 4);
+	for(size_t i = 0; i < payload.size(); i++){
+		frame.push_back(payload[i] ^ mask[i % 4]);
+	}
+	return frame;
+}
+
+//--------------------------------------------------------------
+void testWebSocket(){
+	ofxLeapMotionWebSocketServer server;
+	LEAP_CHECK( server.setup(testPort) );
+	
+	int sock = connectClient();
+	LEAP_CHECK( sock >= 0 );
+	if( sock < 0 ){
+		return;
+	}
+	
+	//lower case header names like some clients send, with the example key from RFC 6455
+	sendAll(sock, "GET / HTTP/1.1\r\nhost: localhost\r\nupgrade: websocket\r\nconnection: Upgrade\r\nsec-websocket-key: dGhlIHNhbXBsZSBub25jZQ==\r\nsec-websocket-version: 13\r\n\r\n");
+	string response = receive(sock, 300);
+	LEAP_CHECK( response.find("101 Switching Protocols") != string::npos );
+	LEAP_CHECK( response.find("Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") != string::npos );
+	LEAP_CHECK( server.getNumClients() == 1 );
+	
+	server.publish( makeTestFrame(3, 1) );
+	string frame = receive(sock, 200);
+	LEAP_CHECK( frame.size() > 4 && (unsigned char)frame[0] == 0x82 );
+	
+	//a text frame whose second half starts with what looks like a close opcode, sent in two pieces
+	string text = clientFrame(0x1, string("abcd") + (char)(0x88 ^ 0x12) + "efgh");
+	sendAll(sock, text.substr(0, 6));
+	ofSleepMillis(50);
+	sendAll(sock, text.substr(6));
+	ofSleepMillis(50);
+	LEAP_CHECK( server.getNumClients() == 1 );
+	
+	//a ping split across reads gets a pong with the same payload
+	string ping = clientFrame(0x9, "hi");
+	sendAll(sock, ping.substr(0, 3));
+	ofSleepMillis(50);
+	sendAll(sock, ping.substr(3));
+	string pong = receive(sock, 200);
+	LEAP_CHECK( pong == string("\x8a\x02hi", 4) );
+	
+	//a close gets its status code back and then the socket is closed
+	bool bEnded = false;
+	sendAll(sock, clientFrame(0x8, string("\x03\xe8", 2)));
+	string reply = receive(sock, 500, &bEnded);
+	LEAP_CHECK( reply == string("\x88\x02\x03\xe8", 4) );
+	LEAP_CHECK( bEnded );
+	ofSleepMillis(50);
+	LEAP_CHECK( server.getNumClients() == 0 );
+	close(sock);
+	
+	//unmasked frames from a client are a protocol error
+	sock = connectClient();
+	sendAll(sock, "GET / HTTP/1.1\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n\r\n");
+	receive(sock, 200);
+	sendAll(sock, string("\x89\x00", 2));
+	receive(sock, 300, &bEnded);
+	LEAP_CHECK( bEnded );
+	close(sock);
+	
+	server.close();
+	
+	//the port is still taken by another server
+	ofxLeapMotionWebSocketServer first, second;
+	LEAP_CHECK( first.setup(testPort) );
+	LEAP_CHECK( !second.setup(testPort) );
+}
+
+//a browser on the other end of a load test - decodes the frames it receives and counts them
+class ofxLeapTestWebSocketClient{
+	
+	public:
+		
+		ofxLeapTestWebSocketClient(){
+			sock = -1;
+			numFrames = 0;
+			numBad = 0;
+			lastId = -1;
+		}
+		
+		//takes the server's frames off the front of the buffer - returns false once the socket is done
+		bool read(){
+			char buf[16384];
+			ssize_t n = recv(sock, buf, sizeof(buf), MSG_DONTWAIT);
+			if( n <= 0 ){
+				return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+			}
+			data.append(buf, n);
+			
+			while( data.size() >= 2 ){
+				size_t length = (unsigned char)data[1] & 0x7f;
+				size_t header = 2;
+				if( length == 126 ){
+					if( data.size() < 4 ){
+						break;
+					}
+					length = ((unsigned char)data[2] << 8) | (unsigned char)data[3];
+					header = 4;
+				}else if( length == 127 ){
+					numBad++;
+					return false;
+				}
+				if( data.size() < header + length ){
+					break;
+				}
+				
+				//binary, frame id first - ids only go forward, frames in between may be dropped
+				int64_t id = -1;
+				if( (unsigned char)data[0] != 0x82 || length < 17 ){
+					numBad++;
+				}else{
+					memcpy(&id, data.data() + header, sizeof(id));
+					numBad += id <= lastId;
+					lastId = id;
+					numFrames++;
+				}
+				data.erase(0, header + length);
+			}
+			return true;
+		}
+		
+		int sock;
+		string data;
+		int numFrames;
+		int numBad;
+		int64_t lastId;
+};
+
+//100 browsers on loopback while frames are published at 120Hz - one of them stops reading and falls behind
+//--------------------------------------------------------------
+void benchWebSocket(){
+	const int numClients = 100;
+	const int rate = 120;
+	const int numFrames = rate * 3;
+	
+	ofxLeapMotionWebSocketServer server;
+	LEAP_CHECK( server.setup(testPort) );
+	
+	vector <ofxLeapTestWebSocketClient> clients(numClients);
+	for(int i = 0; i < numClients; i++){
+		//the slow one has a small receive buffer, so the server's sends back up quickly
+		clients[i].sock = connectClient(i == 0 ? 4096 : 0);
+		if( clients[i].sock < 0 ){
+			LEAP_CHECK( clients[i].sock >= 0 );
+			return;
+		}
+		sendAll(clients[i].sock, "GET / HTTP/1.1\r\nUpgrade: websocket\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n\r\n");
+	}
+	for(int i = 0; i < numClients; i++){
+		string response = receive(clients[i].sock, 500);
+		LEAP_CHECK( response.find("101 Switching Protocols") != string::npos );
+	}
+	LEAP_CHECK( server.getNumClients() == numClients );
+	
+	//everyone but the slow client reads as fast as the frames come
+	std::atomic <bool> bDone(false);
+	std::thread reader([&](){
+		vector <pollfd> fds;
+		for(int i = 1; i < numClients; i++){
+			pollfd p = { clients[i].sock, POLLIN, 0 };
+			fds.push_back(p);
+		}
+		while( !bDone ){
+			if( poll(&fds[0], fds.size(), 20) <= 0 ){
+				continue;
+			}
+			for(int i = 0; i < fds.size(); i++){
+				if( fds[i].revents ){
+					clients[i + 1].read();
+				}
+			}
+		}
+	});
+	
+	uint64_t startCpu = server.getCpuMicros();
+	uint64_t start = ofGetElapsedTimeMicros();
+	for(int i = 0; i < numFrames; i++){
+		uint64_t next = start + (uint64_t)(i + 1) * 1000000 / rate;
+		server.publish( makeTestFrame(i + 1, 4) );
+		while( ofGetElapsedTimeMicros() < next ){
+			ofSleepMillis(1);
+		}
+	}
+	uint64_t cpu = server.getCpuMicros() - startCpu;
+	
+	//the last frame has time to arrive before the readers stop
+	ofSleepMillis(200);
+	bDone = true;
+	reader.join();
+	
+	int numBad = 0;
+	int fewest = numFrames;
+	for(int i = 1; i < numClients; i++){
+		numBad += clients[i].numBad;
+		fewest = MIN(fewest, clients[i].numFrames);
+		LEAP_CHECK( clients[i].lastId == numFrames );
+	}
+	LEAP_CHECK( numBad == 0 );
+	
+	//what is waiting for the slow client is still whole frames, the newest last
+	uint64_t end = ofGetElapsedTimeMillis() + 500;
+	while( ofGetElapsedTimeMillis() < end && clients[0].read() && clients[0].lastId < numFrames ){
+		ofSleepMillis(1);
+	}
+	LEAP_CHECK( clients[0].numBad == 0 && clients[0].numFrames > 0 );
+	LEAP_CHECK( clients[0].lastId == numFrames );
+	
+	//it only ever had one frame waiting - the rest were dropped for it rather than queued
+	//and a frame that was dropped is one a client never got
+	uint64_t numDropped = server.getNumDropped();
+	int numMissed = 0;
+	for(int i = 0; i < numClients; i++){
+		numMissed += numFrames - clients[i].numFrames;
+	}
+	LEAP_CHECK( clients[0].numFrames < numFrames / 2 );
+	LEAP_CHECK( numDropped > 0 && numDropped <= numMissed );
+	
+	for(int i = 0; i < numClients; i++){
+		close(clients[i].sock);
+	}
+	server.close();
+	
+	ofxLeapTest::report("100 clients at 120Hz, server thread CPU", (double)cpu / numFrames, "us per frame");
+	ofxLeapTest::report("100 clients at 120Hz, server thread CPU", cpu / 10000.0 / (numFrames / (double)rate), "% of a core");
+	ofxLeapTest::report("fewest frames a reading client decoded", fewest, "of " + ofToString(numFrames));
+	ofxLeapTest::report("dropped, nearly all for the client that stopped reading", numDropped, "frames");
+}
@@ -0,0 +1,66 @@
+//tests - hardware free tests and benchmarks for ofxLeapMotion
+//frames come from ofxLeapMotionFrameSource, recordings, the fake Leap in fakeleap/ or are made up in the test - no Leap is needed
+//
+//build like the examples (make) then run from the tests folder:
+//  bin/tests                   the tests - exits with 1 if any check failed
+//  bin/tests bench             the tests and the benchmarks
+//  bin/tests golden            rewrite the replay golden files in bin/data/replay instead of comparing with them
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxLeapMotionTypes.h"
+
+#include <functional>
+
+class ofxLeapTest{
+	
+	public:
+		
+		static void check(bool bPassed, const char * expression, const char * file, int line);
+		
+		//runs the function for about the given time and returns the average microseconds per call
+		static double bench(std::function <void()> function, double seconds = 0.5);
+		static void report(string name, double value, string unit);
+		
+		static int numChecks;
+		static int numFailed;
+		static bool bUpdateGolden;
+};
+
+#define LEAP_CHECK(x) ofxLeapTest::check((x), #x, __FILE__, __LINE__)
+
+//a made up hand - the palm moves along x with time, the fingers spread around it
+ofxLeapMotionSimpleHand makeTestHand(int64_t id, float t);
+ofxLeapMotionSimpleFrame makeTestFrame(int64_t id, int numHands);
+
+//a made up camera image with a mild barrel distortion map - bright dots at the given pixel positions
+ofxLeapMotionImage makeTestImage(int camera, int width, int height, const vector <ofPoint> & dots);
+
+//a version 1 recording of one frame with one hand and one finger - see testRecorder.cpp
+void writeVersion1Recording(const string & path);
+
+void benchStrip();
+
+void testUndistort();
+void testBlobTracker();
+void testRecorder();
+void testColumnExporter();
+void testShared();
+void testWebSocket();
+void testOsc();
+void testFusion();
+void testFrameStress();
+void testStartup();
+void testWatchdog();
+void testOpenClose();
+void testInteraction();
+void testReplay();
+void testInterpolation();
+void benchUndistort();
+void benchBlobTracker();
+void benchRecorder();
+void benchStartup();
+void benchInteraction();
+void benchInterpolation();
+void benchWebSocket();